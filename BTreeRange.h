@@ -0,0 +1,919 @@
+#ifndef _BTREE_RANGE_H_
+#define _BTREE_RANGE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/*
+    B+-tree alternative to Range.
+    Each leaf packs up to "FanOut" ranges into contiguous arrays of start
+    and end points, and each inner node holds up to "FanOut" children, so a
+    lookup touches a handful of wide nodes instead of one tree node per range.
+    Leaves are linked to their siblings, so Get finds the first range once
+    and then walks the remaining ranges with a sequential scan.
+    Inner nodes also keep the number of ranges under each child and the
+    number of points they cover, so CoveredLength and CountIntervals add up
+    whole subtrees instead of visiting every range in the selection.
+    Exposes the same interface and produces the same results as Range.
+
+    FanOut: maximum number of ranges per leaf and children per inner node
+*/
+template <std::size_t FanOut = 64>
+class BTreeRange
+{
+    static_assert(FanOut >= 4, "BTreeRange needs a fan-out of at least 4");
+private:
+    // nodes are never allowed to drop below half full, except for the root
+    static const std::size_t minCount = FanOut / 2;
+
+    // fields shared by both kinds of node
+    // "count" is the number of ranges in a leaf, or children in an inner node
+    struct Node
+    {
+        bool leaf;
+        std::size_t count;
+    };
+
+    // holds the ranges themselves, sorted by start point
+    struct LeafNode : Node
+    {
+        int starts[FanOut];
+        int ends[FanOut];
+        LeafNode* prev;
+        LeafNode* next;
+    };
+
+    // holds "count" children, where every start point in children[i]
+    // lies in [keys[i - 1], keys[i])
+    struct InnerNode : Node
+    {
+        int keys[FanOut - 1];
+        Node* children[FanOut];
+        // the number of ranges in the subtree under children[i],
+        // and the number of points they cover
+        std::size_t ranges[FanOut];
+        unsigned int covered[FanOut];
+    };
+
+    // refers to the range at "index" within "leaf", or to nothing when leaf is null
+    struct Position
+    {
+        LeafNode* leaf;
+        std::size_t index;
+    };
+
+    // null, along with "head", until the first range is added,
+    // so that empty and moved from trees hold no nodes at all
+    Node* root;
+    // the leftmost leaf, where in-order traversal begins
+    LeafNode* head;
+    // number of levels in the tree, 1 when the root is a leaf and 0 when there is no root
+    std::size_t depth;
+
+    static LeafNode* newLeaf();
+    static InnerNode* newInner();
+    static void destroy(Node*);
+    static std::size_t childIndex(const InnerNode*, int);
+    static void advance(Position&);
+    static void refresh(InnerNode*, std::size_t);
+    static void refreshAll(InnerNode*);
+
+    /*
+        Adds up the ranges starting before "key", storing how many there are
+        in "ranges" and how many points they cover in "covered"
+        Time Complexity: O(logn)
+    */
+    void sumBefore(int key, std::size_t& ranges, unsigned int& covered) const;
+
+    Position lastAtOrBefore(int) const;
+    Position firstAtOrAfter(int) const;
+    void insert(int, int);
+    void erase(int);
+    Node* insertInto(Node*, int, int, int&);
+    void eraseFrom(Node*, int);
+    void rebalance(InnerNode*, std::size_t);
+    void merge(InnerNode*, std::size_t);
+public:
+    BTreeRange();
+    BTreeRange(const BTreeRange&);
+    BTreeRange(BTreeRange&&) noexcept;
+    BTreeRange& operator=(const BTreeRange&);
+    BTreeRange& operator=(BTreeRange&&) noexcept;
+    ~BTreeRange();
+
+    /*
+        Adds a range to the data structure, merging together existing
+        ranges if neccessary
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(klogn), k being the number of ranges merged
+    */
+    void Add(int, int);
+
+    /*
+        Removes ranges that exist within the data structure
+        that intersect with the selection range
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(klogn), k being the number of ranges removed
+    */
+    void Delete(int, int);
+
+    /*
+        Returns a list of ranges that exist within the data structure
+        that intersect with the selection range
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn + k), k being the number of ranges returned
+    */
+    std::vector<std::pair<int, int>> Get(int, int) const;
+
+    /*
+        Returns the number of points in the selection range covered by
+        the data structure, i.e. the total length of the ranges Get would return
+        Does not allocate
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn)
+    */
+    unsigned int CoveredLength(int, int) const;
+
+    /*
+        Returns the number of ranges intersecting the selection range,
+        i.e. the number of ranges Get would return
+        Does not allocate
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn)
+    */
+    std::size_t CountIntervals(int, int) const;
+
+    /*
+        Returns the first point at or after "point" that isn't covered
+
+        point: The point to start looking from
+        Time Complexity: O(logn)
+    */
+    int NextGap(int) const;
+
+    /*
+        Returns the first point at or after "point" that is covered,
+        or nothing if there are no ranges from there on
+
+        point: The point to start looking from
+        Time Complexity: O(logn)
+    */
+    std::optional<int> FirstCovered(int) const;
+
+    /*
+        Returns the number of levels in the tree, 1 when the root is a leaf,
+        and 0 when no range has been added since the tree was created or moved from
+    */
+    std::size_t Depth() const { return depth; }
+
+    /*
+        Convenience function to print the start and endpoints of the range in reverse order.
+        Returns nothing, but prints to stdout.
+        Used for Debugging.
+    */
+    void printAll() const;
+
+    /*
+        Convenience function to serialize the range into a list of start and end points.
+        Returns a list in reverse order, matching Range::toVec.
+        Used for Testcase Verification.
+    */
+    std::vector<int> toVec() const;
+};
+
+// starts without any node, the first leaf is allocated by the first Add
+template <std::size_t FanOut>
+BTreeRange<FanOut>::BTreeRange() : root(nullptr), head(nullptr), depth(0) {}
+
+// copies by inserting every range of "other" again, one at a time, in O(nlogn)
+template <std::size_t FanOut>
+BTreeRange<FanOut>::BTreeRange(const BTreeRange& other) : BTreeRange() {
+    for (const LeafNode* leaf = other.head; leaf != nullptr; leaf = leaf->next){
+        for (std::size_t i = 0; i < leaf->count; i++){
+            insert(leaf->starts[i], leaf->ends[i]);
+        }
+    }
+}
+
+// takes over the nodes of "other" without allocating, leaving it without a root,
+// which is a valid empty tree that can be modified or queried again
+template <std::size_t FanOut>
+BTreeRange<FanOut>::BTreeRange(BTreeRange&& other) noexcept
+    : root(other.root), head(other.head), depth(other.depth) {
+    other.root = nullptr;
+    other.head = nullptr;
+    other.depth = 0;
+}
+
+// copies "other" aside first, so that the tree is left as it was if copying throws
+template <std::size_t FanOut>
+BTreeRange<FanOut>& BTreeRange<FanOut>::operator=(const BTreeRange& other) {
+    BTreeRange copy(other);
+    std::swap(root, copy.root);
+    std::swap(head, copy.head);
+    std::swap(depth, copy.depth);
+    return *this;
+}
+
+// frees the nodes of the tree, then takes over those of "other" like the move constructor
+template <std::size_t FanOut>
+BTreeRange<FanOut>& BTreeRange<FanOut>::operator=(BTreeRange&& other) noexcept {
+    if (this != &other){
+        if (root != nullptr){
+            destroy(root);
+        }
+        root = other.root;
+        head = other.head;
+        depth = other.depth;
+        other.root = nullptr;
+        other.head = nullptr;
+        other.depth = 0;
+    }
+    return *this;
+}
+
+template <std::size_t FanOut>
+BTreeRange<FanOut>::~BTreeRange() {
+    if (root != nullptr){
+        destroy(root);
+    }
+}
+
+template <std::size_t FanOut>
+typename BTreeRange<FanOut>::LeafNode* BTreeRange<FanOut>::newLeaf(){
+    LeafNode* leaf = new LeafNode();
+    leaf->leaf = true;
+    leaf->count = 0;
+    leaf->prev = nullptr;
+    leaf->next = nullptr;
+    return leaf;
+}
+
+template <std::size_t FanOut>
+typename BTreeRange<FanOut>::InnerNode* BTreeRange<FanOut>::newInner(){
+    InnerNode* inner = new InnerNode();
+    inner->leaf = false;
+    inner->count = 0;
+    return inner;
+}
+
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::destroy(Node* node){
+    if (node->leaf){
+        delete static_cast<LeafNode*>(node);
+        return;
+    }
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    for (std::size_t i = 0; i < inner->count; i++){
+        destroy(inner->children[i]);
+    }
+    delete inner;
+}
+
+// returns the index of the child of "inner" whose key space contains "key"
+template <std::size_t FanOut>
+std::size_t BTreeRange<FanOut>::childIndex(const InnerNode* inner, int key){
+    return std::upper_bound(inner->keys, inner->keys + inner->count - 1, key) - inner->keys;
+}
+
+// moves "pos" to the next range in order, following the sibling link at the end of a leaf
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::advance(Position& pos){
+    pos.index++;
+    if (pos.index == pos.leaf->count){
+        pos.leaf = pos.leaf->next;
+        pos.index = 0;
+    }
+}
+
+/*
+    Recomputes the number of ranges and points covered under the child at "idx"
+    of "inner" from the child itself, after the child has been modified
+    Time Complexity: O(FanOut)
+*/
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::refresh(InnerNode* inner, std::size_t idx){
+    Node* child = inner->children[idx];
+    std::size_t ranges = 0;
+    unsigned int covered = 0;
+    if (child->leaf){
+        LeafNode* leaf = static_cast<LeafNode*>(child);
+        ranges = leaf->count;
+        for (std::size_t i = 0; i < leaf->count; i++){
+            // unsigned subtraction gives the right distance even when it overflows int
+            covered += static_cast<unsigned int>(leaf->ends[i]) - static_cast<unsigned int>(leaf->starts[i]);
+        }
+    } else {
+        InnerNode* below = static_cast<InnerNode*>(child);
+        for (std::size_t i = 0; i < below->count; i++){
+            ranges += below->ranges[i];
+            covered += below->covered[i];
+        }
+    }
+    inner->ranges[idx] = ranges;
+    inner->covered[idx] = covered;
+}
+
+/*
+    Recomputes the totals of every child of "inner", after children have
+    been moved in or out of it by a split, merge or rebalance
+    Time Complexity: O(FanOut^2)
+*/
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::refreshAll(InnerNode* inner){
+    for (std::size_t i = 0; i < inner->count; i++){
+        refresh(inner, i);
+    }
+}
+
+/*
+    Returns the position of the range with the greatest start point
+    less than or equal to "key", or a null position if there is none
+    Time Complexity: O(logn)
+*/
+template <std::size_t FanOut>
+typename BTreeRange<FanOut>::Position BTreeRange<FanOut>::lastAtOrBefore(int key) const{
+    if (root == nullptr){
+        return Position{nullptr, 0};
+    }
+    Node* node = root;
+    while (!node->leaf){
+        InnerNode* inner = static_cast<InnerNode*>(node);
+        node = inner->children[childIndex(inner, key)];
+    }
+    LeafNode* leaf = static_cast<LeafNode*>(node);
+    std::size_t pos = std::upper_bound(leaf->starts, leaf->starts + leaf->count, key) - leaf->starts;
+    if (pos > 0){
+        return Position{leaf, pos - 1};
+    }
+    // "key" is before everything in this leaf, so the answer is the
+    // last range of the previous leaf, if there is one
+    if (leaf->prev != nullptr){
+        return Position{leaf->prev, leaf->prev->count - 1};
+    }
+    return Position{nullptr, 0};
+}
+
+/*
+    Returns the position of the range with the least start point
+    greater than or equal to "key", or a null position if there is none
+    Time Complexity: O(logn)
+*/
+template <std::size_t FanOut>
+typename BTreeRange<FanOut>::Position BTreeRange<FanOut>::firstAtOrAfter(int key) const{
+    if (root == nullptr){
+        return Position{nullptr, 0};
+    }
+    Node* node = root;
+    while (!node->leaf){
+        InnerNode* inner = static_cast<InnerNode*>(node);
+        node = inner->children[childIndex(inner, key)];
+    }
+    LeafNode* leaf = static_cast<LeafNode*>(node);
+    std::size_t pos = std::lower_bound(leaf->starts, leaf->starts + leaf->count, key) - leaf->starts;
+    if (pos < leaf->count){
+        return Position{leaf, pos};
+    }
+    if (leaf->next != nullptr){
+        return Position{leaf->next, 0};
+    }
+    return Position{nullptr, 0};
+}
+
+/*
+    Inserts the range from "start" to "end", splitting nodes as needed,
+    or allocating the first leaf if the tree has no root yet
+    "start" must not already be the start of a range
+    Time Complexity: O(logn)
+*/
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::insert(int start, int end){
+    if (root == nullptr){
+        head = newLeaf();
+        root = head;
+        depth = 1;
+    }
+    int splitKey;
+    Node* sibling = insertInto(root, start, end, splitKey);
+    // the root itself was split, so grow the tree by one level
+    if (sibling != nullptr){
+        InnerNode* newRoot = newInner();
+        newRoot->count = 2;
+        newRoot->children[0] = root;
+        newRoot->children[1] = sibling;
+        newRoot->keys[0] = splitKey;
+        refreshAll(newRoot);
+        root = newRoot;
+        depth++;
+    }
+}
+
+/*
+    Inserts the range into the subtree rooted at "node"
+    If "node" had to be split, returns the new right half and stores its
+    smallest start point in "splitKey", otherwise returns null
+*/
+template <std::size_t FanOut>
+typename BTreeRange<FanOut>::Node* BTreeRange<FanOut>::insertInto(Node* node, int start, int end, int& splitKey){
+    if (node->leaf){
+        LeafNode* leaf = static_cast<LeafNode*>(node);
+        std::size_t pos = std::upper_bound(leaf->starts, leaf->starts + leaf->count, start) - leaf->starts;
+        LeafNode* right = nullptr;
+        // a full leaf moves its upper half into a new right sibling first
+        if (leaf->count == FanOut){
+            right = newLeaf();
+            std::size_t half = FanOut / 2;
+            right->count = FanOut - half;
+            std::copy(leaf->starts + half, leaf->starts + FanOut, right->starts);
+            std::copy(leaf->ends + half, leaf->ends + FanOut, right->ends);
+            leaf->count = half;
+            right->next = leaf->next;
+            right->prev = leaf;
+            if (leaf->next != nullptr){
+                leaf->next->prev = right;
+            }
+            leaf->next = right;
+            if (pos > half){
+                leaf = right;
+                pos -= half;
+            }
+        }
+        std::copy_backward(leaf->starts + pos, leaf->starts + leaf->count, leaf->starts + leaf->count + 1);
+        std::copy_backward(leaf->ends + pos, leaf->ends + leaf->count, leaf->ends + leaf->count + 1);
+        leaf->starts[pos] = start;
+        leaf->ends[pos] = end;
+        leaf->count++;
+        if (right != nullptr){
+            splitKey = right->starts[0];
+        }
+        return right;
+    }
+
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    std::size_t idx = childIndex(inner, start);
+    int childKey;
+    Node* newChild = insertInto(inner->children[idx], start, end, childKey);
+    if (newChild == nullptr){
+        refresh(inner, idx);
+        return nullptr;
+    }
+    // the new child goes directly after the one that was split
+    if (inner->count < FanOut){
+        std::copy_backward(inner->keys + idx, inner->keys + inner->count - 1, inner->keys + inner->count);
+        std::copy_backward(inner->children + idx + 1, inner->children + inner->count, inner->children + inner->count + 1);
+        std::copy_backward(inner->ranges + idx + 1, inner->ranges + inner->count, inner->ranges + inner->count + 1);
+        std::copy_backward(inner->covered + idx + 1, inner->covered + inner->count, inner->covered + inner->count + 1);
+        inner->keys[idx] = childKey;
+        inner->children[idx + 1] = newChild;
+        inner->count++;
+        refresh(inner, idx);
+        refresh(inner, idx + 1);
+        return nullptr;
+    }
+    // a full inner node is split in two, and the key between the halves
+    // moves up into the parent rather than staying in either half
+    int keys[FanOut];
+    Node* children[FanOut + 1];
+    std::copy(inner->keys, inner->keys + idx, keys);
+    keys[idx] = childKey;
+    std::copy(inner->keys + idx, inner->keys + FanOut - 1, keys + idx + 1);
+    std::copy(inner->children, inner->children + idx + 1, children);
+    children[idx + 1] = newChild;
+    std::copy(inner->children + idx + 1, inner->children + FanOut, children + idx + 2);
+
+    std::size_t leftCount = (FanOut + 1) / 2;
+    InnerNode* right = newInner();
+    right->count = FanOut + 1 - leftCount;
+    std::copy(children, children + leftCount, inner->children);
+    std::copy(keys, keys + leftCount - 1, inner->keys);
+    inner->count = leftCount;
+    std::copy(children + leftCount, children + FanOut + 1, right->children);
+    std::copy(keys + leftCount, keys + FanOut, right->keys);
+    refreshAll(inner);
+    refreshAll(right);
+    splitKey = keys[leftCount - 1];
+    return right;
+}
+
+/*
+    Removes the range starting at "key", merging nodes as needed
+    "key" must be the start of a range
+    Time Complexity: O(logn)
+*/
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::erase(int key){
+    eraseFrom(root, key);
+    // the root lost its second to last child, so shrink the tree by one level
+    if (!root->leaf && root->count == 1){
+        InnerNode* oldRoot = static_cast<InnerNode*>(root);
+        root = oldRoot->children[0];
+        delete oldRoot;
+        depth--;
+    }
+}
+
+/*
+    Removes the range starting at "key" from the subtree rooted at "node",
+    then refills any child that drops below half full
+*/
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::eraseFrom(Node* node, int key){
+    if (node->leaf){
+        LeafNode* leaf = static_cast<LeafNode*>(node);
+        std::size_t pos = std::lower_bound(leaf->starts, leaf->starts + leaf->count, key) - leaf->starts;
+        std::copy(leaf->starts + pos + 1, leaf->starts + leaf->count, leaf->starts + pos);
+        std::copy(leaf->ends + pos + 1, leaf->ends + leaf->count, leaf->ends + pos);
+        leaf->count--;
+        return;
+    }
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    std::size_t idx = childIndex(inner, key);
+    eraseFrom(inner->children[idx], key);
+    if (inner->children[idx]->count < minCount){
+        rebalance(inner, idx);
+        refreshAll(inner);
+    } else {
+        refresh(inner, idx);
+    }
+}
+
+/*
+    Refills the child at "idx" of "parent", which has dropped below half full,
+    by borrowing from a sibling that can spare an entry, or otherwise by
+    merging it with a sibling
+*/
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::rebalance(InnerNode* parent, std::size_t idx){
+    Node* child = parent->children[idx];
+    Node* left = (idx > 0) ? parent->children[idx - 1] : nullptr;
+    Node* right = (idx + 1 < parent->count) ? parent->children[idx + 1] : nullptr;
+
+    if (left != nullptr && left->count > minCount){
+        // move the last entry of the left sibling to the front of the child
+        if (child->leaf){
+            LeafNode* to = static_cast<LeafNode*>(child);
+            LeafNode* from = static_cast<LeafNode*>(left);
+            std::copy_backward(to->starts, to->starts + to->count, to->starts + to->count + 1);
+            std::copy_backward(to->ends, to->ends + to->count, to->ends + to->count + 1);
+            to->starts[0] = from->starts[from->count - 1];
+            to->ends[0] = from->ends[from->count - 1];
+            parent->keys[idx - 1] = to->starts[0];
+        } else {
+            InnerNode* to = static_cast<InnerNode*>(child);
+            InnerNode* from = static_cast<InnerNode*>(left);
+            std::copy_backward(to->keys, to->keys + to->count - 1, to->keys + to->count);
+            std::copy_backward(to->children, to->children + to->count, to->children + to->count + 1);
+            to->keys[0] = parent->keys[idx - 1];
+            to->children[0] = from->children[from->count - 1];
+            parent->keys[idx - 1] = from->keys[from->count - 2];
+            from->count--;
+            to->count++;
+            refreshAll(to);
+            refreshAll(from);
+            return;
+        }
+        left->count--;
+        child->count++;
+    } else if (right != nullptr && right->count > minCount){
+        // move the first entry of the right sibling to the back of the child
+        if (child->leaf){
+            LeafNode* to = static_cast<LeafNode*>(child);
+            LeafNode* from = static_cast<LeafNode*>(right);
+            to->starts[to->count] = from->starts[0];
+            to->ends[to->count] = from->ends[0];
+            std::copy(from->starts + 1, from->starts + from->count, from->starts);
+            std::copy(from->ends + 1, from->ends + from->count, from->ends);
+            parent->keys[idx] = from->starts[0];
+        } else {
+            InnerNode* to = static_cast<InnerNode*>(child);
+            InnerNode* from = static_cast<InnerNode*>(right);
+            to->keys[to->count - 1] = parent->keys[idx];
+            to->children[to->count] = from->children[0];
+            parent->keys[idx] = from->keys[0];
+            std::copy(from->keys + 1, from->keys + from->count - 1, from->keys);
+            std::copy(from->children + 1, from->children + from->count, from->children);
+            from->count--;
+            to->count++;
+            refreshAll(to);
+            refreshAll(from);
+            return;
+        }
+        right->count--;
+        child->count++;
+    } else if (left != nullptr){
+        merge(parent, idx - 1);
+    } else {
+        merge(parent, idx);
+    }
+}
+
+/*
+    Merges the child at "idx + 1" of "parent" into the child at "idx",
+    then removes the emptied child from "parent"
+*/
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::merge(InnerNode* parent, std::size_t idx){
+    Node* into = parent->children[idx];
+    Node* from = parent->children[idx + 1];
+    if (into->leaf){
+        LeafNode* to = static_cast<LeafNode*>(into);
+        LeafNode* gone = static_cast<LeafNode*>(from);
+        std::copy(gone->starts, gone->starts + gone->count, to->starts + to->count);
+        std::copy(gone->ends, gone->ends + gone->count, to->ends + to->count);
+        to->count += gone->count;
+        to->next = gone->next;
+        if (gone->next != nullptr){
+            gone->next->prev = to;
+        }
+        delete gone;
+    } else {
+        InnerNode* to = static_cast<InnerNode*>(into);
+        InnerNode* gone = static_cast<InnerNode*>(from);
+        // the key separating the two children comes down between their keys
+        to->keys[to->count - 1] = parent->keys[idx];
+        std::copy(gone->keys, gone->keys + gone->count - 1, to->keys + to->count);
+        std::copy(gone->children, gone->children + gone->count, to->children + to->count);
+        to->count += gone->count;
+        refreshAll(to);
+        delete gone;
+    }
+    std::copy(parent->keys + idx + 1, parent->keys + parent->count - 1, parent->keys + idx);
+    std::copy(parent->children + idx + 2, parent->children + parent->count, parent->children + idx + 1);
+    parent->count--;
+}
+
+/*
+    Adds a range to the data structure, merging together existing
+    ranges if neccessary
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(klogn), k being the number of ranges merged
+*/
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::Add(int start, int end){
+    // an empty selection covers nothing, so there is nothing to add
+    if (start >= end){
+        return;
+    }
+    // if "start" touches an existing range, the merged range begins where it does
+    Position pos = lastAtOrBefore(start);
+    if (pos.leaf != nullptr && pos.leaf->ends[pos.index] >= start){
+        start = pos.leaf->starts[pos.index];
+    }
+    // remove every range that starts between "start" and "end",
+    // extending "end" to cover the last of them
+    for (pos = firstAtOrAfter(start); pos.leaf != nullptr && pos.leaf->starts[pos.index] <= end; pos = firstAtOrAfter(start)){
+        end = std::max(end, pos.leaf->ends[pos.index]);
+        erase(pos.leaf->starts[pos.index]);
+    }
+    // then replace them with their union with the new range
+    insert(start, end);
+}
+
+/*
+    Removes ranges that exist within the data structure
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(klogn), k being the number of ranges removed
+*/
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::Delete(int start, int end){
+    // an empty selection covers nothing, so there is nothing to remove
+    if (start >= end){
+        return;
+    }
+    // if "start" lies in an existing range, the part of it before "start" survives
+    Position pos = lastAtOrBefore(start);
+    int from = start;
+    bool keepLeft = false;
+    int leftStart = 0;
+    if (pos.leaf != nullptr && pos.leaf->ends[pos.index] > start){
+        from = pos.leaf->starts[pos.index];
+        keepLeft = from < start;
+        leftStart = from;
+    }
+    // remove every range overlapping the selection, remembering
+    // how far the last of them extends past "end"
+    int lastEnd = end;
+    for (pos = firstAtOrAfter(from); pos.leaf != nullptr && pos.leaf->starts[pos.index] < end; pos = firstAtOrAfter(from)){
+        lastEnd = std::max(lastEnd, pos.leaf->ends[pos.index]);
+        erase(pos.leaf->starts[pos.index]);
+    }
+    // put back the parts of the outermost ranges that stick out of the selection
+    if (keepLeft){
+        insert(leftStart, start);
+    }
+    if (lastEnd > end){
+        insert(end, lastEnd);
+    }
+}
+
+/*
+    Returns a list of ranges that exist within the data structure
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn + k), k being the number of ranges returned
+*/
+template <std::size_t FanOut>
+std::vector<std::pair<int, int>> BTreeRange<FanOut>::Get(int start, int end) const{
+    std::vector<std::pair<int, int>> ret;
+    // an empty selection can't intersect anything
+    if (start >= end){
+        return ret;
+    }
+    // find the first range that overlaps "start" or comes after it
+    Position pos = lastAtOrBefore(start);
+    if (pos.leaf == nullptr){
+        pos = Position{head, 0};
+        if (head == nullptr || head->count == 0){
+            return ret;
+        }
+    } else if (pos.leaf->ends[pos.index] <= start){
+        advance(pos);
+    }
+    // then scan along the leaves, clipping each range to the selection
+    for (; pos.leaf != nullptr && pos.leaf->starts[pos.index] < end; advance(pos)){
+        ret.push_back(std::make_pair(std::max(start, pos.leaf->starts[pos.index]),
+            std::min(end, pos.leaf->ends[pos.index])));
+    }
+    return ret;
+}
+
+/*
+    Adds up the ranges starting before "key", storing how many there are
+    in "ranges" and how many points they cover in "covered"
+    Every child to the left of the one "key" falls in only holds ranges
+    starting before it, so their totals are taken whole
+    Time Complexity: O(logn)
+*/
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::sumBefore(int key, std::size_t& ranges, unsigned int& covered) const{
+    ranges = 0;
+    covered = 0;
+    if (root == nullptr){
+        return;
+    }
+    Node* node = root;
+    while (!node->leaf){
+        InnerNode* inner = static_cast<InnerNode*>(node);
+        std::size_t idx = childIndex(inner, key);
+        for (std::size_t i = 0; i < idx; i++){
+            ranges += inner->ranges[i];
+            covered += inner->covered[i];
+        }
+        node = inner->children[idx];
+    }
+    LeafNode* leaf = static_cast<LeafNode*>(node);
+    std::size_t pos = std::lower_bound(leaf->starts, leaf->starts + leaf->count, key) - leaf->starts;
+    ranges += pos;
+    for (std::size_t i = 0; i < pos; i++){
+        covered += static_cast<unsigned int>(leaf->ends[i]) - static_cast<unsigned int>(leaf->starts[i]);
+    }
+}
+
+/*
+    Returns the number of points in the selection range covered by the data structure
+    The ranges starting within the selection are added up whole, then the
+    one sticking out past "end" is trimmed, and the one covering "start"
+    from before it is added
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn)
+*/
+template <std::size_t FanOut>
+unsigned int BTreeRange<FanOut>::CoveredLength(int start, int end) const{
+    if (start >= end){
+        return 0;
+    }
+    std::size_t ranges;
+    unsigned int coveredBeforeStart;
+    unsigned int coveredBeforeEnd;
+    sumBefore(start, ranges, coveredBeforeStart);
+    sumBefore(end, ranges, coveredBeforeEnd);
+    unsigned int length = coveredBeforeEnd - coveredBeforeStart;
+    // "end" is above "start", so "end - 1" can't overflow
+    Position last = lastAtOrBefore(end - 1);
+    if (last.leaf != nullptr && last.leaf->starts[last.index] >= start && last.leaf->ends[last.index] > end){
+        length -= static_cast<unsigned int>(last.leaf->ends[last.index]) - static_cast<unsigned int>(end);
+    }
+    Position first = lastAtOrBefore(start);
+    if (first.leaf != nullptr && first.leaf->starts[first.index] < start && first.leaf->ends[first.index] > start){
+        length += static_cast<unsigned int>(std::min(end, first.leaf->ends[first.index])) - static_cast<unsigned int>(start);
+    }
+    return length;
+}
+
+/*
+    Returns the number of ranges intersecting the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn)
+*/
+template <std::size_t FanOut>
+std::size_t BTreeRange<FanOut>::CountIntervals(int start, int end) const{
+    if (start >= end){
+        return 0;
+    }
+    std::size_t beforeStart;
+    std::size_t beforeEnd;
+    unsigned int covered;
+    sumBefore(start, beforeStart, covered);
+    sumBefore(end, beforeEnd, covered);
+    std::size_t count = beforeEnd - beforeStart;
+    // the range covering "start" from before it intersects the selection too
+    Position first = lastAtOrBefore(start);
+    if (first.leaf != nullptr && first.leaf->starts[first.index] < start && first.leaf->ends[first.index] > start){
+        count++;
+    }
+    return count;
+}
+
+/*
+    Returns the first point at or after "point" that isn't covered
+
+    point: The point to start looking from
+    Time Complexity: O(logn)
+*/
+template <std::size_t FanOut>
+int BTreeRange<FanOut>::NextGap(int point) const{
+    // ranges never touch, so the end of the range covering "point" is never covered
+    Position pos = lastAtOrBefore(point);
+    if (pos.leaf != nullptr && point < pos.leaf->ends[pos.index]){
+        return pos.leaf->ends[pos.index];
+    }
+    return point;
+}
+
+/*
+    Returns the first point at or after "point" that is covered,
+    or nothing if there are no ranges from there on
+
+    point: The point to start looking from
+    Time Complexity: O(logn)
+*/
+template <std::size_t FanOut>
+std::optional<int> BTreeRange<FanOut>::FirstCovered(int point) const{
+    Position pos = lastAtOrBefore(point);
+    if (pos.leaf != nullptr && point < pos.leaf->ends[pos.index]){
+        return point;
+    }
+    pos = firstAtOrAfter(point);
+    if (pos.leaf == nullptr){
+        return std::nullopt;
+    }
+    return pos.leaf->starts[pos.index];
+}
+
+/*
+    Convenience function to print the start and endpoints of the range in reverse order.
+    Returns nothing, but prints to stdout.
+    Used for Debugging.
+*/
+template <std::size_t FanOut>
+void BTreeRange<FanOut>::printAll() const{
+    std::vector<int> vec = toVec();
+    for (std::size_t i = 0; i < vec.size(); i += 2){
+        std::cout << vec[i] << ", " << vec[i + 1] << ", ";
+    }
+    std::cout << std::endl;
+}
+
+/*
+    Convenience function to serialize the range into a list of start and end points.
+    Returns a list in reverse order, matching Range::toVec.
+    Used for Testcase Verification.
+*/
+template <std::size_t FanOut>
+std::vector<int> BTreeRange<FanOut>::toVec() const{
+    std::vector<int> vec;
+    for (const LeafNode* leaf = head; leaf != nullptr; leaf = leaf->next){
+        for (std::size_t i = 0; i < leaf->count; i++){
+            vec.push_back(leaf->starts[i]);
+            vec.push_back(leaf->ends[i]);
+        }
+    }
+    std::reverse(vec.begin(), vec.end());
+    return vec;
+}
+#endif
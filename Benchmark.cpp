@@ -0,0 +1,1039 @@
+#include "Range.h"
+#include "FlatRange.h"
+#include "HybridRange.h"
+#include "BTreeRange.h"
+#include "ConcurrentRange.h"
+#include "ShardedRange.h"
+#include "RangeSnapshot.h"
+#include "DurableRange.h"
+#include "PersistentRange.h"
+#include "RangeMap.h"
+#include "CompressedRange.h"
+#include "IngestRange.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include <malloc.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+    Compares the std::map backed Range against FlatRange and BTreeRange.
+    Every measurement is reported as the average time per operation.
+    Build with "make bench" and run ./range_bench
+*/
+
+// keeps the optimizer from discarding the results of the queries
+static volatile std::size_t sink;
+
+/*
+    Returns the average number of nanoseconds taken by "op" over "iterations" calls
+
+    iterations: number of times to call op
+    op: the operation to time, called with the iteration number
+*/
+template <typename Op>
+double timePerOp(std::size_t iterations, Op op){
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; i++){
+        op(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+/*
+    Fills "range" with "count" disjoint ranges of width 10, spaced 20 apart
+*/
+template <typename RangeType>
+void populate(RangeType& range, std::size_t count){
+    for (std::size_t i = 0; i < count; i++){
+        int start = static_cast<int>(i) * 20;
+        range.Add(start, start + 10);
+    }
+}
+
+/*
+    Times Get, Add and Delete on a single backend holding "count" ranges
+    and prints one line of results
+
+    name: name of the backend, used to label the output
+    count: number of ranges held by the backend while timing
+    queries: random query points, shared between the backends
+*/
+template <typename RangeType>
+void benchBackend(const char* name, std::size_t count, const std::vector<int>& queries){
+    RangeType range;
+    populate(range, count);
+    std::size_t iterations = queries.size();
+
+    // narrow lookups touching at most a couple of ranges, the common case
+    double getNs = timePerOp(iterations, [&](std::size_t i){
+        sink = sink + range.Get(queries[i], queries[i] + 15).size();
+    });
+    // punch a hole into a range and fill it back in, leaving the size unchanged
+    // mutations are far slower than lookups on FlatRange, so time fewer of them
+    double churnNs = timePerOp(iterations / 20, [&](std::size_t i){
+        int start = queries[i] - queries[i] % 20;
+        range.Delete(start + 2, start + 8);
+        range.Add(start + 2, start + 8);
+    });
+    std::printf("%-10s %10zu %14.1f %14.1f\n", name, count, getNs, churnNs / 2);
+}
+
+/*
+    Times ingesting a batch of random ranges into a backend holding "count"
+    ranges, once with Add per range and once with a single AddBatch,
+    and prints one line of results
+
+    name: name of the backend, used to label the output
+    count: number of ranges held by the backend before ingesting
+    batch: the ranges to ingest, shared between the backends
+*/
+template <typename RangeType>
+void benchBatch(const char* name, std::size_t count, const std::vector<std::pair<int, int>>& batch){
+    RangeType sequential;
+    populate(sequential, count);
+    RangeType batched;
+    populate(batched, count);
+    double addNs = timePerOp(batch.size(), [&](std::size_t i){
+        sequential.Add(batch[i].first, batch[i].second);
+    });
+    double batchNs = timePerOp(1, [&](std::size_t){
+        batched.AddBatch(batch);
+    }) / batch.size();
+    std::printf("%-10s %10zu %10zu %14.1f %14.1f\n", name, count, batch.size(), addNs, batchNs);
+}
+
+/*
+    Times Get on Range returning a new list against the non-allocating
+    overloads, on a Range holding "count" ranges, and prints one line of results
+
+    count: number of ranges held by the Range while timing
+    queries: random query points
+*/
+void benchGetNoAlloc(std::size_t count, const std::vector<int>& queries){
+    Range range;
+    populate(range, count);
+    std::size_t iterations = queries.size();
+    double vectorNs = timePerOp(iterations, [&](std::size_t i){
+        sink = sink + range.Get(queries[i], queries[i] + 45).size();
+    });
+    std::pair<int, int> buffer[8];
+    double bufferNs = timePerOp(iterations, [&](std::size_t i){
+        sink = sink + range.Get(queries[i], queries[i] + 45, buffer, 8);
+    });
+    double forEachNs = timePerOp(iterations, [&](std::size_t i){
+        std::size_t total = 0;
+        range.ForEach(queries[i], queries[i] + 45, [&](int start, int end){
+            total += end - start;
+        });
+        sink = sink + total;
+    });
+    std::printf("%-10s %10zu %14.1f %14.1f %14.1f\n", "Range", count, vectorNs, bufferNs, forEachNs);
+}
+
+/*
+    Measures how many Gets per second "threads" reader threads manage in total
+    while one writer thread adds and deletes a range every millisecond
+
+    get: performs one Get, called with a query point
+    mutate: performs one modification, called with a query point
+    threads: number of reader threads
+    queries: random query points
+*/
+template <typename GetOp, typename MutateOp>
+double readThroughput(GetOp get, MutateOp mutate, std::size_t threads, const std::vector<int>& queries){
+    std::atomic<bool> done(false);
+    std::atomic<std::size_t> total(0);
+    std::vector<std::thread> readers;
+    for (std::size_t t = 0; t < threads; t++){
+        readers.emplace_back([&, t](){
+            std::size_t count = 0;
+            for (std::size_t i = t; !done.load(std::memory_order_relaxed); i = (i + 1) % queries.size()){
+                get(queries[i]);
+                count++;
+            }
+            total += count;
+        });
+    }
+    std::thread writer([&](){
+        for (std::size_t i = 0; !done.load(); i = (i + 1) % queries.size()){
+            mutate(queries[i]);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    const double seconds = 0.5;
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    done.store(true);
+    for (auto&& reader : readers){
+        reader.join();
+    }
+    writer.join();
+    return total.load() / seconds;
+}
+
+/*
+    Compares the read throughput of ConcurrentRange against a Range behind a mutex,
+    for an increasing number of reader threads, and prints one line per thread count
+
+    count: number of ranges held while timing
+    queries: random query points
+*/
+void benchConcurrentReads(std::size_t count, const std::vector<int>& queries){
+    Range locked;
+    std::mutex lock;
+    populate(locked, count);
+    ConcurrentRange concurrent;
+    std::vector<std::pair<int, int>> initial;
+    for (std::size_t i = 0; i < count; i++){
+        initial.push_back(std::make_pair(static_cast<int>(i) * 20, static_cast<int>(i) * 20 + 10));
+    }
+    concurrent.AddBatch(initial);
+
+    for (std::size_t threads : {1, 2, 4, 8, 16, 32}){
+        double lockedOps = readThroughput([&](int query){
+            std::lock_guard<std::mutex> guard(lock);
+            sink = sink + locked.Get(query, query + 15).size();
+        }, [&](int query){
+            std::lock_guard<std::mutex> guard(lock);
+            locked.Delete(query, query + 5);
+            locked.Add(query, query + 5);
+        }, threads, queries);
+        double concurrentOps = readThroughput([&](int query){
+            sink = sink + concurrent.Read([&](const FlatRange& range){
+                return range.Get(query, query + 15).size();
+            });
+        }, [&](int query){
+            concurrent.Delete(query, query + 5);
+            concurrent.Add(query, query + 5);
+        }, threads, queries);
+        std::printf("%10zu %10zu %16.0f %16.0f\n", count, threads, lockedOps, concurrentOps);
+    }
+}
+
+/*
+    Returns the total number of modifications per second made by "threads" writer threads,
+    each adding and deleting ranges within its own region of the coordinate space
+
+    mutate: performs one modification, called with a coordinate
+    threads: number of writer threads
+    width: width of each thread's region
+*/
+template <typename MutateOp>
+double writeThroughput(MutateOp mutate, std::size_t threads, int width){
+    const std::size_t perThread = 200000;
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> writers;
+    for (std::size_t t = 0; t < threads; t++){
+        writers.emplace_back([&, t](){
+            std::mt19937 gen(static_cast<unsigned>(t));
+            std::uniform_int_distribution<int> dist(0, width - 100);
+            int base = static_cast<int>(t) * width;
+            for (std::size_t i = 0; i < perThread; i++){
+                mutate(base + dist(gen), i % 2 == 0);
+            }
+        });
+    }
+    for (auto&& writer : writers){
+        writer.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return threads * perThread / elapsed.count();
+}
+
+/*
+    Compares the write throughput of ShardedRange against a Range behind a mutex,
+    for an increasing number of writer threads working on disjoint regions,
+    and prints one line per thread count
+*/
+void benchShardedWrites(){
+    const int width = 1 << 20;
+    for (std::size_t threads : {1, 2, 4, 8, 16}){
+        Range locked;
+        std::mutex lock;
+        double lockedOps = writeThroughput([&](int start, bool add){
+            std::lock_guard<std::mutex> guard(lock);
+            if (add){
+                locked.Add(start, start + 50);
+            } else {
+                locked.Delete(start, start + 50);
+            }
+        }, threads, width);
+        ShardedRange sharded(32, 0, 16 * width);
+        double shardedOps = writeThroughput([&](int start, bool add){
+            if (add){
+                sharded.Add(start, start + 50);
+            } else {
+                sharded.Delete(start, start + 50);
+            }
+        }, threads, width);
+        std::printf("%10zu %16.0f %16.0f\n", threads, lockedOps, shardedOps);
+    }
+}
+
+/*
+    Times saving a Range holding "count" ranges to a snapshot, reading it back
+    into a Range, and mapping it, then compares Get on the mapped snapshot
+    against Get on the Range, and prints one line of results
+    Opening the mapping is timed without the checksum, which reads the whole file
+
+    count: number of ranges in the snapshot
+    queries: random query points
+*/
+void benchSnapshot(std::size_t count, const std::vector<int>& queries){
+    const char* path = "range_bench.snap";
+    Range range;
+    populate(range, count);
+    double saveMs = timePerOp(1, [&](std::size_t){
+        SaveSnapshot(range, path);
+    }) / 1e6;
+    double loadMs = timePerOp(1, [&](std::size_t){
+        sink = sink + LoadSnapshot<int>(path).Size();
+    }) / 1e6;
+    double mapUs = timePerOp(100, [&](std::size_t){
+        sink = sink + MappedRange(path, false).Size();
+    }) / 1e3;
+    MappedRange mapped(path);
+    double rangeNs = timePerOp(queries.size(), [&](std::size_t i){
+        sink = sink + range.Get(queries[i], queries[i] + 15).size();
+    });
+    double mappedNs = timePerOp(queries.size(), [&](std::size_t i){
+        sink = sink + mapped.Get(queries[i], queries[i] + 15).size();
+    });
+    std::remove(path);
+    std::printf("%10zu %10.2f %10.2f %10.2f %14.1f %14.1f\n", count, saveMs, loadMs, mapUs, rangeNs, mappedNs);
+}
+
+/*
+    Times modifying a DurableRange from "threads" threads at once
+    and prints one line of results
+    Each thread keeps adding and deleting ranges within its own region
+
+    label: describes the options, used to label the output
+    options: how often to sync
+    threads: number of writer threads
+    perThread: number of modifications made by each thread
+*/
+void benchDurable(const char* label, DurableOptions options, std::size_t threads, std::size_t perThread){
+    const char* path = "range_bench_durable";
+    std::remove("range_bench_durable.snap");
+    std::remove("range_bench_durable.log");
+    double opsPerSecond;
+    {
+        DurableRange range(path, options);
+        double ns = timePerOp(1, [&](std::size_t){
+            std::vector<std::thread> writers;
+            for (std::size_t thread = 0; thread < threads; thread++){
+                writers.emplace_back([&, thread](){
+                    int base = static_cast<int>(thread) * 1000000;
+                    for (std::size_t i = 0; i < perThread; i++){
+                        int start = base + static_cast<int>(i % 10000) * 20;
+                        if (i % 2 == 0){
+                            range.Add(start, start + 10);
+                        } else {
+                            range.Delete(start + 2, start + 8);
+                        }
+                    }
+                });
+            }
+            for (auto&& writer : writers){
+                writer.join();
+            }
+            range.Sync();
+        });
+        opsPerSecond = threads * perThread / (ns / 1e9);
+    }
+    std::remove("range_bench_durable.snap");
+    std::remove("range_bench_durable.log");
+    std::printf("%-16s %10zu %16.0f\n", label, threads, opsPerSecond);
+}
+
+/*
+    Returns the memory currently resident in this process, in kilobytes
+*/
+long residentKb(){
+    long pages = 0;
+    long resident = 0;
+    if (std::FILE* statm = std::fopen("/proc/self/statm", "r")){
+        if (std::fscanf(statm, "%ld %ld", &pages, &resident) != 2){
+            resident = 0;
+        }
+        std::fclose(statm);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/*
+    Times sustained churn on "threads" sets of "count" ranges each, one per thread,
+    and prints one line of results
+    Every round splits a range with a Delete and merges it back with an Add, so
+    each round frees a node and allocates one. Runs in a child process, so that
+    the memory freed by one run doesn't flatter the next; the growth in resident
+    memory is measured while the sets are still alive
+
+    name: name of the backend, used to label the output
+    count: number of ranges in each set
+    threads: number of threads, each churning a set of its own
+*/
+template <typename RangeType>
+void benchChurn(const char* name, std::size_t count, std::size_t threads){
+    const std::size_t rounds = 500000;
+    std::fflush(stdout);
+    if (fork() != 0){
+        wait(nullptr);
+        return;
+    }
+    long before = residentKb();
+    std::vector<RangeType> ranges(threads);
+    double ns = timePerOp(1, [&](std::size_t){
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; t++){
+            workers.emplace_back([&, t](){
+                RangeType& range = ranges[t];
+                populate(range, count);
+                std::mt19937 gen(static_cast<unsigned>(t));
+                std::uniform_int_distribution<int> dist(0, static_cast<int>(count) - 1);
+                for (std::size_t i = 0; i < rounds; i++){
+                    int start = dist(gen) * 20;
+                    // split a range in two, or a run of them into a few
+                    int width = i % 16 == 0 ? 200 : 6;
+                    range.Delete(start + 2, start + 2 + width);
+                    range.Add(start + 2, start + 2 + width);
+                }
+            });
+        }
+        for (auto&& worker : workers){
+            worker.join();
+        }
+    });
+    std::printf("%-12s %10zu %10zu %16.1f %14ld\n", name, count, threads, ns / (threads * rounds * 2), residentKb() - before);
+    std::fflush(stdout);
+    _exit(0);
+}
+
+/*
+    Times taking the union of "sources" sets of "count" random ranges each,
+    by adding the ranges of each set one at a time, with AddBatch, and with
+    UnionWith, and prints one line of results
+
+    sources: number of sets to combine
+    count: number of ranges in each set
+*/
+void benchUnion(std::size_t sources, std::size_t count){
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(count) * 400);
+    std::vector<Range> sets(sources);
+    for (auto& set : sets){
+        for (std::size_t i = 0; i < count; i++){
+            int start = dist(gen);
+            set.Add(start, start + 10);
+        }
+    }
+    std::size_t size = 0;
+    double addMs = timePerOp(3, [&](std::size_t){
+        Range combined;
+        for (auto& set : sets){
+            set.ForEach(0, static_cast<int>(count) * 400 + 10, [&](int start, int end){
+                combined.Add(start, end);
+            });
+        }
+        size = combined.Size();
+    }) / 1e6;
+    double batchMs = timePerOp(3, [&](std::size_t){
+        Range combined;
+        for (auto& set : sets){
+            combined.AddBatch(set.Get(0, static_cast<int>(count) * 400 + 10));
+        }
+        sink = sink + combined.Size();
+    }) / 1e6;
+    double unionMs = timePerOp(3, [&](std::size_t){
+        Range combined;
+        for (auto& set : sets){
+            combined.UnionWith(set);
+        }
+        sink = sink + combined.Size();
+    }) / 1e6;
+    std::printf("%10zu %10zu %10zu %12.2f %12.2f %12.2f\n", sources, count, size, addMs, batchMs, unionMs);
+}
+
+/*
+    Times looking up single points with Contains on Range and FlatRange, and
+    in batches with ContainsMany using each instruction set the processor
+    supports, on backends holding "count" ranges, and prints one line of results
+    Instruction sets the processor doesn't support are printed as 0
+
+    count: number of ranges held by the backends while timing
+    queries: random query points
+*/
+void benchContains(std::size_t count, const std::vector<int>& queries){
+    Range range;
+    populate(range, count);
+    FlatRange flat;
+    populate(flat, count);
+    std::size_t iterations = queries.size();
+    double rangeNs = timePerOp(iterations, [&](std::size_t i){
+        sink = sink + range.Contains(queries[i]);
+    });
+    double flatNs = timePerOp(iterations, [&](std::size_t i){
+        sink = sink + flat.Contains(queries[i]);
+    });
+    std::vector<std::uint64_t> bits((iterations + 63) / 64);
+    double manyNs[3] = {0, 0, 0};
+    for (FlatRange::Simd simd : {FlatRange::Simd::Scalar, FlatRange::Simd::SSE2, FlatRange::Simd::AVX2}){
+        if (simd > FlatRange::BestSimd()){
+            continue;
+        }
+        manyNs[static_cast<int>(simd)] = timePerOp(1, [&](std::size_t){
+            flat.ContainsMany(queries.data(), iterations, bits.data(), simd);
+            sink = sink + bits[0];
+        }) / iterations;
+    }
+    std::printf("%10zu %12.1f %12.1f %12.1f %12.1f %12.1f\n", count, rangeNs, flatNs, manyNs[0], manyNs[1], manyNs[2]);
+}
+
+/*
+    Times measuring how much of a window of "width" points is covered, by adding
+    up the result of Get and with CoveredLength on each backend, on backends
+    holding "count" ranges, and prints one line of results
+
+    count: number of ranges held by the backends while timing
+    width: number of points in each window, 20 for every range it holds
+    queries: random start points of the windows
+*/
+void benchCoveredLength(std::size_t count, int width, const std::vector<int>& queries){
+    Range range;
+    populate(range, count);
+    FlatRange flat;
+    populate(flat, count);
+    BTreeRange<> btree;
+    populate(btree, count);
+    // wide windows take long enough that a few thousand of them will do
+    std::size_t iterations = std::min<std::size_t>(queries.size(), 2000000 / (width / 20 + 1));
+    double getNs = timePerOp(iterations, [&](std::size_t i){
+        unsigned int length = 0;
+        for (auto&& elem : range.Get(queries[i], queries[i] + width)){
+            length += elem.second - elem.first;
+        }
+        sink = sink + length;
+    });
+    double rangeNs = timePerOp(iterations, [&](std::size_t i){
+        sink = sink + range.CoveredLength(queries[i], queries[i] + width);
+    });
+    double flatNs = timePerOp(iterations, [&](std::size_t i){
+        sink = sink + flat.CoveredLength(queries[i], queries[i] + width);
+    });
+    double btreeNs = timePerOp(iterations, [&](std::size_t i){
+        sink = sink + btree.CoveredLength(queries[i], queries[i] + width);
+    });
+    std::printf("%10zu %10d %12.1f %12.1f %12.1f %12.1f\n", count, width, getNs, rangeNs, flatNs, btreeNs);
+}
+
+/*
+    Times taking a point in time view of a set holding "count" ranges, by copying
+    a Range and by taking a PersistentRange snapshot, then diffing the snapshot
+    against the set after "changes" modifications, and prints one line of results
+*/
+void benchVersions(std::size_t count, std::size_t changes, const std::vector<int>& queries){
+    Range range;
+    populate(range, count);
+    PersistentRange persistent;
+    populate(persistent, count);
+    double copyUs = timePerOp(10, [&](std::size_t){
+        Range copy = range;
+        sink = sink + copy.Size();
+    }) / 1e3;
+    double snapshotNs = timePerOp(queries.size(), [&](std::size_t){
+        PersistentRange snapshot = persistent.Snapshot();
+        sink = sink + snapshot.Size();
+    });
+    // each round punches "changes" holes into a fresh snapshot and diffs it against the original
+    double diffUs = timePerOp(100, [&](std::size_t round){
+        PersistentRange changed = persistent.Snapshot();
+        for (std::size_t i = 0; i < changes; i++){
+            int start = queries[(round * changes + i) % queries.size()];
+            start -= start % 20;
+            changed.Delete(start + 2, start + 8);
+        }
+        sink = sink + changed.Diff(persistent).removed.size();
+    }) / 1e3;
+    std::printf("%10zu %10zu %12.1f %12.1f %12.1f\n", count, changes, copyUs, snapshotNs, diffUs);
+}
+
+/*
+    Times the hole punching of benchBackend on a Range holding "count" ranges,
+    without a subscriber and with one that mirrors every change into a second Range,
+    and prints one line of results
+*/
+void benchFeed(std::size_t count, const std::vector<int>& queries){
+    Range range;
+    populate(range, count);
+    auto churn = [&](std::size_t i){
+        int start = queries[i] - queries[i] % 20;
+        range.Delete(start + 2, start + 8);
+        range.Add(start + 2, start + 8);
+    };
+    double plainNs = timePerOp(queries.size(), churn);
+    std::size_t changes = 0;
+    range.Subscribe([&](Range::Change, int, int){
+        changes++;
+    });
+    double countingNs = timePerOp(queries.size(), churn);
+    Range mirror = range;
+    range.Subscribe([&](Range::Change change, int start, int end){
+        if (change == Range::Change::Covered){
+            mirror.Add(start, end);
+        } else {
+            mirror.Delete(start, end);
+        }
+    });
+    double mirrorNs = timePerOp(queries.size(), churn);
+    sink = sink + changes + mirror.Size();
+    std::printf("%10zu %14.1f %14.1f %14.1f\n", count, plainNs / 2, countingNs / 2, mirrorNs / 2);
+}
+
+/*
+    Times the narrow Get and the hole punching of benchBackend on a RangeMap holding
+    "count" ranges, with four different payloads so that neighbours don't join,
+    and prints one line of results in the same format as benchBackend
+*/
+void benchRangeMap(std::size_t count, const std::vector<int>& queries){
+    RangeMap<int> map;
+    for (std::size_t i = 0; i < count; i++){
+        int start = static_cast<int>(i) * 20;
+        map.Add(start, start + 10, static_cast<int>(i % 4));
+    }
+    std::size_t iterations = queries.size();
+    double getNs = timePerOp(iterations, [&](std::size_t i){
+        sink = sink + map.Get(queries[i], queries[i] + 15).size();
+    });
+    double churnNs = timePerOp(iterations, [&](std::size_t i){
+        int start = queries[i] - queries[i] % 20;
+        map.Delete(start + 2, start + 8);
+        map.Add(start + 2, start + 8, start / 20 % 4);
+    });
+    std::printf("%-10s %10zu %14.1f %14.1f\n", "RangeMap", count, getNs, churnNs / 2);
+}
+
+/*
+    Returns the number of bytes of heap memory currently allocated
+*/
+std::size_t heapBytes(){
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+/*
+    Measures the heap memory taken per range by a Range holding "count" ranges and
+    by the CompressedRange built from it, times encoding it and decoding it back,
+    and Get and Contains on both, and prints one line of results
+*/
+void benchCompressed(std::size_t count, const std::vector<int>& queries){
+    std::size_t before = heapBytes();
+    Range range;
+    populate(range, count);
+    double rangeBytes = static_cast<double>(heapBytes() - before) / count;
+    CompressedRange compressed;
+    double encodeMs = timePerOp(1, [&](std::size_t){
+        compressed = CompressedRange(range);
+    }) / 1e6;
+    double compressedBytes = static_cast<double>(compressed.MemoryUsage()) / count;
+    double decodeMs = timePerOp(1, [&](std::size_t){
+        sink = sink + compressed.ToRange().Size();
+    }) / 1e6;
+    double rangeGetNs = timePerOp(queries.size(), [&](std::size_t i){
+        sink = sink + range.Get(queries[i], queries[i] + 15).size();
+    });
+    double compressedGetNs = timePerOp(queries.size(), [&](std::size_t i){
+        sink = sink + compressed.Get(queries[i], queries[i] + 15).size();
+    });
+    double rangeContainsNs = timePerOp(queries.size(), [&](std::size_t i){
+        sink = sink + range.Contains(queries[i]);
+    });
+    double compressedContainsNs = timePerOp(queries.size(), [&](std::size_t i){
+        sink = sink + compressed.Contains(queries[i]);
+    });
+    std::printf("%10zu %10.1f %10.2f %10.1f %10.1f %12.1f %12.1f %12.1f %12.1f\n", count, rangeBytes, compressedBytes,
+        encodeMs, decodeMs, rangeGetNs, compressedGetNs, rangeContainsNs, compressedContainsNs);
+}
+
+/*
+    Times Range against HybridRange on a heavily fragmented set in a bounded
+    domain of "width" points, made of ranges 1 to 3 points long with gaps of
+    1 to 3 points between them, and prints one line of results: bytes per
+    range, Contains and Get of 64 points in ns per query, and CoveredLength
+    of 4096 points in ns per query, HybridRange counting bits one word at a
+    time and with the fastest instruction set available
+*/
+void benchHybrid(int width, std::mt19937& gen){
+    std::uniform_int_distribution<int> step(1, 3);
+    std::size_t before = heapBytes();
+    Range range;
+    std::size_t count = 0;
+    for (int start = 0; start < width; count++){
+        int end = std::min(start + step(gen), width);
+        range.Add(start, end);
+        start = end + step(gen);
+    }
+    double rangeBytes = static_cast<double>(heapBytes() - before) / count;
+    HybridRange hybrid;
+    for (auto&& elem : range.Get(0, width)){
+        hybrid.Add(elem.first, elem.second);
+    }
+    double hybridBytes = static_cast<double>(hybrid.MemoryUsage()) / count;
+    std::uniform_int_distribution<int> dist(0, width - 4097);
+    std::vector<int> queries(200000);
+    for (auto& query : queries){
+        query = dist(gen);
+    }
+    double rangeContainsNs = timePerOp(queries.size(), [&](std::size_t i){
+        sink = sink + range.Contains(queries[i]);
+    });
+    double hybridContainsNs = timePerOp(queries.size(), [&](std::size_t i){
+        sink = sink + hybrid.Contains(queries[i]);
+    });
+    double rangeGetNs = timePerOp(queries.size(), [&](std::size_t i){
+        sink = sink + range.Get(queries[i], queries[i] + 64).size();
+    });
+    double hybridGetNs = timePerOp(queries.size(), [&](std::size_t i){
+        sink = sink + hybrid.Get(queries[i], queries[i] + 64).size();
+    });
+    std::size_t iterations = queries.size() / 10;
+    double rangeCoveredNs = timePerOp(iterations, [&](std::size_t i){
+        sink = sink + range.CoveredLength(queries[i], queries[i] + 4096);
+    });
+    double scalarCoveredNs = timePerOp(iterations, [&](std::size_t i){
+        sink = sink + hybrid.CoveredLength(queries[i], queries[i] + 4096, HybridRange::Simd::Scalar);
+    });
+    double hybridCoveredNs = timePerOp(iterations, [&](std::size_t i){
+        sink = sink + hybrid.CoveredLength(queries[i], queries[i] + 4096);
+    });
+    std::printf("%10d %10.1f %10.2f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", width, rangeBytes, hybridBytes,
+        rangeContainsNs, hybridContainsNs, rangeGetNs, hybridGetNs, rangeCoveredNs, scalarCoveredNs, hybridCoveredNs);
+}
+
+/*
+    Range as it was before it could be moved: the user declared destructor
+    suppresses the implicit move operations, so every move falls back to a copy
+*/
+struct CopiedRange
+{
+    Range range;
+
+    CopiedRange() {}
+    ~CopiedRange() {}
+    void Add(int start, int end) { range.Add(start, end); }
+};
+
+/*
+    Times growing a vector of "sets" sets of "count" ranges each, one set at a time,
+    then shuffling it, then erasing its first set, giving the first two in ns per
+    set and the last in us per erase
+*/
+template <typename SetType>
+void timeReshuffles(std::size_t sets, std::size_t count, std::mt19937& gen, double& growNs, double& shuffleNs, double& eraseUs){
+    std::vector<SetType> source(sets);
+    for (auto& set : source){
+        populate(set, count);
+    }
+    std::vector<SetType> grown;
+    growNs = timePerOp(1, [&](std::size_t){
+        for (auto& set : source){
+            grown.push_back(std::move(set));
+        }
+    }) / sets;
+    shuffleNs = timePerOp(1, [&](std::size_t){
+        std::shuffle(grown.begin(), grown.end(), gen);
+    }) / sets;
+    eraseUs = timePerOp(10, [&](std::size_t){
+        grown.erase(grown.begin());
+    }) / 1000;
+}
+
+/*
+    Times reshuffling a vector of sets of Range, which moves them, against
+    CopiedRange, which copies them, and prints one line of results
+*/
+void benchMoves(std::size_t sets, std::size_t count, std::mt19937& gen){
+    double copiedGrowNs, copiedShuffleNs, copiedEraseUs;
+    timeReshuffles<CopiedRange>(sets, count, gen, copiedGrowNs, copiedShuffleNs, copiedEraseUs);
+    double movedGrowNs, movedShuffleNs, movedEraseUs;
+    timeReshuffles<Range>(sets, count, gen, movedGrowNs, movedShuffleNs, movedEraseUs);
+    std::printf("%10zu %10zu %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n", sets, count,
+        copiedGrowNs, movedGrowNs, copiedShuffleNs, movedShuffleNs, copiedEraseUs, movedEraseUs);
+}
+
+/*
+    Times building a set of "count" ranges by calling Add on each of them in random
+    order, with the unsorted bulk constructor, and with the sorted one, including
+    the time to shuffle or sort the input, and prints one line of results in ns per range
+*/
+void benchBulkLoad(std::size_t count, std::mt19937& gen){
+    std::vector<std::pair<int, int>> ranges(count);
+    for (std::size_t i = 0; i < count; i++){
+        int start = static_cast<int>(i) * 20;
+        ranges[i] = {start, start + 10};
+    }
+    std::shuffle(ranges.begin(), ranges.end(), gen);
+    double addNs = timePerOp(1, [&](std::size_t){
+        Range range;
+        for (auto&& elem : ranges){
+            range.Add(elem.first, elem.second);
+        }
+        sink = sink + range.Size();
+    }) / count;
+    double unsortedNs = timePerOp(1, [&](std::size_t){
+        Range range(ranges);
+        sink = sink + range.Size();
+    }) / count;
+    double sortedNs = timePerOp(1, [&](std::size_t){
+        std::vector<std::pair<int, int>> copy = ranges;
+        std::sort(copy.begin(), copy.end());
+        Range range(SortedRanges, copy.begin(), copy.end());
+        sink = sink + range.Size();
+    }) / count;
+    double flatNs = timePerOp(1, [&](std::size_t){
+        FlatRange range(ranges);
+        sink = sink + range.CountIntervals(0, 20 * static_cast<int>(count));
+    }) / count;
+    std::printf("%10zu %12.1f %12.1f %12.1f %12.1f\n", count, addNs, unsortedNs, sortedNs, flatNs);
+}
+
+/*
+    Times Get over a selection holding every one of "count" ranges, on one thread
+    and with each number of threads, and prints one line of results in ms per Get
+*/
+void benchParallelGet(std::size_t count){
+    Range range;
+    populate(range, count);
+    int end = static_cast<int>(count) * 20;
+    std::printf("%10zu", count);
+    for (std::size_t threads : {1, 2, 4, 8}){
+        range.SetParallelGet(threads == 1 ? count : Range::DefaultParallelThreshold, threads);
+        double ms = timePerOp(5, [&](std::size_t){
+            sink = sink + range.Get(0, end).size();
+        }) / 1e6;
+        std::printf(" %12.1f", ms);
+    }
+    std::printf("\n");
+}
+
+/*
+    Times a stream of "events" small Adds, in random order but often repeating
+    or extending the one before, applied to a set of "count" ranges directly and
+    through an IngestRange, including the final Flush, and prints one line of
+    results in ns per event
+*/
+void benchIngest(std::size_t count, std::size_t events, std::mt19937& gen){
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(count) * 20 - 1);
+    std::vector<std::pair<int, int>> stream(events);
+    std::pair<int, int> last(0, 0);
+    for (auto& event : stream){
+        // a quarter repeat the start of the last event, a quarter continue where it ended
+        int roll = dist(gen) % 4;
+        event.first = roll == 1 ? last.first : roll == 2 ? last.second : dist(gen);
+        event.second = event.first + 1 + dist(gen) % 8;
+        last = event;
+    }
+    Range range;
+    populate(range, count);
+    double directNs = timePerOp(1, [&](std::size_t){
+        for (auto&& event : stream){
+            range.Add(event.first, event.second);
+        }
+    }) / events;
+    IngestRange ingest;
+    for (std::size_t i = 0; i < count; i++){
+        ingest.Add(static_cast<int>(i) * 20, static_cast<int>(i) * 20 + 10);
+    }
+    ingest.Flush();
+    double ingestNs = timePerOp(1, [&](std::size_t){
+        for (auto&& event : stream){
+            ingest.Add(event.first, event.second);
+        }
+        ingest.Flush();
+    }) / events;
+    std::printf("%10zu %10zu %14.1f %14.1f\n", count, events, directNs, ingestNs);
+}
+
+int main(){
+    std::printf("%-10s %10s %14s %14s\n", "backend", "ranges", "get ns/op", "mutate ns/op");
+    std::mt19937 gen(42);
+    for (std::size_t count : {100, 1000, 10000, 100000, 1000000}){
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(count) * 20 - 1);
+        std::vector<int> queries(200000);
+        for (auto& query : queries){
+            query = dist(gen);
+        }
+        benchBackend<Range>("Range", count, queries);
+        benchBackend<FlatRange>("FlatRange", count, queries);
+        benchBackend<BTreeRange<>>("BTreeRange", count, queries);
+        benchBackend<PersistentRange>("Persistent", count, queries);
+        benchRangeMap(count, queries);
+    }
+
+    std::printf("\n%-10s %10s %10s %14s %14s\n", "backend", "ranges", "batch", "add ns/range", "batch ns/range");
+    for (std::size_t count : {1000, 100000, 1000000}){
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(count) * 20 - 1);
+        for (std::size_t size : {100, 10000}){
+            std::vector<std::pair<int, int>> batch(size);
+            for (auto& range : batch){
+                range.first = dist(gen);
+                range.second = range.first + 5;
+            }
+            benchBatch<Range>("Range", count, batch);
+            benchBatch<FlatRange>("FlatRange", count, batch);
+        }
+    }
+
+    std::printf("\n%-10s %10s %14s %14s %14s\n", "backend", "ranges", "vector ns/op", "buffer ns/op", "forEach ns/op");
+    for (std::size_t count : {1000, 1000000}){
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(count) * 20 - 1);
+        std::vector<int> queries(200000);
+        for (auto& query : queries){
+            query = dist(gen);
+        }
+        benchGetNoAlloc(count, queries);
+    }
+
+    std::printf("\n%10s %10s %16s %16s\n", "ranges", "readers", "mutex gets/s", "concurrent gets/s");
+    {
+        std::size_t count = 100000;
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(count) * 20 - 1);
+        std::vector<int> queries(200000);
+        for (auto& query : queries){
+            query = dist(gen);
+        }
+        benchConcurrentReads(count, queries);
+    }
+
+    std::printf("\n%10s %16s %16s\n", "writers", "mutex mods/s", "sharded mods/s");
+    benchShardedWrites();
+
+    std::printf("\n%10s %10s %10s %10s %14s %14s\n", "ranges", "save ms", "load ms", "map us", "range get ns", "mapped get ns");
+    for (std::size_t count : {1000, 100000, 1000000}){
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(count) * 20 - 1);
+        std::vector<int> queries(200000);
+        for (auto& query : queries){
+            query = dist(gen);
+        }
+        benchSnapshot(count, queries);
+    }
+
+    std::printf("\n%-16s %10s %16s\n", "durability", "writers", "mods/s");
+    {
+        DurableOptions everySync;
+        DurableOptions batched;
+        batched.syncEvery = 64;
+        DurableOptions noSync;
+        noSync.syncEvery = 64;
+        noSync.sync = false;
+        for (std::size_t threads : {1, 4}){
+            benchDurable("fsync each", everySync, threads, 2000);
+            benchDurable("fsync every 64", batched, threads, 50000);
+            benchDurable("no fsync", noSync, threads, 50000);
+        }
+    }
+
+    std::printf("\n%-12s %10s %10s %16s %14s\n", "backend", "ranges", "threads", "mutate ns/op", "rss growth kb");
+    for (std::size_t count : {10000, 1000000}){
+        for (std::size_t threads : {1, 4}){
+            benchChurn<Range>("Range", count, threads);
+            benchChurn<PooledRange>("PooledRange", count, threads);
+        }
+    }
+
+    std::printf("\n%10s %10s %10s %12s %12s %12s\n", "sources", "ranges", "result", "add ms", "batch ms", "union ms");
+    for (std::size_t count : {1000, 100000}){
+        benchUnion(32, count);
+    }
+
+    std::printf("\n%10s %12s %12s %12s %12s %12s\n", "ranges", "range ns", "flat ns", "scalar ns", "sse2 ns", "avx2 ns");
+    for (std::size_t count : {1000, 100000, 1000000}){
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(count) * 20 - 1);
+        std::vector<int> queries(1000000);
+        for (auto& query : queries){
+            query = dist(gen);
+        }
+        benchContains(count, queries);
+    }
+
+    std::printf("\n%10s %10s %12s %12s %12s %12s\n", "ranges", "window", "get+sum ns", "range ns", "flat ns", "btree ns");
+    {
+        std::size_t count = 1000000;
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(count) * 20 - 1);
+        std::vector<int> queries(200000);
+        for (auto& query : queries){
+            query = dist(gen);
+        }
+        for (int width : {200, 20000, 2000000}){
+            benchCoveredLength(count, width, queries);
+        }
+    }
+
+    std::printf("\n%10s %10s %12s %12s %12s\n", "ranges", "changes", "copy us", "snapshot ns", "edit+diff us");
+    for (std::size_t count : {1000, 1000000}){
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(count) * 20 - 1);
+        std::vector<int> queries(200000);
+        for (auto& query : queries){
+            query = dist(gen);
+        }
+        for (std::size_t changes : {1, 100}){
+            benchVersions(count, changes, queries);
+        }
+    }
+
+    std::printf("\n%10s %14s %14s %14s\n", "ranges", "plain ns/op", "counted ns/op", "mirrored ns/op");
+    for (std::size_t count : {1000, 1000000}){
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(count) * 20 - 1);
+        std::vector<int> queries(200000);
+        for (auto& query : queries){
+            query = dist(gen);
+        }
+        benchFeed(count, queries);
+    }
+
+    std::printf("\n%10s %10s %10s %10s %10s %12s %12s %12s %12s\n", "ranges", "range B", "packed B", "encode ms",
+        "decode ms", "range get", "packed get", "range has", "packed has");
+    for (std::size_t count : {1000, 1000000, 10000000}){
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(count) * 20 - 1);
+        std::vector<int> queries(200000);
+        for (auto& query : queries){
+            query = dist(gen);
+        }
+        benchCompressed(count, queries);
+    }
+
+    std::printf("\n%10s %10s %10s %10s %10s %10s %10s %10s %10s %10s\n", "width", "range B", "hybrid B",
+        "range has", "hybrid has", "range get", "hybrid get", "range len", "scalar len", "hybrid len");
+    for (int width : {1 << 16, 1 << 22}){
+        benchHybrid(width, gen);
+    }
+
+    std::printf("\n%10s %12s %12s %12s %12s\n", "ranges", "add ns", "unsorted ns", "sorted ns", "flat ns");
+    for (std::size_t count : {1000, 1000000, 10000000}){
+        benchBulkLoad(count, gen);
+    }
+
+    std::printf("\n%10s %10s %12s %12s %12s %12s %12s %12s\n", "sets", "ranges", "copy grow", "move grow",
+        "copy shuffle", "move shuffle", "copy erase", "move erase");
+    for (std::size_t sets : {1000, 10000}){
+        benchMoves(sets, 1000000 / sets, gen);
+    }
+
+    std::printf("\nparallel Get on %u cores\n", std::thread::hardware_concurrency());
+    std::printf("%10s %12s %12s %12s %12s\n", "ranges", "1 thread ms", "2 threads ms", "4 threads ms", "8 threads ms");
+    for (std::size_t count : {1000000, 10000000}){
+        benchParallelGet(count);
+    }
+
+    std::printf("\n%10s %10s %14s %14s\n", "ranges", "events", "direct ns/op", "ingest ns/op");
+    for (std::size_t count : {1000, 1000000}){
+        benchIngest(count, 2000000, gen);
+    }
+}
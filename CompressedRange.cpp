@@ -0,0 +1,284 @@
+#include "CompressedRange.h"
+#include <iostream>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace {
+    /*
+        Appends "value" to "out" 7 bits at a time, lowest first,
+        setting the top bit of every byte but the last
+    */
+    void writeVarint(std::vector<std::uint8_t>& out, std::uint32_t value){
+        while (value >= 0x80){
+            out.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    /*
+        Returns the number of bytes writeVarint takes for "value"
+    */
+    std::size_t varintBytes(std::uint32_t value){
+        std::size_t bytes = 1;
+        while (value >= 0x80){
+            value >>= 7;
+            bytes++;
+        }
+        return bytes;
+    }
+
+    /*
+        Reads a value written by writeVarint at "at", and moves "at" past it
+    */
+    inline std::uint32_t readVarint(const std::uint8_t*& at){
+        std::uint32_t value = 0;
+        unsigned int shift = 0;
+        std::uint8_t byte;
+        do {
+            byte = *at++;
+            value |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        return value;
+    }
+
+    /*
+        Returns "point" moved up by "distance"
+        The distances are differences between coordinates, which may not fit
+        in an int, so they are added as unsigned values
+    */
+    inline int advance(int point, std::uint32_t distance){
+        return static_cast<int>(static_cast<std::uint32_t>(point) + distance);
+    }
+
+    /*
+        Returns the distance from "from" up to "to"
+    */
+    inline std::uint32_t distance(int from, int to){
+        return static_cast<std::uint32_t>(to) - static_cast<std::uint32_t>(from);
+    }
+
+    /*
+        Iterator decoding the ranges of a CompressedRange in increasing order,
+        for building a Range with the sorted constructor
+        The blocks lie one after the other in the data, so it only has to
+        take the start of the first range of each block from the index
+    */
+    class DecodingIterator
+    {
+    private:
+        const std::uint8_t* at;
+        const int* blockStarts;
+        std::size_t index;
+        std::size_t count;
+        int start;
+        int end;
+
+        /*
+            Decodes range "index", if there is one
+        */
+        void decode(){
+            if (index >= count){
+                return;
+            }
+            if (index % CompressedRange::BlockSize == 0){
+                start = blockStarts[index / CompressedRange::BlockSize];
+            } else {
+                start = advance(end, readVarint(at) + 1);
+            }
+            end = advance(start, readVarint(at) + 1);
+        }
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef std::pair<int, int> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const std::pair<int, int>* pointer;
+        typedef std::pair<int, int> reference;
+
+        DecodingIterator(const std::uint8_t* at, const int* blockStarts, std::size_t index, std::size_t count)
+            : at(at), blockStarts(blockStarts), index(index), count(count), start(0), end(0) {
+            decode();
+        }
+
+        std::pair<int, int> operator*() const { return std::make_pair(start, end); }
+        DecodingIterator& operator++() { index++; decode(); return *this; }
+        DecodingIterator operator++(int) { DecodingIterator old = *this; ++*this; return old; }
+        bool operator==(const DecodingIterator& other) const { return index == other.index; }
+        bool operator!=(const DecodingIterator& other) const { return index != other.index; }
+    };
+}
+
+CompressedRange::CompressedRange() : count(0) {
+
+}
+
+/*
+    Encodes every range of "range"
+    Each block starts with the length of its first range, whose start is in
+    the index, followed by the gap before and the length of each of the others
+    Ranges never touch and are never empty, so both are at least 1, and
+    they are stored minus 1 to make the most of the first byte
+    A first pass adds up the size of the encoding, so that the data is
+    allocated once at exactly that size, and never holds more than it needs
+    Time Complexity: O(n)
+*/
+CompressedRange::CompressedRange(const Range& range) : count(0) {
+    const int lowest = std::numeric_limits<int>::lowest();
+    const int highest = std::numeric_limits<int>::max();
+    std::size_t bytes = 0;
+    int last = 0;
+    range.ForEach(lowest, highest, [&](int start, int end){
+        if (count % BlockSize != 0){
+            bytes += varintBytes(distance(last, start) - 1);
+        }
+        bytes += varintBytes(distance(start, end) - 1);
+        last = end;
+        count++;
+    });
+    data.reserve(bytes);
+    blockStarts.reserve((count + BlockSize - 1) / BlockSize);
+    blockOffsets.reserve((count + BlockSize - 1) / BlockSize);
+    count = 0;
+    range.ForEach(lowest, highest, [&](int start, int end){
+        if (count % BlockSize == 0){
+            blockStarts.push_back(start);
+            blockOffsets.push_back(data.size());
+        } else {
+            writeVarint(data, distance(last, start) - 1);
+        }
+        writeVarint(data, distance(start, end) - 1);
+        last = end;
+        count++;
+    });
+}
+
+/*
+    Returns the block holding the last range starting at or before "point",
+    or the first block if there is none
+    Time Complexity: O(logn)
+*/
+std::size_t CompressedRange::blockAtOrBefore(int point) const{
+    auto iter = std::upper_bound(blockStarts.begin(), blockStarts.end(), point);
+    return iter == blockStarts.begin() ? 0 : static_cast<std::size_t>(iter - blockStarts.begin()) - 1;
+}
+
+/*
+    Decodes the ranges in increasing order, starting from the first one of
+    block "block", calling "visit" with the start and end of each until it
+    returns false or the ranges run out
+*/
+template <typename Visitor>
+void CompressedRange::scan(std::size_t block, Visitor&& visit) const{
+    for (; block < blockStarts.size(); block++){
+        const std::uint8_t* at = data.data() + blockOffsets[block];
+        std::size_t size = std::min(BlockSize, count - block * BlockSize);
+        int start = blockStarts[block];
+        int end = advance(start, readVarint(at) + 1);
+        if (!visit(start, end)){
+            return;
+        }
+        for (std::size_t i = 1; i < size; i++){
+            start = advance(end, readVarint(at) + 1);
+            end = advance(start, readVarint(at) + 1);
+            if (!visit(start, end)){
+                return;
+            }
+        }
+    }
+}
+
+/*
+    Returns a list of ranges that exist within the data structure
+    that intersect with the selection range
+    Starts decoding at the block holding the range around "start", since
+    the ranges of the blocks before it all end before the selection
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn + k + BlockSize), k being the number of ranges returned
+*/
+std::vector<std::pair<int, int>> CompressedRange::Get(int start, int end) const{
+    std::vector<std::pair<int, int>> ret;
+    // an empty selection can't intersect anything
+    if (start >= end){
+        return ret;
+    }
+    scan(blockAtOrBefore(start), [&](int from, int to){
+        if (from >= end){
+            return false;
+        }
+        if (to > start){
+            ret.push_back(std::make_pair(std::max(from, start), std::min(to, end)));
+        }
+        return true;
+    });
+    return ret;
+}
+
+/*
+    Returns whether "point" is covered by a range in the data structure
+    Only the last range starting at or before "point" can cover it, and
+    it is in the block blockAtOrBefore finds, so decoding stops at the
+    first range past "point" at the latest
+
+    point: The point to look for
+    Time Complexity: O(logn + BlockSize)
+*/
+bool CompressedRange::Contains(int point) const{
+    bool found = false;
+    scan(blockAtOrBefore(point), [&](int start, int end){
+        if (start > point){
+            return false;
+        }
+        found = point < end;
+        return !found;
+    });
+    return found;
+}
+
+/*
+    Decodes every range back into a mutable Range
+    The ranges decode in increasing order, so the sorted constructor
+    appends each one next to the previous one without searching
+    Time Complexity: O(n)
+*/
+Range CompressedRange::ToRange() const{
+    return Range(SortedRanges, DecodingIterator(data.data(), blockStarts.data(), 0, count),
+        DecodingIterator(nullptr, nullptr, count, count));
+}
+
+std::size_t CompressedRange::MemoryUsage() const{
+    return data.capacity() + blockStarts.capacity() * sizeof(int) + blockOffsets.capacity() * sizeof(std::size_t);
+}
+
+/*
+    Convenience function to print the start and endpoints of the range in reverse order.
+    Returns nothing, but prints to stdout.
+    Used for Debugging.
+*/
+void CompressedRange::printAll() const{
+    std::vector<int> vec = toVec();
+    for (std::size_t i = 0; i < vec.size(); i += 2){
+        std::cout << vec[i] << ", " << vec[i + 1] << ", ";
+    }
+    std::cout << std::endl;
+}
+
+/*
+    Convenience function to serialize the range into a list of start and end points.
+    Returns a list in reverse order, matching Range::toVec.
+    Used for Testcase Verification.
+*/
+std::vector<int> CompressedRange::toVec() const{
+    std::vector<int> vec;
+    vec.reserve(2 * count);
+    scan(0, [&](int start, int end){
+        vec.push_back(start);
+        vec.push_back(end);
+        return true;
+    });
+    std::reverse(vec.begin(), vec.end());
+    return vec;
+}
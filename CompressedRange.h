@@ -0,0 +1,112 @@
+#ifndef _COMPRESSED_RANGE_H_
+#define _COMPRESSED_RANGE_H_
+
+#include "Range.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+    Compressed, read only alternative to Range, for very large sets that are
+    built once and then only queried.
+    Stores the ranges in increasing order as a stream of variable length
+    integers: the distance from the end of each range to the start of the next,
+    then its length, using one byte per 7 bits, so that the short gaps and
+    lengths of a dense set take a byte or two each instead of a whole map node.
+    The stream is cut into blocks of BlockSize ranges, and a small skip index
+    holds the first start point of each block and where it begins, so lookups
+    binary search the index and then only decode the one block they need.
+    Built from a Range, and gives the same results as the Range it was built from.
+*/
+class CompressedRange
+{
+private:
+    // the encoded ranges, one block after the other
+    std::vector<std::uint8_t> data;
+    // the start point of the first range of each block
+    std::vector<int> blockStarts;
+    // where each block begins in "data"
+    std::vector<std::size_t> blockOffsets;
+    // the number of ranges
+    std::size_t count;
+
+    /*
+        Returns the block holding the last range starting at or before "point",
+        or the first block if there is none
+        Time Complexity: O(logn)
+    */
+    std::size_t blockAtOrBefore(int) const;
+
+    /*
+        Decodes the ranges in increasing order, starting from the first one of
+        block "block", calling "visit" with the start and end of each until it
+        returns false or the ranges run out
+    */
+    template <typename Visitor>
+    void scan(std::size_t, Visitor&&) const;
+public:
+    // the number of ranges per block, trading lookup time for the size of the index
+    static constexpr std::size_t BlockSize = 64;
+
+    CompressedRange();
+
+    /*
+        Encodes every range of "range"
+        Time Complexity: O(n)
+    */
+    explicit CompressedRange(const Range&);
+
+    /*
+        Returns a list of ranges that exist within the data structure
+        that intersect with the selection range
+        Only decodes the blocks the selection touches
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn + k + BlockSize), k being the number of ranges returned
+    */
+    std::vector<std::pair<int, int>> Get(int, int) const;
+
+    /*
+        Returns whether "point" is covered by a range in the data structure
+        Only decodes the block that would hold it
+        Does not allocate
+
+        point: The point to look for
+        Time Complexity: O(logn + BlockSize)
+    */
+    bool Contains(int) const;
+
+    /*
+        Decodes every range back into a mutable Range
+        Time Complexity: O(n)
+    */
+    Range ToRange() const;
+
+    /*
+        Returns the number of disjoint ranges in the data structure
+        Time Complexity: O(1)
+    */
+    std::size_t Size() const { return count; }
+
+    /*
+        Returns the number of bytes of heap memory the encoding and its index take up
+        Time Complexity: O(1)
+    */
+    std::size_t MemoryUsage() const;
+
+    /*
+        Convenience function to print the start and endpoints of the range in reverse order.
+        Returns nothing, but prints to stdout.
+        Used for Debugging.
+    */
+    void printAll() const;
+
+    /*
+        Convenience function to serialize the range into a list of start and end points.
+        Returns a list in reverse order, matching Range::toVec.
+        Used for Testcase Verification.
+    */
+    std::vector<int> toVec() const;
+};
+#endif
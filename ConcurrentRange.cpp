@@ -0,0 +1,160 @@
+#include "ConcurrentRange.h"
+#include <functional>
+#include <thread>
+
+ConcurrentRange::ConcurrentRange() : current(new FlatRange()), phase(0) {
+    for (auto& slot : slots){
+        slot.active[0].store(0);
+        slot.active[1].store(0);
+    }
+}
+
+// no reader can be active once the object is being destroyed
+ConcurrentRange::~ConcurrentRange() {
+    delete current.load();
+}
+
+/*
+    Returns the index of the reader counter used by the calling thread
+    The index is computed once per thread and shared by every ConcurrentRange
+*/
+std::size_t ConcurrentRange::slotIndex(){
+    thread_local std::size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % readerSlots;
+    return index;
+}
+
+/*
+    Replaces the current snapshot with "next", then waits until no
+    reader can still be using the old snapshot and frees it
+    Must be called with writerLock held
+*/
+void ConcurrentRange::publish(const FlatRange* next){
+    const FlatRange* old = current.exchange(next);
+    waitForReaders();
+    delete old;
+}
+
+/*
+    Returns once every read that started before the call has finished
+    A reader may have picked its counter just before the phase changed, so
+    flipping once and waiting for the old phase isn't enough: the phase is
+    flipped twice, waiting for the readers of each phase in turn
+    Must be called with writerLock held
+*/
+void ConcurrentRange::waitForReaders(){
+    for (int flip = 0; flip < 2; flip++){
+        std::size_t old = phase.fetch_add(1) & 1;
+        for (auto& slot : slots){
+            while (slot.active[old].load() != 0){
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+/*
+    Copies the current snapshot, applies "modify" to the copy and publishes it
+*/
+template <typename Modifier>
+void ConcurrentRange::modify(Modifier&& modify){
+    std::lock_guard<std::mutex> lock(writerLock);
+    // only writers replace the snapshot, so it can't change while the lock is held
+    FlatRange* next = new FlatRange(*current.load());
+    modify(*next);
+    publish(next);
+}
+
+/*
+    Adds a range to the data structure, merging together existing
+    ranges if neccessary
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(n)
+*/
+void ConcurrentRange::Add(int start, int end){
+    // an empty selection covers nothing, so don't bother copying anything
+    if (start >= end){
+        return;
+    }
+    modify([&](FlatRange& range){
+        range.Add(start, end);
+    });
+}
+
+/*
+    Removes ranges that exist within the data structure
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(n)
+*/
+void ConcurrentRange::Delete(int start, int end){
+    if (start >= end){
+        return;
+    }
+    modify([&](FlatRange& range){
+        range.Delete(start, end);
+    });
+}
+
+/*
+    Adds every range in the list to the data structure, publishing them all at once
+
+    ranges: The list of selection ranges, in any order
+    Time Complexity: O(klogk + n), k being the number of ranges in the list
+*/
+void ConcurrentRange::AddBatch(const std::vector<std::pair<int, int>>& ranges){
+    modify([&](FlatRange& range){
+        range.AddBatch(ranges);
+    });
+}
+
+/*
+    Removes every range in the list from the data structure, publishing the result at once
+
+    ranges: The list of selection ranges, in any order
+    Time Complexity: O(klogk + n), k being the number of ranges in the list
+*/
+void ConcurrentRange::DeleteBatch(const std::vector<std::pair<int, int>>& ranges){
+    modify([&](FlatRange& range){
+        range.DeleteBatch(ranges);
+    });
+}
+
+/*
+    Returns a list of ranges that exist within the data structure
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn + k), k being the number of ranges returned
+*/
+std::vector<std::pair<int, int>> ConcurrentRange::Get(int start, int end) const{
+    return Read([&](const FlatRange& range){
+        return range.Get(start, end);
+    });
+}
+
+/*
+    Convenience function to print the start and endpoints of the range in reverse order.
+    Returns nothing, but prints to stdout.
+    Used for Debugging.
+*/
+void ConcurrentRange::printAll() const{
+    Read([](const FlatRange& range){
+        range.printAll();
+    });
+}
+
+/*
+    Convenience function to serialize the range into a list of start and end points.
+    Returns a list in reverse order, matching Range::toVec.
+    Used for Testcase Verification.
+*/
+std::vector<int> ConcurrentRange::toVec() const{
+    return Read([](const FlatRange& range){
+        return range.toVec();
+    });
+}
@@ -0,0 +1,165 @@
+#ifndef _CONCURRENT_RANGE_H_
+#define _CONCURRENT_RANGE_H_
+
+#include "FlatRange.h"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/*
+    Thread safe variant of Range, for sets that are read far more often than they are modified.
+    Readers never take a lock: they read an immutable FlatRange snapshot published through
+    an atomic pointer. Writers are serialized by a mutex; each one copies the current
+    snapshot, applies its change to the copy and publishes the copy in its place.
+    The old snapshot is freed once every reader that could still be using it has finished.
+
+    Readers announce themselves on one of a fixed number of counters, picked by thread, so
+    readers on different cores don't write to the same cache line and read throughput
+    scales with the number of cores. Writers pay for this: every modification copies the
+    whole set, then waits for the readers of the old snapshot to finish before returning.
+*/
+class ConcurrentRange
+{
+private:
+    // number of reader counters, readers on threads beyond this many share counters
+    static const std::size_t readerSlots = 64;
+
+    // counts the readers currently inside a read, for each of the two phases
+    // padded to a cache line of its own so readers don't contend with each other
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<std::size_t> active[2];
+    };
+
+    // the snapshot readers currently see
+    std::atomic<const FlatRange*> current;
+    // incremented twice per modification, its lowest bit picks the counter
+    // new readers announce themselves on
+    mutable std::atomic<std::size_t> phase;
+    mutable ReaderSlot slots[readerSlots];
+    // serializes the writers
+    std::mutex writerLock;
+
+    /*
+        Returns the index of the reader counter used by the calling thread
+    */
+    static std::size_t slotIndex();
+
+    /*
+        Replaces the current snapshot with "next", then waits until no
+        reader can still be using the old snapshot and frees it
+        Must be called with writerLock held
+    */
+    void publish(const FlatRange* next);
+
+    /*
+        Returns once every read that started before the call has finished
+        Must be called with writerLock held
+    */
+    void waitForReaders();
+
+    /*
+        Copies the current snapshot, applies "modify" to the copy and publishes it
+    */
+    template <typename Modifier>
+    void modify(Modifier&& modify);
+public:
+    ConcurrentRange();
+    ~ConcurrentRange();
+    ConcurrentRange(const ConcurrentRange&) = delete;
+    ConcurrentRange& operator=(const ConcurrentRange&) = delete;
+
+    /*
+        Calls "read" with a consistent snapshot of the data structure and returns its result
+        The snapshot must not be used after "read" returns, and "read" must not
+        modify this ConcurrentRange, since writers wait for it to finish
+        Never blocks
+
+        read: Callable taking a const FlatRange&
+        Time Complexity: O(1), plus the time taken by "read"
+    */
+    template <typename Reader>
+    auto Read(Reader&& read) const -> decltype(read(std::declval<const FlatRange&>()));
+
+    /*
+        Adds a range to the data structure, merging together existing
+        ranges if neccessary
+        Blocks other writers, but never readers
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(n)
+    */
+    void Add(int, int);
+
+    /*
+        Removes ranges that exist within the data structure
+        that intersect with the selection range
+        Blocks other writers, but never readers
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(n)
+    */
+    void Delete(int, int);
+
+    /*
+        Adds every range in the list to the data structure, publishing them all at once
+        Much cheaper than calling Add for each of them, as the set is only copied once
+
+        ranges: The list of selection ranges, in any order
+        Time Complexity: O(klogk + n), k being the number of ranges in the list
+    */
+    void AddBatch(const std::vector<std::pair<int, int>>&);
+
+    /*
+        Removes every range in the list from the data structure, publishing the result at once
+
+        ranges: The list of selection ranges, in any order
+        Time Complexity: O(klogk + n), k being the number of ranges in the list
+    */
+    void DeleteBatch(const std::vector<std::pair<int, int>>&);
+
+    /*
+        Returns a list of ranges that exist within the data structure
+        that intersect with the selection range
+        Never blocks
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn + k), k being the number of ranges returned
+    */
+    std::vector<std::pair<int, int>> Get(int, int) const;
+
+    /*
+        Convenience function to print the start and endpoints of the range in reverse order.
+        Returns nothing, but prints to stdout.
+        Used for Debugging.
+    */
+    void printAll() const;
+
+    /*
+        Convenience function to serialize the range into a list of start and end points.
+        Returns a list in reverse order, matching Range::toVec.
+        Used for Testcase Verification.
+    */
+    std::vector<int> toVec() const;
+};
+
+template <typename Reader>
+auto ConcurrentRange::Read(Reader&& read) const -> decltype(read(std::declval<const FlatRange&>())){
+    // announce the read on the counter of the current phase, so that writers
+    // wait for it before freeing the snapshot it is about to load
+    std::atomic<std::size_t>& counter = slots[slotIndex()].active[phase.load() & 1];
+    counter.fetch_add(1);
+    // leave the read even if "read" throws
+    struct Leave
+    {
+        std::atomic<std::size_t>& counter;
+        ~Leave() { counter.fetch_sub(1); }
+    } leave{counter};
+    return read(*current.load());
+}
+#endif
@@ -0,0 +1,854 @@
+#include "DifferentialFuzz.h"
+#include "Range.h"
+#include "FlatRange.h"
+#include "HybridRange.h"
+#include "BTreeRange.h"
+#include "PersistentRange.h"
+#include "RangeMap.h"
+#include "CompressedRange.h"
+#include "ConcurrentRange.h"
+#include "ShardedRange.h"
+#include "IngestRange.h"
+#include "DurableRange.h"
+#include "RangeSnapshot.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unistd.h>
+
+namespace {
+    // the bitmap covers [0, FuzzLimit), which holds every range a trace can have
+    const int FuzzLimit = FuzzWidth + 128;
+    /*
+        Returns how far every coordinate of a trace is moved for "placement"
+    */
+    long long shiftOf(FuzzPlacement placement){
+        switch (placement){
+        case FuzzPlacement::Lowest:
+            return std::numeric_limits<int>::lowest();
+        case FuzzPlacement::Highest:
+            return static_cast<long long>(std::numeric_limits<int>::max()) - FuzzLimit;
+        default:
+            return 0;
+        }
+    }
+
+    /*
+        Moves "point" by "shift", stopping at the lowest and highest int
+        Only the negative coordinates of empty and reversed selections go past
+        them, and stopping there keeps those selections empty or reversed
+    */
+    int place(int point, long long shift){
+        return static_cast<int>(std::clamp(point + shift, static_cast<long long>(std::numeric_limits<int>::lowest()),
+            static_cast<long long>(std::numeric_limits<int>::max())));
+    }
+
+    /*
+        The reference model: one flag per point, set when the point is in the set
+    */
+    class Bitmap
+    {
+    private:
+        std::vector<bool> bits;
+    public:
+        Bitmap() : bits(FuzzLimit, false) {}
+
+        void Set(int start, int end, bool value){
+            for (int x = std::max(start, 0); x < std::min(end, FuzzLimit); x++){
+                bits[x] = value;
+            }
+        }
+
+        // every run of set points within the selection, clipped to it
+        std::vector<std::pair<int, int>> Get(int start, int end) const{
+            std::vector<std::pair<int, int>> ret;
+            int from = std::max(start, 0);
+            int to = std::min(end, FuzzLimit);
+            for (int x = from; x < to; x++){
+                if (bits[x] && (x == from || !bits[x - 1])){
+                    ret.emplace_back(x, x + 1);
+                } else if (bits[x]){
+                    ret.back().second = x + 1;
+                }
+            }
+            return ret;
+        }
+    };
+
+    /*
+        The reference model for traces moved against the limits: the sorted list
+        of disjoint ranges in the set, rebuilt in full by every modification
+    */
+    class RangeList
+    {
+    private:
+        std::vector<std::pair<int, int>> ranges;
+    public:
+        void Set(int start, int end, bool value){
+            if (start >= end){
+                return;
+            }
+            std::vector<std::pair<int, int>> kept;
+            for (auto&& range : ranges){
+                // ranges apart from the selection stay as they are, while those
+                // overlapping or touching it join it, or lose the part within it
+                if (range.second < start || range.first > end){
+                    kept.push_back(range);
+                } else if (value){
+                    start = std::min(start, range.first);
+                    end = std::max(end, range.second);
+                } else {
+                    if (range.first < start){
+                        kept.emplace_back(range.first, start);
+                    }
+                    if (range.second > end){
+                        kept.emplace_back(end, range.second);
+                    }
+                }
+            }
+            if (value){
+                kept.emplace_back(start, end);
+            }
+            std::sort(kept.begin(), kept.end());
+            ranges = std::move(kept);
+        }
+
+        // every range intersecting the selection, clipped to it
+        std::vector<std::pair<int, int>> Get(int start, int end) const{
+            std::vector<std::pair<int, int>> ret;
+            for (auto&& range : ranges){
+                int from = std::max(start, range.first);
+                int to = std::min(end, range.second);
+                if (from < to){
+                    ret.emplace_back(from, to);
+                }
+            }
+            return ret;
+        }
+    };
+
+    /*
+        A file name in the temporary directory that no other subject uses,
+        along with every file derived from it, all removed on destruction
+    */
+    class TemporaryPath
+    {
+    private:
+        std::string path;
+    public:
+        explicit TemporaryPath(const char* prefix){
+            static std::atomic<unsigned long> counter(0);
+            path = (std::filesystem::temp_directory_path() / (std::string(prefix) + "." + std::to_string(getpid())
+                + "." + std::to_string(counter++))).string();
+        }
+        ~TemporaryPath(){
+            for (const char* suffix : {"", ".tmp", ".snap", ".snap.tmp", ".log"}){
+                std::remove((path + suffix).c_str());
+            }
+        }
+        TemporaryPath(const TemporaryPath&) = delete;
+        TemporaryPath& operator=(const TemporaryPath&) = delete;
+
+        const std::string& str() const { return path; }
+    };
+
+    /*
+        A backend under test, behind a common interface
+    */
+    class Subject
+    {
+    public:
+        const char* name;
+        // whether the whole set is only compared at Gets and at the end of the
+        // trace, rather than after every operation, so that modifications can
+        // pile up in between, as they do in IngestRange's buffer
+        bool lazy;
+
+        Subject(const char* name, bool lazy = false) : name(name), lazy(lazy) {}
+        virtual ~Subject() {}
+        virtual void Add(int, int) = 0;
+        virtual void Delete(int, int) = 0;
+        virtual std::vector<std::pair<int, int>> Get(int, int) = 0;
+        virtual void AddBatch(const std::vector<std::pair<int, int>>& ranges){
+            for (auto&& range : ranges){
+                Add(range.first, range.second);
+            }
+        }
+        virtual void DeleteBatch(const std::vector<std::pair<int, int>>& ranges){
+            for (auto&& range : ranges){
+                Delete(range.first, range.second);
+            }
+        }
+    };
+
+    /*
+        A backend with Add, Delete and Get of its own, and no batch functions
+    */
+    template <typename RangeType>
+    class Plain : public Subject
+    {
+    protected:
+        RangeType range;
+    public:
+        template <typename... Args>
+        Plain(const char* name, Args&&... args) : Subject(name), range(std::forward<Args>(args)...) {}
+        void Add(int start, int end) override { range.Add(start, end); }
+        void Delete(int start, int end) override { range.Delete(start, end); }
+        std::vector<std::pair<int, int>> Get(int start, int end) override { return range.Get(start, end); }
+    };
+
+    /*
+        A backend that also has AddBatch and DeleteBatch
+    */
+    template <typename RangeType>
+    class Batched : public Plain<RangeType>
+    {
+    public:
+        template <typename... Args>
+        Batched(const char* name, Args&&... args) : Plain<RangeType>(name, std::forward<Args>(args)...) {}
+        void AddBatch(const std::vector<std::pair<int, int>>& ranges) override { this->range.AddBatch(ranges); }
+        void DeleteBatch(const std::vector<std::pair<int, int>>& ranges) override { this->range.DeleteBatch(ranges); }
+    };
+
+    /*
+        Range with Get going parallel after the first range, on several threads
+    */
+    class ParallelGet : public Batched<Range>
+    {
+    public:
+        ParallelGet() : Batched<Range>("Range (parallel Get)") { range.SetParallelGet(1, 3); }
+    };
+
+    /*
+        Range answering Get through a CompressedRange encoding of it
+    */
+    class Compressed : public Batched<Range>
+    {
+    public:
+        Compressed() : Batched<Range>("CompressedRange") {}
+        std::vector<std::pair<int, int>> Get(int start, int end) override { return CompressedRange(range).Get(start, end); }
+    };
+
+    /*
+        Range saved to a snapshot whenever it has been modified since the last one
+        Only compared at Gets, so that not every operation writes a file
+    */
+    class Snapshotted : public Batched<Range>
+    {
+    private:
+        bool modified;
+    protected:
+        TemporaryPath path;
+
+        // saves the set if it has been modified, and returns whether it was
+        bool save(){
+            if (!modified){
+                return false;
+            }
+            SaveSnapshot(range, path.str());
+            modified = false;
+            return true;
+        }
+    public:
+        Snapshotted(const char* name, const char* prefix) : Batched<Range>(name), modified(true), path(prefix) { lazy = true; }
+        void Add(int start, int end) override {
+            Batched<Range>::Add(start, end);
+            modified = true;
+        }
+        void Delete(int start, int end) override {
+            Batched<Range>::Delete(start, end);
+            modified = true;
+        }
+        void AddBatch(const std::vector<std::pair<int, int>>& ranges) override {
+            Batched<Range>::AddBatch(ranges);
+            modified = true;
+        }
+        void DeleteBatch(const std::vector<std::pair<int, int>>& ranges) override {
+            Batched<Range>::DeleteBatch(ranges);
+            modified = true;
+        }
+    };
+
+    /*
+        Range read back with LoadSnapshot from every snapshot it saves, the set
+        read back taking the place of the one saved, so that later modifications
+        are applied to it
+    */
+    class Reloaded : public Snapshotted
+    {
+    public:
+        Reloaded() : Snapshotted("LoadSnapshot", "range_fuzz_reloaded") {}
+        std::vector<std::pair<int, int>> Get(int start, int end) override {
+            if (save()){
+                range = LoadSnapshot<int>(path.str());
+            }
+            return range.Get(start, end);
+        }
+    };
+
+    /*
+        Range answering Get through a MappedRange of the last snapshot it saved
+    */
+    class Memory : public Snapshotted
+    {
+    private:
+        std::optional<MappedRange> mapped;
+    public:
+        Memory() : Snapshotted("MappedRange", "range_fuzz_mapped") {}
+        std::vector<std::pair<int, int>> Get(int start, int end) override {
+            if (save()){
+                mapped.emplace(path.str());
+            }
+            return mapped->Get(start, end);
+        }
+    };
+
+    /*
+        DurableRange in the temporary directory, syncing every few modifications
+        without fsync, compacting often and being closed and reopened every
+        few modifications, so that the log is replayed on top of a snapshot
+    */
+    class Durable : public Subject
+    {
+    private:
+        TemporaryPath path;
+        std::optional<DurableRange> range;
+        std::size_t modifications;
+
+        static DurableOptions options(){
+            DurableOptions options;
+            options.syncEvery = 4;
+            options.sync = false;
+            options.compactEvery = 64;
+            return options;
+        }
+
+        void modified(){
+            if (++modifications % 7 == 0){
+                range.reset();
+                range.emplace(path.str(), options());
+            }
+        }
+    public:
+        Durable() : Subject("DurableRange"), path("range_fuzz_durable"), modifications(0) {
+            range.emplace(path.str(), options());
+        }
+        void Add(int start, int end) override {
+            range->Add(start, end);
+            modified();
+        }
+        void Delete(int start, int end) override {
+            range->Delete(start, end);
+            modified();
+        }
+        std::vector<std::pair<int, int>> Get(int start, int end) override { return range->Get(start, end); }
+    };
+
+    /*
+        Range over 64 bit coordinates, with every point moved by "delta" on the way in
+        and back on the way out, which maps the ints onto 2^32 consecutive coordinates
+        Moving the trace against an int limit moves it against the same limit of "Key"
+    */
+    template <typename Key>
+    class Wide : public Subject
+    {
+    private:
+        BasicRange<Key> range;
+        // added in unsigned arithmetic, which wraps around
+        std::uint64_t delta;
+
+        Key widen(int point) const{
+            return static_cast<Key>(static_cast<std::uint64_t>(static_cast<std::int64_t>(point)) + delta);
+        }
+        int narrow(Key point) const{
+            return static_cast<int>(static_cast<std::int64_t>(static_cast<std::uint64_t>(point) - delta));
+        }
+        std::vector<std::pair<Key, Key>> widen(const std::vector<std::pair<int, int>>& ranges) const{
+            std::vector<std::pair<Key, Key>> ret;
+            for (auto&& range : ranges){
+                ret.emplace_back(widen(range.first), widen(range.second));
+            }
+            return ret;
+        }
+    public:
+        Wide(const char* name, FuzzPlacement placement) : Subject(name) {
+            const std::uint64_t lowest = static_cast<std::uint64_t>(std::numeric_limits<Key>::lowest())
+                - static_cast<std::uint64_t>(static_cast<std::int64_t>(std::numeric_limits<int>::lowest()));
+            const std::uint64_t highest = static_cast<std::uint64_t>(std::numeric_limits<Key>::max())
+                - static_cast<std::uint64_t>(static_cast<std::int64_t>(std::numeric_limits<int>::max()));
+            // unsigned coordinates can't hold the negative ints as they are
+            if (placement == FuzzPlacement::Highest){
+                delta = highest;
+            } else if (placement == FuzzPlacement::Lowest || !std::is_signed<Key>::value){
+                delta = lowest;
+            } else {
+                delta = 0;
+            }
+        }
+        void Add(int start, int end) override { range.Add(widen(start), widen(end)); }
+        void Delete(int start, int end) override { range.Delete(widen(start), widen(end)); }
+        std::vector<std::pair<int, int>> Get(int start, int end) override {
+            std::vector<std::pair<int, int>> ret;
+            for (auto&& elem : range.Get(widen(start), widen(end))){
+                ret.emplace_back(narrow(elem.first), narrow(elem.second));
+            }
+            return ret;
+        }
+        void AddBatch(const std::vector<std::pair<int, int>>& ranges) override { range.AddBatch(widen(ranges)); }
+        void DeleteBatch(const std::vector<std::pair<int, int>>& ranges) override { range.DeleteBatch(widen(ranges)); }
+    };
+
+    /*
+        RangeMap with the same payload everywhere, so that it joins ranges just like Range
+    */
+    class Mapped : public Subject
+    {
+    private:
+        RangeMap<int> map;
+    public:
+        Mapped() : Subject("RangeMap") {}
+        void Add(int start, int end) override { map.Add(start, end, 0); }
+        void Delete(int start, int end) override { map.Delete(start, end); }
+        std::vector<std::pair<int, int>> Get(int start, int end) override {
+            std::vector<std::pair<int, int>> ret;
+            for (auto&& segment : map.Get(start, end)){
+                ret.emplace_back(segment.start, segment.end);
+            }
+            return ret;
+        }
+    };
+
+    /*
+        HybridRange with the trace moved down by half its width, so that ranges
+        keep crossing the boundary between the chunks on either side of 0
+        A trace moved against the limits is left where it is, the limits being
+        chunk boundaries already
+    */
+    class Hybrid : public Subject
+    {
+    private:
+        int offset;
+        HybridRange range;
+
+        // the selections of every point at once stay at the lowest point
+        int shift(int point) const{
+            return point < std::numeric_limits<int>::lowest() + offset ? std::numeric_limits<int>::lowest() : point - offset;
+        }
+    public:
+        explicit Hybrid(FuzzPlacement placement) : Subject("HybridRange"),
+            offset(placement == FuzzPlacement::Middle ? FuzzWidth / 2 : 0) {}
+        void Add(int start, int end) override { range.Add(shift(start), shift(end)); }
+        void Delete(int start, int end) override { range.Delete(shift(start), shift(end)); }
+        std::vector<std::pair<int, int>> Get(int start, int end) override {
+            std::vector<std::pair<int, int>> ret = range.Get(shift(start), shift(end));
+            for (auto& elem : ret){
+                elem.first += offset;
+                elem.second += offset;
+            }
+            return ret;
+        }
+    };
+
+    /*
+        IngestRange with a small buffer, so that batches are cut short and producers
+        block, flushing before every Get so that it sees every earlier modification
+    */
+    class Ingested : public Subject
+    {
+    private:
+        IngestRange range;
+
+        static IngestOptions options(){
+            IngestOptions options;
+            options.capacity = 16;
+            options.batchSize = 8;
+            options.maxDelay = std::chrono::hours(1);
+            return options;
+        }
+    public:
+        Ingested() : Subject("IngestRange", true), range(options()) {}
+        void Add(int start, int end) override { range.Add(start, end); }
+        void Delete(int start, int end) override { range.Delete(start, end); }
+        std::vector<std::pair<int, int>> Get(int start, int end) override {
+            range.Flush();
+            return range.Get(start, end);
+        }
+    };
+
+    /*
+        Returns one of every backend, each holding an empty set,
+        set up for traces moved to "placement"
+    */
+    std::vector<std::unique_ptr<Subject>> makeSubjects(FuzzPlacement placement){
+        const long long shift = shiftOf(placement);
+        std::vector<std::unique_ptr<Subject>> subjects;
+        subjects.emplace_back(new Batched<Range>("Range"));
+        subjects.emplace_back(new Batched<PooledRange>("PooledRange"));
+        subjects.emplace_back(new ParallelGet());
+        subjects.emplace_back(new Compressed());
+        subjects.emplace_back(new Reloaded());
+        subjects.emplace_back(new Memory());
+        subjects.emplace_back(new Wide<std::int64_t>("BasicRange<int64_t>", placement));
+        subjects.emplace_back(new Wide<std::uint64_t>("BasicRange<uint64_t>", placement));
+        subjects.emplace_back(new Batched<FlatRange>("FlatRange"));
+        subjects.emplace_back(new Hybrid(placement));
+        subjects.emplace_back(new Plain<BTreeRange<>>("BTreeRange"));
+        subjects.emplace_back(new Plain<BTreeRange<4>>("BTreeRange<4>"));
+        subjects.emplace_back(new Plain<PersistentRange>("PersistentRange"));
+        subjects.emplace_back(new Mapped());
+        subjects.emplace_back(new Batched<ConcurrentRange>("ConcurrentRange"));
+        // shards narrow enough that ranges keep crossing their boundaries
+        subjects.emplace_back(new Plain<ShardedRange>("ShardedRange", 8, place(0, shift), place(FuzzWidth, shift)));
+        subjects.emplace_back(new Ingested());
+        subjects.emplace_back(new Durable());
+        return subjects;
+    }
+
+    /*
+        Formats a call on a selection range, as in "Get(3, 9)"
+    */
+    std::string describe(const char* call, int start, int end){
+        return std::string(call) + "(" + std::to_string(start) + ", " + std::to_string(end) + ")";
+    }
+
+    void printRanges(std::ostream& out, const std::vector<std::pair<int, int>>& ranges){
+        for (auto&& range : ranges){
+            out << "(" << range.first << ", " << range.second << "), ";
+        }
+        out << std::endl;
+    }
+}
+
+namespace {
+    /*
+        Applies "trace", moved to "placement", to "model" and every backend,
+        comparing them after every operation
+        Gets are compared on every backend, and so is the whole set after every
+        operation, except on the lazy backends, which only compare it at the end
+        and at Gets
+    */
+    template <typename Model>
+    std::optional<FuzzFailure> differential(FuzzTrace trace, FuzzPlacement placement, Model& model){
+        const long long shift = shiftOf(placement);
+        for (auto& op : trace){
+            op.start = place(op.start, shift);
+            op.end = place(op.end, shift);
+            for (auto& range : op.batch){
+                range = std::make_pair(place(range.first, shift), place(range.second, shift));
+            }
+        }
+        std::vector<std::unique_ptr<Subject>> subjects = makeSubjects(placement);
+        const int lowest = std::numeric_limits<int>::lowest();
+        const int highest = std::numeric_limits<int>::max();
+        for (std::size_t step = 0; step < trace.size(); step++){
+            const FuzzOp& op = trace[step];
+            std::vector<std::pair<int, int>> expected;
+            switch (op.kind){
+            case FuzzOp::Add:
+                model.Set(op.start, op.end, true);
+                break;
+            case FuzzOp::Delete:
+                model.Set(op.start, op.end, false);
+                break;
+            case FuzzOp::Get:
+                expected = model.Get(op.start, op.end);
+                break;
+            case FuzzOp::AddBatch:
+            case FuzzOp::DeleteBatch:
+                for (auto&& range : op.batch){
+                    model.Set(range.first, range.second, op.kind == FuzzOp::AddBatch);
+                }
+                break;
+            }
+            std::vector<std::pair<int, int>> whole = model.Get(lowest, highest);
+            bool last = step + 1 == trace.size();
+            for (auto&& subject : subjects){
+                switch (op.kind){
+                case FuzzOp::Add:
+                    subject->Add(op.start, op.end);
+                    break;
+                case FuzzOp::Delete:
+                    subject->Delete(op.start, op.end);
+                    break;
+                case FuzzOp::Get: {
+                    std::vector<std::pair<int, int>> actual = subject->Get(op.start, op.end);
+                    if (actual != expected){
+                        return FuzzFailure{step, subject->name, describe("Get", op.start, op.end), expected, actual, placement};
+                    }
+                    break;
+                }
+                case FuzzOp::AddBatch:
+                    subject->AddBatch(op.batch);
+                    break;
+                case FuzzOp::DeleteBatch:
+                    subject->DeleteBatch(op.batch);
+                    break;
+                }
+                if (!subject->lazy || last || op.kind == FuzzOp::Get){
+                    std::vector<std::pair<int, int>> actual = subject->Get(lowest, highest);
+                    if (actual != whole){
+                        return FuzzFailure{step, subject->name, "whole set", whole, actual, placement};
+                    }
+                }
+            }
+        }
+        return std::nullopt;
+    }
+}
+
+/*
+    Applies "trace" to the bitmap and every backend, comparing them after every operation
+    Traces moved against the limits are checked against a list of ranges instead,
+    since a bitmap only covers the points around 0
+*/
+std::optional<FuzzFailure> runDifferential(const FuzzTrace& trace, FuzzPlacement placement){
+    if (placement == FuzzPlacement::Middle){
+        Bitmap bitmap;
+        return differential(trace, placement, bitmap);
+    }
+    RangeList list;
+    return differential(trace, placement, list);
+}
+
+/*
+    Returns a random trace of "length" operations
+    Keeps a pool of the ends of recent ranges to pick coordinates next to
+*/
+FuzzTrace randomTrace(std::mt19937& gen, std::size_t length){
+    std::vector<int> edges = {0};
+    auto random = [&](int bound){
+        return static_cast<int>(gen() % static_cast<unsigned>(bound));
+    };
+    auto point = [&](){
+        if (random(2) == 0){
+            return std::clamp(edges[random(static_cast<int>(edges.size()))] + random(3) - 1, 0, FuzzWidth - 1);
+        }
+        return random(FuzzWidth);
+    };
+    auto range = [&](){
+        int start = point();
+        int end;
+        int roll = random(32);
+        if (roll == 0){
+            end = start;
+        } else if (roll == 1){
+            end = start - 1 - random(8);
+        } else if (roll == 2){
+            start = 0;
+            end = FuzzLimit;
+        } else if (roll < 16){
+            end = start + 1 + random(16);
+        } else {
+            end = point();
+            if (end < start){
+                std::swap(start, end);
+            }
+            end = std::min(end, start + 127);
+        }
+        if (edges.size() >= 64){
+            edges.erase(edges.begin() + random(64));
+        }
+        edges.push_back(start);
+        edges.push_back(std::clamp(end, 0, FuzzWidth - 1));
+        return std::make_pair(start, end);
+    };
+    FuzzTrace trace(length);
+    for (auto& op : trace){
+        int roll = random(20);
+        op.kind = roll < 7 ? FuzzOp::Add : roll < 13 ? FuzzOp::Delete : roll < 17 ? FuzzOp::Get
+            : roll < 19 ? FuzzOp::AddBatch : FuzzOp::DeleteBatch;
+        if (op.kind == FuzzOp::AddBatch || op.kind == FuzzOp::DeleteBatch){
+            for (int i = random(8); i >= 0; i--){
+                op.batch.push_back(range());
+            }
+        } else {
+            std::tie(op.start, op.end) = range();
+        }
+    }
+    return trace;
+}
+
+/*
+    Decodes arbitrary bytes into a trace
+    Reads zeros past the end of the input, and stops once it has been read
+*/
+FuzzTrace decodeTrace(const std::uint8_t* data, std::size_t size){
+    std::size_t next = 0;
+    auto byte = [&]() -> std::uint8_t {
+        return next < size ? data[next++] : 0;
+    };
+    auto range = [&](){
+        int low = byte();
+        int high = byte();
+        int start = (low | high << 8) % FuzzWidth;
+        int length = static_cast<std::int8_t>(byte());
+        return std::make_pair(start, start + length);
+    };
+    FuzzTrace trace;
+    while (next < size){
+        FuzzOp op = FuzzOp();
+        op.kind = static_cast<FuzzOp::Kind>(byte() % 5);
+        if (op.kind == FuzzOp::AddBatch || op.kind == FuzzOp::DeleteBatch){
+            for (int count = byte() % 16; count > 0; count--){
+                op.batch.push_back(range());
+            }
+        } else {
+            std::tie(op.start, op.end) = range();
+        }
+        trace.push_back(op);
+    }
+    return trace;
+}
+
+/*
+    Returns a smallest trace it can find that "fails" still holds for
+    Each pass removes operations, from large chunks down to single ones, then
+    tries simpler versions of each operation that is left, keeping any change
+    that still fails. Passes repeat until one changes nothing.
+*/
+FuzzTrace shrinkTrace(FuzzTrace trace, const std::function<bool(const FuzzTrace&)>& fails){
+    bool changed = true;
+    auto attempt = [&](FuzzTrace candidate){
+        if (fails(candidate)){
+            trace = std::move(candidate);
+            changed = true;
+            return true;
+        }
+        return false;
+    };
+    while (changed){
+        changed = false;
+        for (std::size_t chunk = std::max<std::size_t>(trace.size() / 2, 1); chunk > 0; chunk /= 2){
+            for (std::size_t i = 0; i < trace.size(); ){
+                FuzzTrace candidate = trace;
+                candidate.erase(candidate.begin() + i, candidate.begin() + std::min(i + chunk, trace.size()));
+                if (!attempt(std::move(candidate))){
+                    i += chunk;
+                }
+            }
+        }
+        for (std::size_t i = 0; i < trace.size(); i++){
+            // a batch of one becomes a plain Add or Delete, otherwise its ranges are removed one at a time
+            if (trace[i].kind == FuzzOp::AddBatch || trace[i].kind == FuzzOp::DeleteBatch){
+                if (trace[i].batch.size() == 1){
+                    FuzzTrace candidate = trace;
+                    FuzzOp& op = candidate[i];
+                    op.kind = op.kind == FuzzOp::AddBatch ? FuzzOp::Add : FuzzOp::Delete;
+                    std::tie(op.start, op.end) = op.batch[0];
+                    op.batch.clear();
+                    attempt(std::move(candidate));
+                    continue;
+                }
+                for (std::size_t j = 0; j < trace[i].batch.size(); ){
+                    FuzzTrace candidate = trace;
+                    candidate[i].batch.erase(candidate[i].batch.begin() + j);
+                    if (!attempt(std::move(candidate))){
+                        j++;
+                    }
+                }
+                continue;
+            }
+            // narrow the range from either side and move it down, by large steps first
+            bool simplified = true;
+            while (simplified){
+                const FuzzOp& op = trace[i];
+                int width = op.end - op.start;
+                std::vector<std::pair<int, int>> simpler;
+                if (width > 1){
+                    simpler.emplace_back(op.start, op.start + width / 2);
+                    simpler.emplace_back(op.start, op.end - 1);
+                    simpler.emplace_back(op.start + 1, op.end);
+                }
+                if (op.start > 0){
+                    simpler.emplace_back(0, width);
+                    simpler.emplace_back(op.start / 2, op.start / 2 + width);
+                    simpler.emplace_back(op.start - 1, op.end - 1);
+                }
+                simplified = false;
+                for (auto&& range : simpler){
+                    FuzzTrace candidate = trace;
+                    std::tie(candidate[i].start, candidate[i].end) = range;
+                    if (attempt(std::move(candidate))){
+                        simplified = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return trace;
+}
+
+/*
+    Shrinks a trace that runDifferential finds a mismatch in
+    Drops the operations after the mismatch first, since they can't have caused it
+*/
+FuzzTrace shrinkFailure(const FuzzTrace& trace, const FuzzFailure& failure){
+    FuzzTrace prefix(trace.begin(), trace.begin() + std::min(failure.step + 1, trace.size()));
+    return shrinkTrace(prefix, [&](const FuzzTrace& candidate){
+        std::optional<FuzzFailure> found = runDifferential(candidate, failure.placement);
+        return found && found->backend == failure.backend;
+    });
+}
+
+/*
+    Prints "trace" as one call per line
+*/
+void printTrace(std::ostream& out, const FuzzTrace& trace){
+    static const char* const names[] = {"Add", "Delete", "Get", "AddBatch", "DeleteBatch"};
+    for (auto&& op : trace){
+        if (op.kind == FuzzOp::AddBatch || op.kind == FuzzOp::DeleteBatch){
+            out << names[op.kind] << "({";
+            for (std::size_t i = 0; i < op.batch.size(); i++){
+                out << (i > 0 ? ", " : "") << "{" << op.batch[i].first << ", " << op.batch[i].second << "}";
+            }
+            out << "})" << std::endl;
+        } else {
+            out << describe(names[op.kind], op.start, op.end) << std::endl;
+        }
+    }
+}
+
+/*
+    Prints a mismatch, the operations leading up to it and what was expected and found
+    The trace is printed as it was before being moved, so the distance it was
+    moved by comes first, when it was
+*/
+void printFailure(std::ostream& out, const FuzzTrace& trace, const FuzzFailure& failure){
+    out << "Mismatch in " << failure.backend << " on " << failure.what << " after operation "
+        << failure.step + 1 << " of";
+    if (failure.placement != FuzzPlacement::Middle){
+        out << " (every coordinate moved by " << shiftOf(failure.placement) << ")";
+    }
+    out << ":" << std::endl;
+    printTrace(out, trace);
+    out << "Expected : ";
+    printRanges(out, failure.expected);
+    out << "Output : ";
+    printRanges(out, failure.actual);
+}
+
+/*
+    Entry point for libFuzzer: runs the trace the input decodes to, as it is and
+    against either limit, and on a mismatch prints the shrunk trace and aborts,
+    which libFuzzer reports as a crash
+*/
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size){
+    FuzzTrace trace = decodeTrace(data, size);
+    for (FuzzPlacement placement : {FuzzPlacement::Middle, FuzzPlacement::Lowest, FuzzPlacement::Highest}){
+        if (std::optional<FuzzFailure> failure = runDifferential(trace, placement)){
+            FuzzTrace shrunk = shrinkFailure(trace, *failure);
+            printFailure(std::cerr, shrunk, runDifferential(shrunk, placement).value_or(*failure));
+            std::abort();
+        }
+    }
+    return 0;
+}
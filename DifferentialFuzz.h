@@ -0,0 +1,140 @@
+#ifndef _DIFFERENTIAL_FUZZ_H_
+#define _DIFFERENTIAL_FUZZ_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+    Differential testing of every Range implementation against a bitmap.
+
+    A trace is a list of operations. runDifferential applies it, one operation at a
+    time, to a plain bitmap of the points in the set, which is too simple to be
+    wrong, and to every backend: Range, PooledRange, FlatRange, HybridRange,
+    BTreeRange, PersistentRange, RangeMap, ConcurrentRange, ShardedRange, IngestRange
+    and DurableRange, plus Range with parallel Get forced on, CompressedRange
+    encodings of it, Range saved to a snapshot and read back with LoadSnapshot or
+    MappedRange, and the 64 bit instantiations of Range. After every operation,
+    each backend's whole set must match the bitmap, and so must the result of
+    every Get. Batches go through AddBatch and DeleteBatch where a backend has
+    them, and one range at a time where it doesn't.
+
+    Coordinates stay between -128 and FuzzWidth + 128, so that random operations
+    keep colliding with each other and the bitmap stays small. A trace can also
+    be run moved down against the lowest int, or up against the highest, in which
+    case it is checked against a sorted list of ranges instead of the bitmap.
+
+    shrinkTrace cuts a failing trace down to a minimal one that still fails, to
+    be printed with printTrace and pasted into a test case.
+
+    LLVMFuzzerTestOneInput, defined in DifferentialFuzz.cpp, decodes its input with
+    decodeTrace and aborts on a mismatch, after printing the shrunk trace, so the
+    harness runs under libFuzzer with "make libfuzzer" as well as from range_fuzz.
+*/
+
+// starting points of the ranges in a trace are in [0, FuzzWidth)
+static constexpr int FuzzWidth = 512;
+
+/*
+    A single operation of a trace
+*/
+struct FuzzOp
+{
+    enum Kind : std::uint8_t { Add, Delete, Get, AddBatch, DeleteBatch };
+
+    Kind kind;
+    // the selection range of Add, Delete and Get; may be empty or reversed
+    int start;
+    int end;
+    // the selection ranges of AddBatch and DeleteBatch
+    std::vector<std::pair<int, int>> batch;
+};
+
+typedef std::vector<FuzzOp> FuzzTrace;
+
+/*
+    Where runDifferential runs a trace within the coordinates
+    Middle runs it as it is, checked against the bitmap. Lowest moves every
+    coordinate down so that 0 lands on the lowest int, and Highest moves them
+    up so that FuzzWidth + 128 lands on the highest, both checked against a sorted
+    list of ranges, and with the 64 bit backends moved against their own limits too.
+*/
+enum class FuzzPlacement { Middle, Lowest, Highest };
+
+/*
+    Where a trace first went wrong, as returned by runDifferential
+*/
+struct FuzzFailure
+{
+    // index of the operation after which the mismatch was found
+    std::size_t step;
+    // the backend that disagreed with the bitmap, or the list of ranges
+    std::string backend;
+    // what was compared: the result of a Get, or the whole set
+    std::string what;
+    std::vector<std::pair<int, int>> expected;
+    std::vector<std::pair<int, int>> actual;
+    // where the trace was run, which "what", "expected" and "actual" are given in terms of
+    FuzzPlacement placement;
+};
+
+/*
+    Applies "trace" to the bitmap and every backend, comparing them after every operation
+    Returns the first mismatch, or nothing if they all agreed throughout
+    Time Complexity: O(k * (b * n + w)), k being the number of operations,
+    b the number of backends, n the number of ranges and w the width of the bitmap
+
+    trace: the operations to apply
+    placement: where to move the trace to before applying it
+*/
+std::optional<FuzzFailure> runDifferential(const FuzzTrace&, FuzzPlacement placement = FuzzPlacement::Middle);
+
+/*
+    Returns a random trace of "length" operations
+    Half of the coordinates are picked next to the ends of earlier ranges, so that
+    ranges keep touching, nesting and cutting each other exactly at their edges,
+    and a few operations are empty, reversed or cover every point at once
+*/
+FuzzTrace randomTrace(std::mt19937&, std::size_t length);
+
+/*
+    Decodes arbitrary bytes into a trace, so that every input is a valid one
+    Each operation takes a byte for its kind, then two bytes of start point and one
+    of signed length for each range, with batches taking a byte for their size first
+*/
+FuzzTrace decodeTrace(const std::uint8_t* data, std::size_t size);
+
+/*
+    Returns a smallest trace it can find that "fails" still holds for, given one it holds for
+    First removes operations, in halves, then quarters and so on down to single
+    ones, then removes ranges from batches and narrows and lowers the ranges that
+    are left, repeating until nothing more can be removed or simplified
+    Calls "fails" O(k^2) times in the worst case, k being the length of the trace
+
+    trace: a trace that "fails" returns true for
+    fails: returns whether a candidate trace still shows the problem
+*/
+FuzzTrace shrinkTrace(FuzzTrace trace, const std::function<bool(const FuzzTrace&)>& fails);
+
+/*
+    Shrinks a trace that runDifferential finds a mismatch in, keeping only
+    candidates that fail on the same backend, at the same placement
+*/
+FuzzTrace shrinkFailure(const FuzzTrace&, const FuzzFailure&);
+
+/*
+    Prints "trace" as one call per line, e.g. "Add(3, 9)", ready to be turned into a test case
+*/
+void printTrace(std::ostream&, const FuzzTrace&);
+
+/*
+    Prints a mismatch, the operations leading up to it and what was expected and found
+*/
+void printFailure(std::ostream&, const FuzzTrace&, const FuzzFailure&);
+#endif
@@ -0,0 +1,371 @@
+#include "DurableRange.h"
+#include "RangeSnapshot.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    // the first bytes of every log file
+    const char logMagic[8] = {'R', 'A', 'N', 'G', 'E', 'L', 'O', 'G'};
+    // incremented whenever the layout of the log changes
+    const std::uint32_t logVersion = 1;
+
+    struct LogHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+    };
+
+    /*
+        Throws std::runtime_error, mentioning "path"
+    */
+    void fail(const std::string& path, const char* reason){
+        throw std::runtime_error("log " + path + ": " + reason);
+    }
+
+    /*
+        Writes "bytes" bytes from "data" to "file", retrying short writes
+        Returns whether everything was written
+    */
+    bool writeAll(int file, const void* data, std::size_t bytes){
+        const char* next = static_cast<const char*>(data);
+        while (bytes > 0){
+            ssize_t written = write(file, next, bytes);
+            if (written < 0 && errno == EINTR){
+                continue;
+            }
+            if (written <= 0){
+                return false;
+            }
+            next += written;
+            bytes -= written;
+        }
+        return true;
+    }
+
+    /*
+        Empties "file" down to a fresh header
+        Returns whether it succeeded
+    */
+    bool resetLog(int file){
+        LogHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, logMagic, sizeof(logMagic));
+        header.version = logVersion;
+        return ftruncate(file, 0) == 0 && writeAll(file, &header, sizeof(header)) && fdatasync(file) == 0;
+    }
+}
+
+/*
+    Opens the durable set stored at "path", creating it if it doesn't exist
+*/
+DurableRange::DurableRange(const std::string& path, DurableOptions options)
+    : options(options), snapshotPath(path + ".snap"), logPath(path + ".log"), logFile(-1),
+    appended(0), durable(0), syncing(false), failed(false), logRecords(0) {
+    if (this->options.syncEvery == 0){
+        this->options.syncEvery = 1;
+    }
+    try {
+        recover();
+    } catch (...) {
+        if (logFile >= 0){
+            close(logFile);
+        }
+        throw;
+    }
+}
+
+/*
+    Writes any pending modifications to the log before closing it
+*/
+DurableRange::~DurableRange() {
+    try {
+        Sync();
+    } catch (const std::runtime_error&) {
+        // nothing more can be done about it here, the modifications
+        // that didn't make it into the log are lost
+    }
+    close(logFile);
+}
+
+/*
+    Returns the checksum of the fields of "record" other than the checksum itself
+    (32 bit FNV-1a, taking each field as one word)
+*/
+std::uint32_t DurableRange::checksumOf(const LogRecord& record){
+    const std::uint32_t words[3] = {
+        record.op, static_cast<std::uint32_t>(record.start), static_cast<std::uint32_t>(record.end)
+    };
+    std::uint32_t hash = 2166136261u;
+    for (std::uint32_t word : words){
+        hash = (hash ^ word) * 16777619u;
+    }
+    return hash;
+}
+
+/*
+    Loads the snapshot and replays the log, creating the log if it doesn't exist
+    A crash can leave a partially written record at the end of the log, which is
+    recognized by its checksum and cut off, along with anything after it
+*/
+void DurableRange::recover(){
+    if (access(snapshotPath.c_str(), F_OK) == 0){
+        range = LoadSnapshot<int>(snapshotPath);
+    }
+    logFile = open(logPath.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (logFile < 0){
+        fail(logPath, "can't be opened");
+    }
+    struct stat info;
+    if (fstat(logFile, &info) != 0){
+        fail(logPath, "can't be read");
+    }
+    std::vector<char> contents(info.st_size);
+    std::size_t read = 0;
+    while (read < contents.size()){
+        ssize_t got = pread(logFile, contents.data() + read, contents.size() - read, read);
+        if (got < 0 && errno == EINTR){
+            continue;
+        }
+        if (got <= 0){
+            fail(logPath, "can't be read");
+        }
+        read += got;
+    }
+    // a new log, or one whose header never made it to disk
+    if (contents.size() < sizeof(LogHeader)){
+        if (!resetLog(logFile)){
+            fail(logPath, "can't be created");
+        }
+        return;
+    }
+    LogHeader header;
+    std::memcpy(&header, contents.data(), sizeof(header));
+    if (std::memcmp(header.magic, logMagic, sizeof(logMagic)) != 0){
+        fail(logPath, "is not a log");
+    }
+    if (header.version != logVersion){
+        fail(logPath, "has an unsupported version");
+    }
+    // replaying onto a snapshot that already contains some of the records is
+    // harmless, since every point ends up as the last record covering it left it
+    std::size_t offset = sizeof(header);
+    for (; offset + sizeof(LogRecord) <= contents.size(); offset += sizeof(LogRecord)){
+        LogRecord record;
+        std::memcpy(&record, contents.data() + offset, sizeof(record));
+        if (record.checksum != checksumOf(record)){
+            break;
+        }
+        if (record.op == AddOp){
+            range.Add(record.start, record.end);
+        } else if (record.op == DeleteOp){
+            range.Delete(record.start, record.end);
+        } else {
+            break;
+        }
+        logRecords++;
+    }
+    // new records must not end up behind a torn one, where replay would never reach them
+    if (offset != contents.size()){
+        if (ftruncate(logFile, offset) != 0 || fdatasync(logFile) != 0){
+            fail(logPath, "can't be repaired");
+        }
+    }
+}
+
+/*
+    Applies a modification to the Range and appends it to the pending records,
+    syncing and compacting as the options ask for
+*/
+void DurableRange::apply(std::unique_lock<std::mutex>& guard, Op op, int start, int end){
+    if (failed){
+        fail(logPath, "an earlier write failed");
+    }
+    if (op == AddOp){
+        range.Add(start, end);
+    } else {
+        range.Delete(start, end);
+    }
+    LogRecord record = {op, start, end, 0};
+    record.checksum = checksumOf(record);
+    pending.push_back(record);
+    appended++;
+    logRecords++;
+    if (options.compactEvery != 0 && logRecords >= options.compactEvery){
+        // compacting puts every modification so far on disk
+        compact(guard);
+    } else if (appended - durable >= options.syncEvery){
+        waitDurable(guard, appended);
+    }
+}
+
+/*
+    Returns once every record up to and including "sequence" is in the log
+    Whichever thread finds no sync running writes out every pending record,
+    releasing the lock meanwhile, so that other threads can append more records
+    for the next sync; the rest wait for it to finish
+    A failed write is cut back off the log, so that a torn record can't hide the
+    records written after it from replay, and fails this and every later call,
+    since the records it took along can't be written in their place any more
+*/
+void DurableRange::waitDurable(std::unique_lock<std::mutex>& guard, std::uint64_t sequence){
+    while (true){
+        if (failed){
+            fail(logPath, "an earlier write failed");
+        }
+        if (durable >= sequence){
+            return;
+        }
+        if (syncing){
+            synced.wait(guard);
+            continue;
+        }
+        syncing = true;
+        std::vector<LogRecord> writing;
+        writing.swap(pending);
+        std::uint64_t last = appended;
+        guard.unlock();
+        // only the syncing thread writes to the log, so nothing can move its end meanwhile
+        off_t size = lseek(logFile, 0, SEEK_END);
+        bool written = size >= 0
+            && writeAll(logFile, writing.data(), writing.size() * sizeof(LogRecord))
+            && (!options.sync || fdatasync(logFile) == 0);
+        if (!written && size >= 0 && ftruncate(logFile, size) == 0){
+            fdatasync(logFile);
+        }
+        guard.lock();
+        // hand the buffer back so that appending doesn't have to allocate again
+        if (pending.empty()){
+            writing.clear();
+            pending.swap(writing);
+        }
+        syncing = false;
+        failed = !written;
+        synced.notify_all();
+        if (failed){
+            fail(logPath, "write failed");
+        }
+        durable = last;
+    }
+}
+
+/*
+    Writes the whole set to the snapshot and empties the log
+    The log is brought up to date first: if the process crashes after the snapshot
+    replaces the old one but before the log is emptied, replaying the whole log
+    onto the new snapshot gives the same set, whereas replaying only part of it
+    could undo modifications that came later
+*/
+void DurableRange::compact(std::unique_lock<std::mutex>& guard){
+    if (failed){
+        fail(logPath, "an earlier write failed");
+    }
+    while (syncing || durable != appended){
+        if (syncing){
+            synced.wait(guard);
+        } else {
+            waitDurable(guard, appended);
+        }
+    }
+    SaveSnapshot(range, snapshotPath);
+    if (!resetLog(logFile)){
+        failed = true;
+        fail(logPath, "can't be emptied");
+    }
+    logRecords = 0;
+}
+
+/*
+    Adds a range to the data structure, merging together existing
+    ranges if neccessary, and logs it
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn), plus a sync every options.syncEvery modifications
+*/
+void DurableRange::Add(int start, int end){
+    // an empty selection covers nothing, so there is nothing to log either
+    if (start >= end){
+        return;
+    }
+    std::unique_lock<std::mutex> guard(lock);
+    apply(guard, AddOp, start, end);
+}
+
+/*
+    Removes ranges that exist within the data structure
+    that intersect with the selection range, and logs it
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn), plus a sync every options.syncEvery modifications
+*/
+void DurableRange::Delete(int start, int end){
+    if (start >= end){
+        return;
+    }
+    std::unique_lock<std::mutex> guard(lock);
+    apply(guard, DeleteOp, start, end);
+}
+
+/*
+    Returns a list of ranges that exist within the data structure
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(n)
+*/
+std::vector<std::pair<int, int>> DurableRange::Get(int start, int end) const{
+    std::lock_guard<std::mutex> guard(lock);
+    return range.Get(start, end);
+}
+
+/*
+    Returns once every modification made so far is on disk
+*/
+void DurableRange::Sync(){
+    std::unique_lock<std::mutex> guard(lock);
+    waitDurable(guard, appended);
+}
+
+/*
+    Writes the whole set to the snapshot and empties the log
+    Time Complexity: O(n)
+*/
+void DurableRange::Compact(){
+    std::unique_lock<std::mutex> guard(lock);
+    compact(guard);
+}
+
+/*
+    Returns the number of records in the log, including those not yet written
+*/
+std::size_t DurableRange::LogSize() const{
+    std::lock_guard<std::mutex> guard(lock);
+    return logRecords;
+}
+
+/*
+    Convenience function to print the start and endpoints of the range in reverse order.
+    Returns nothing, but prints to stdout.
+    Used for Debugging.
+*/
+void DurableRange::printAll() const{
+    std::lock_guard<std::mutex> guard(lock);
+    range.printAll();
+}
+
+/*
+    Convenience function to serialize the range into a list of start and end points.
+    Returns a list in reverse order, matching Range::toVec.
+    Used for Testcase Verification.
+*/
+std::vector<int> DurableRange::toVec() const{
+    std::lock_guard<std::mutex> guard(lock);
+    return range.toVec();
+}
@@ -0,0 +1,206 @@
+#ifndef _DURABLE_RANGE_H_
+#define _DURABLE_RANGE_H_
+
+#include "Range.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+    Controls how often a DurableRange syncs its log to disk and compacts it
+*/
+struct DurableOptions
+{
+    // number of modifications that may be pending before one of them waits
+    // for the log to be synced, at least 1
+    // with 1, Add and Delete only return once their change is on disk;
+    // with more, up to syncEvery - 1 acknowledged changes can be lost in a crash
+    std::size_t syncEvery = 1;
+    // whether syncing calls fsync; without it, the log is only handed
+    // to the operating system, which survives the process crashing but
+    // not the machine
+    bool sync = true;
+    // number of records in the log at which it is compacted into the snapshot,
+    // 0 to only compact when Compact is called
+    std::size_t compactEvery = 0;
+};
+
+/*
+    Thread safe variant of Range whose contents survive a crash.
+
+    Every Add and Delete is applied to a Range in memory and appended to a log
+    at path + ".log". Compacting writes the whole set to a snapshot at
+    path + ".snap" (see RangeSnapshot.h) and empties the log. Opening a
+    DurableRange loads the snapshot, if there is one, and replays the log on
+    top of it, dropping a partially written record at the end of the log.
+
+    Syncing uses group commit: a modification that has to wait for the disk
+    writes and syncs every record appended so far, including those of threads
+    that arrived while the previous sync was running, so concurrent writers
+    share each fsync rather than queueing up for their own.
+
+    Get reflects every modification that has returned, whether or not it has
+    reached the disk yet.
+
+    A modification is applied to the Range before its record is written, so
+    if writing the log fails, the Range can hold modifications the log
+    doesn't. From then on every Add, Delete, Sync and Compact throws, rather
+    than report modifications as durable that may not be; Get keeps working,
+    and reopening the set gives back everything the log did hold.
+*/
+class DurableRange
+{
+private:
+    // a single modification in the log
+    struct LogRecord
+    {
+        std::uint32_t op;
+        std::int32_t start;
+        std::int32_t end;
+        // detects records that were only partially written before a crash
+        std::uint32_t checksum;
+    };
+
+    enum Op : std::uint32_t { AddOp = 1, DeleteOp = 2 };
+
+    Range range;
+    DurableOptions options;
+    std::string snapshotPath;
+    std::string logPath;
+    int logFile;
+
+    // guards everything below, and the Range
+    mutable std::mutex lock;
+    // signalled whenever a sync finishes
+    std::condition_variable synced;
+    // records appended but not yet written to the log
+    std::vector<LogRecord> pending;
+    // sequence numbers of the last record appended and the last one on disk
+    std::uint64_t appended;
+    std::uint64_t durable;
+    // whether a thread is currently writing and syncing the log
+    bool syncing;
+    // whether writing the log has failed, after which every modification and sync throws
+    bool failed;
+    // number of records in the log file
+    std::size_t logRecords;
+
+    /*
+        Returns the checksum of the fields of "record" other than the checksum itself
+    */
+    static std::uint32_t checksumOf(const LogRecord& record);
+
+    /*
+        Loads the snapshot and replays the log, creating the log if it doesn't exist
+    */
+    void recover();
+
+    /*
+        Applies a modification to the Range and appends it to the pending records,
+        syncing and compacting as the options ask for
+        Must be called with "guard" holding the lock
+    */
+    void apply(std::unique_lock<std::mutex>& guard, Op op, int start, int end);
+
+    /*
+        Returns once every record up to and including "sequence" is in the log
+        Must be called with "guard" holding the lock, which is released while writing
+    */
+    void waitDurable(std::unique_lock<std::mutex>& guard, std::uint64_t sequence);
+
+    /*
+        Writes the whole set to the snapshot and empties the log
+        Must be called with "guard" holding the lock
+    */
+    void compact(std::unique_lock<std::mutex>& guard);
+public:
+    /*
+        Opens the durable set stored at "path", creating it if it doesn't exist
+        Throws std::runtime_error if the files can't be read or written,
+        or the snapshot is corrupt
+
+        path: prefix of the snapshot and log file names
+        options: how often to sync and compact
+    */
+    explicit DurableRange(const std::string& path, DurableOptions options = DurableOptions());
+
+    /*
+        Writes any pending modifications to the log before closing it
+    */
+    ~DurableRange();
+    DurableRange(const DurableRange&) = delete;
+    DurableRange& operator=(const DurableRange&) = delete;
+
+    /*
+        Adds a range to the data structure, merging together existing
+        ranges if neccessary, and logs it
+        Throws std::runtime_error if the log can't be written, now or by an
+        earlier modification, after which the log may be missing recent modifications
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn), plus a sync every options.syncEvery modifications
+    */
+    void Add(int, int);
+
+    /*
+        Removes ranges that exist within the data structure
+        that intersect with the selection range, and logs it
+        Throws std::runtime_error if the log can't be written, now or by an
+        earlier modification, after which the log may be missing recent modifications
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn), plus a sync every options.syncEvery modifications
+    */
+    void Delete(int, int);
+
+    /*
+        Returns a list of ranges that exist within the data structure
+        that intersect with the selection range
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(n)
+    */
+    std::vector<std::pair<int, int>> Get(int, int) const;
+
+    /*
+        Returns once every modification made so far is on disk
+        Throws std::runtime_error if the log can't be written, now or earlier
+    */
+    void Sync();
+
+    /*
+        Writes the whole set to the snapshot and empties the log, so that
+        opening it doesn't have to replay every modification ever made
+        Blocks every other operation until the snapshot is written
+        Throws std::runtime_error if the snapshot or the log can't be written, now or earlier
+        Time Complexity: O(n)
+    */
+    void Compact();
+
+    /*
+        Returns the number of records in the log, including those not yet written
+    */
+    std::size_t LogSize() const;
+
+    /*
+        Convenience function to print the start and endpoints of the range in reverse order.
+        Returns nothing, but prints to stdout.
+        Used for Debugging.
+    */
+    void printAll() const;
+
+    /*
+        Convenience function to serialize the range into a list of start and end points.
+        Returns a list in reverse order, matching Range::toVec.
+        Used for Testcase Verification.
+    */
+    std::vector<int> toVec() const;
+};
+#endif
@@ -0,0 +1,761 @@
+#include "FlatRange.h"
+#include "Range.h"
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+// the vectorized lookups rely on GCC's per function target attributes and
+// runtime processor detection, everything else uses the scalar one
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FLAT_RANGE_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+    /*
+        Moves "count" values from "from" to "to", which may overlap, adding "change"
+        to each, in a single pass rather than moving them and then adding to them
+        Goes 4 at a time with SSE2 where the compiler may assume it, as on every
+        x86-64 processor, since GCC doesn't vectorize the plain loops below -O3
+    */
+    void moveAdding(const unsigned int* from, unsigned int* to, std::size_t count, unsigned int change){
+        if (to <= from){
+            std::size_t i = 0;
+#if defined(FLAT_RANGE_X86) && defined(__SSE2__)
+            __m128i add = _mm_set1_epi32(static_cast<int>(change));
+            for (; i + 4 <= count; i += 4){
+                __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), _mm_add_epi32(value, add));
+            }
+#endif
+            for (; i < count; i++){
+                to[i] = from[i] + change;
+            }
+        } else {
+            // moving up, so start from the top to read every value before it is overwritten
+            std::size_t i = count;
+#if defined(FLAT_RANGE_X86) && defined(__SSE2__)
+            __m128i add = _mm_set1_epi32(static_cast<int>(change));
+            for (; i >= 4; i -= 4){
+                __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i - 4));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i - 4), _mm_add_epi32(value, add));
+            }
+#endif
+            for (; i > 0; i--){
+                to[i - 1] = from[i - 1] + change;
+            }
+        }
+    }
+
+    /*
+        Returns whether "point" is covered by one of the "size" ranges given by
+        "starts" and "ends", "size" being at least 1
+        Uses the same branchless search as FlatRange::countStartsAtOrBefore, which
+        only ever moves "base" to a start at or before "point", so that
+        the range at "base" is the only one that can cover it
+    */
+    bool covers(const int* starts, const int* ends, std::size_t size, int point){
+        std::size_t base = 0;
+        while (size > 1){
+            std::size_t half = size / 2;
+            base = (starts[base + half] <= point) ? base + half : base;
+            size -= half;
+        }
+        return starts[base] <= point && point < ends[base];
+    }
+
+    /*
+        Returns the bitmap of which of "count" points, at most 64, are covered,
+        looking them up one at a time
+    */
+    std::uint64_t coversScalar(const int* starts, const int* ends, std::size_t size, const int* points, std::size_t count){
+        std::uint64_t word = 0;
+        for (std::size_t i = 0; i < count; i++){
+            word |= static_cast<std::uint64_t>(covers(starts, ends, size, points[i])) << i;
+        }
+        return word;
+    }
+
+#ifdef FLAT_RANGE_X86
+    /*
+        coversScalar, running the searches of 4 points at a time in lockstep
+        Every search takes the same number of steps, with the same step size,
+        regardless of the point, so only the bases differ between the lanes
+        SSE2 can't load from 4 different addresses at once, so the probes are
+        loaded one lane at a time, but several groups of 4 are searched at once
+        so that none of the loads wait on each other
+    */
+    __attribute__((target("sse2")))
+    std::uint64_t coversSse2(const int* starts, const int* ends, std::size_t size, const int* points, std::size_t count){
+        const std::size_t groups = 16;
+        std::uint64_t word = 0;
+        std::size_t i = 0;
+        for (; i + 4 * groups <= count; i += 4 * groups){
+            __m128i point[groups];
+            __m128i base[groups];
+            for (std::size_t g = 0; g < groups; g++){
+                point[g] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(points + i + 4 * g));
+                base[g] = _mm_setzero_si128();
+            }
+            alignas(16) int at[4];
+            for (std::size_t len = size; len > 1; ){
+                std::size_t half = len / 2;
+                __m128i step = _mm_set1_epi32(static_cast<int>(half));
+                for (std::size_t g = 0; g < groups; g++){
+                    __m128i probe = _mm_add_epi32(base[g], step);
+                    _mm_store_si128(reinterpret_cast<__m128i*>(at), probe);
+                    __m128i value = _mm_setr_epi32(starts[at[0]], starts[at[1]], starts[at[2]], starts[at[3]]);
+                    // lanes whose probe is at or before their point move up to it
+                    __m128i above = _mm_cmpgt_epi32(value, point[g]);
+                    base[g] = _mm_or_si128(_mm_and_si128(above, base[g]), _mm_andnot_si128(above, probe));
+                }
+                len -= half;
+            }
+            for (std::size_t g = 0; g < groups; g++){
+                _mm_store_si128(reinterpret_cast<__m128i*>(at), base[g]);
+                __m128i start = _mm_setr_epi32(starts[at[0]], starts[at[1]], starts[at[2]], starts[at[3]]);
+                __m128i end = _mm_setr_epi32(ends[at[0]], ends[at[1]], ends[at[2]], ends[at[3]]);
+                __m128i covered = _mm_andnot_si128(_mm_cmpgt_epi32(start, point[g]), _mm_cmpgt_epi32(end, point[g]));
+                word |= static_cast<std::uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(covered))) << (i + 4 * g);
+            }
+        }
+        // shifting by all 64 bits is undefined, so a full word has to stop here
+        return i == count ? word : word | (coversScalar(starts, ends, size, points + i, count - i) << i);
+    }
+
+    /*
+        coversScalar, running the searches of 8 points at a time in lockstep,
+        loading the probes of all 8 with a single gather
+        A gather takes long enough that a single search would mostly be waiting
+        on it, so several groups of 8 are searched at once, interleaved
+    */
+    __attribute__((target("avx2")))
+    std::uint64_t coversAvx2(const int* starts, const int* ends, std::size_t size, const int* points, std::size_t count){
+        const std::size_t groups = 8;
+        std::uint64_t word = 0;
+        std::size_t i = 0;
+        for (; i + 8 * groups <= count; i += 8 * groups){
+            __m256i point[groups];
+            __m256i base[groups];
+            for (std::size_t g = 0; g < groups; g++){
+                point[g] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(points + i + 8 * g));
+                base[g] = _mm256_setzero_si256();
+            }
+            for (std::size_t len = size; len > 1; ){
+                std::size_t half = len / 2;
+                __m256i step = _mm256_set1_epi32(static_cast<int>(half));
+                for (std::size_t g = 0; g < groups; g++){
+                    __m256i probe = _mm256_add_epi32(base[g], step);
+                    __m256i value = _mm256_i32gather_epi32(starts, probe, 4);
+                    // lanes whose probe is at or before their point move up to it
+                    base[g] = _mm256_blendv_epi8(probe, base[g], _mm256_cmpgt_epi32(value, point[g]));
+                }
+                len -= half;
+            }
+            for (std::size_t g = 0; g < groups; g++){
+                __m256i start = _mm256_i32gather_epi32(starts, base[g], 4);
+                __m256i end = _mm256_i32gather_epi32(ends, base[g], 4);
+                __m256i covered = _mm256_andnot_si256(_mm256_cmpgt_epi32(start, point[g]), _mm256_cmpgt_epi32(end, point[g]));
+                word |= static_cast<std::uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(covered))) << (i + 8 * g);
+            }
+        }
+        // shifting by all 64 bits is undefined, so a full word has to stop here
+        return i == count ? word : word | (coversScalar(starts, ends, size, points + i, count - i) << i);
+    }
+#endif
+}
+
+// nothing to do for constructor or destructor
+FlatRange::FlatRange() {
+
+}
+
+/*
+    Builds the set from a list of ranges in any order
+    Once coalesced, the ranges are sorted and disjoint, so they are
+    already the start and end points the arrays need
+
+    ranges: The list of ranges, in any order
+    Time Complexity: O(klogk), k being the number of ranges in the list
+*/
+FlatRange::FlatRange(std::vector<std::pair<int, int>> ranges) {
+    ranges = coalesce(std::move(ranges));
+    starts.reserve(ranges.size());
+    ends.reserve(ranges.size());
+    for (auto&& range : ranges){
+        starts.push_back(range.first);
+        ends.push_back(range.second);
+    }
+    sumLengths();
+}
+
+/*
+    Exchanges the ranges of the two sets without copying them
+
+    other: The set to exchange with
+    Time Complexity: O(1)
+*/
+void FlatRange::swap(FlatRange& other) noexcept{
+    starts.swap(other.starts);
+    ends.swap(other.ends);
+    coveredThrough.swap(other.coveredThrough);
+}
+
+/*
+    Returns a copy of the set
+    Copying a vector only allocates as much as its elements need
+
+    Time Complexity: O(n)
+*/
+FlatRange FlatRange::Clone() const{
+    return FlatRange(*this);
+}
+
+/*
+    Makes room for "count" ranges in the arrays
+
+    count: The number of ranges to make room for
+    Time Complexity: O(n) if the arrays grow, O(1) otherwise
+*/
+void FlatRange::Reserve(std::size_t count){
+    starts.reserve(count);
+    ends.reserve(count);
+    coveredThrough.reserve(count);
+}
+
+/*
+    Returns the number of ranges the set can hold before the arrays reallocate
+    Time Complexity: O(1)
+*/
+std::size_t FlatRange::Capacity() const{
+    return std::min({starts.capacity(), ends.capacity(), coveredThrough.capacity()});
+}
+
+/*
+    Gives back the memory the arrays hold beyond what the ranges need
+    Time Complexity: O(n)
+*/
+void FlatRange::ShrinkToFit(){
+    starts.shrink_to_fit();
+    ends.shrink_to_fit();
+    coveredThrough.shrink_to_fit();
+}
+
+/*
+    Recomputes every running total of the lengths
+    Time Complexity: O(n)
+*/
+void FlatRange::sumLengths(){
+    coveredThrough.resize(starts.size());
+    unsigned int total = 0;
+    for (std::size_t i = 0; i < starts.size(); i++){
+        // unsigned subtraction gives the right length even when it overflows int
+        total += static_cast<unsigned int>(ends[i]) - static_cast<unsigned int>(starts[i]);
+        coveredThrough[i] = total;
+    }
+}
+
+/*
+    Brings the running totals up to date after ranges "first" up to "last"
+    were replaced by "count" ranges
+    The totals after them move like the arrays did, and each of them changes by
+    the same amount, the difference in length, so they are moved and adjusted
+    in one pass, rather than summed up again one after the other
+    Time Complexity: O(n - first)
+*/
+void FlatRange::replaceTotals(std::size_t first, std::size_t last, std::size_t count){
+    unsigned int before = first > 0 ? coveredThrough[first - 1] : 0;
+    unsigned int oldTotal = last > first ? coveredThrough[last - 1] : before;
+    unsigned int total = before;
+    for (std::size_t i = first; i < first + count; i++){
+        // unsigned subtraction gives the right length even when it overflows int
+        total += static_cast<unsigned int>(ends[i]) - static_cast<unsigned int>(starts[i]);
+    }
+    std::size_t size = coveredThrough.size();
+    if (count > last - first){
+        coveredThrough.resize(size + count - (last - first));
+    }
+    moveAdding(coveredThrough.data() + last, coveredThrough.data() + first + count, size - last, total - oldTotal);
+    if (count < last - first){
+        coveredThrough.resize(size - (last - first - count));
+    }
+    total = before;
+    for (std::size_t i = first; i < first + count; i++){
+        total += static_cast<unsigned int>(ends[i]) - static_cast<unsigned int>(starts[i]);
+        coveredThrough[i] = total;
+    }
+}
+
+/*
+    Appends a range starting at or after every range so far, merging it
+    with the last one if they overlap or touch
+*/
+void FlatRange::appendSorted(int start, int end){
+    if (start >= end){
+        return;
+    }
+    if (!starts.empty() && start < starts.back()){
+        throw std::invalid_argument("FlatRange: ranges are not sorted by start point");
+    }
+    if (!ends.empty() && start <= ends.back()){
+        ends.back() = std::max(ends.back(), end);
+        return;
+    }
+    starts.push_back(start);
+    ends.push_back(end);
+}
+
+/*
+    Returns the number of start points less than or equal to "value"
+    The search halves the window without branching on the comparison,
+    which keeps the pipeline full regardless of the key being searched for
+    Time Complexity: O(logn)
+*/
+std::size_t FlatRange::countStartsAtOrBefore(int value) const{
+    std::size_t len = starts.size();
+    if (len == 0){
+        return 0;
+    }
+    const int* base = starts.data();
+    while (len > 1){
+        std::size_t half = len / 2;
+        base = (base[half] <= value) ? base + half : base;
+        len -= half;
+    }
+    return (base - starts.data()) + (*base <= value);
+}
+
+/*
+    Returns the number of start points strictly less than "value"
+    Time Complexity: O(logn)
+*/
+std::size_t FlatRange::countStartsBefore(int value) const{
+    std::size_t len = starts.size();
+    if (len == 0){
+        return 0;
+    }
+    const int* base = starts.data();
+    while (len > 1){
+        std::size_t half = len / 2;
+        base = (base[half] < value) ? base + half : base;
+        len -= half;
+    }
+    return (base - starts.data()) + (*base < value);
+}
+
+/*
+    Adds a range to the data structure, merging together existing
+    ranges if neccessary
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(n)
+*/
+void FlatRange::Add(int start, int end){
+    // an empty selection covers nothing, so there is nothing to add
+    if (start >= end){
+        return;
+    }
+    // "first" is the first range that touches or comes after "start"
+    // i.e. the range containing "start" if there is one
+    std::size_t first = countStartsAtOrBefore(start);
+    if (first > 0 && ends[first - 1] >= start){
+        first--;
+    }
+    // "last" is one past the final range that starts at or before "end"
+    // every range in [first, last) touches the new range and gets merged
+    std::size_t last = countStartsAtOrBefore(end);
+    // if nothing touches the new range, insert it in its sorted position
+    if (first == last){
+        starts.insert(starts.begin() + first, start);
+        ends.insert(ends.begin() + first, end);
+        replaceTotals(first, first, 1);
+        return;
+    }
+    // otherwise reuse the slot of the first range for the union of all the
+    // touched ranges and the new range, then remove the rest of them
+    starts[first] = std::min(start, starts[first]);
+    ends[first] = std::max(end, ends[last - 1]);
+    starts.erase(starts.begin() + first + 1, starts.begin() + last);
+    ends.erase(ends.begin() + first + 1, ends.begin() + last);
+    replaceTotals(first, last, 1);
+}
+
+/*
+    Removes ranges that exist within the data structure
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(n)
+*/
+void FlatRange::Delete(int start, int end){
+    // an empty selection covers nothing, so there is nothing to remove
+    if (start >= end){
+        return;
+    }
+    // "first" is the first range that overlaps or comes after "start"
+    std::size_t first = countStartsAtOrBefore(start);
+    if (first > 0 && ends[first - 1] > start){
+        first--;
+    }
+    // "last" is one past the final range that starts before "end"
+    std::size_t last = countStartsBefore(end);
+    // no range overlaps the selection, so nothing needs to be done
+    if (first >= last){
+        return;
+    }
+    // the parts of the outermost ranges that stick out of the selection survive
+    int oldStart = starts[first];
+    int oldEnd = ends[last - 1];
+    int keptStarts[2];
+    int keptEnds[2];
+    std::size_t kept = 0;
+    if (oldStart < start){
+        keptStarts[kept] = oldStart;
+        keptEnds[kept] = start;
+        kept++;
+    }
+    if (end < oldEnd){
+        keptStarts[kept] = end;
+        keptEnds[kept] = oldEnd;
+        kept++;
+    }
+    // overwrite as many of the removed slots as possible with the surviving
+    // pieces, then shift the remainder of the arrays down over the rest
+    std::size_t removed = last - first;
+    if (kept <= removed){
+        std::copy(keptStarts, keptStarts + kept, starts.begin() + first);
+        std::copy(keptEnds, keptEnds + kept, ends.begin() + first);
+        starts.erase(starts.begin() + first + kept, starts.begin() + last);
+        ends.erase(ends.begin() + first + kept, ends.begin() + last);
+    // deleting from the middle of a single range splits it in two
+    } else {
+        starts[first] = keptStarts[0];
+        ends[first] = keptEnds[0];
+        starts.insert(starts.begin() + first + 1, keptStarts[1]);
+        ends.insert(ends.begin() + first + 1, keptEnds[1]);
+    }
+    replaceTotals(first, last, kept);
+}
+
+/*
+    Returns a list of ranges that exist within the data structure
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn + k), k being the number of ranges returned
+*/
+std::vector<std::pair<int, int>> FlatRange::Get(int start, int end) const{
+    std::vector<std::pair<int, int>> ret;
+    // an empty selection can't intersect anything
+    if (start >= end){
+        return ret;
+    }
+    // find the first range that overlaps "start" or comes after it,
+    // and one past the last range that starts before "end"
+    std::size_t first = countStartsAtOrBefore(start);
+    if (first > 0 && ends[first - 1] > start){
+        first--;
+    }
+    std::size_t last = countStartsBefore(end);
+    // every range in between intersects the selection,
+    // so clip each one to the selection and add it to the return list
+    for (std::size_t i = first; i < last; i++){
+        ret.push_back(std::make_pair(std::max(start, starts[i]), std::min(end, ends[i])));
+    }
+    return ret;
+}
+
+/*
+    Returns whether "point" is covered by a range in the data structure
+
+    point: The point to look for
+    Time Complexity: O(logn)
+*/
+bool FlatRange::Contains(int point) const{
+    // the last range starting at or before "point" is the only one that can cover it
+    std::size_t count = countStartsAtOrBefore(point);
+    return count > 0 && point < ends[count - 1];
+}
+
+/*
+    Returns the number of points in the selection range covered by the data structure
+    Takes the total length of the ranges Get would return from the running totals,
+    then takes off the parts of the outermost ones that stick out of the selection
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn)
+*/
+unsigned int FlatRange::CoveredLength(int start, int end) const{
+    if (start >= end){
+        return 0;
+    }
+    // the same ranges Get would return
+    std::size_t first = countStartsAtOrBefore(start);
+    if (first > 0 && ends[first - 1] > start){
+        first--;
+    }
+    std::size_t last = countStartsBefore(end);
+    if (first >= last){
+        return 0;
+    }
+    // unsigned arithmetic gives the right length even when it overflows int
+    unsigned int length = coveredThrough[last - 1] - (first > 0 ? coveredThrough[first - 1] : 0);
+    if (starts[first] < start){
+        length -= static_cast<unsigned int>(start) - static_cast<unsigned int>(starts[first]);
+    }
+    if (ends[last - 1] > end){
+        length -= static_cast<unsigned int>(ends[last - 1]) - static_cast<unsigned int>(end);
+    }
+    return length;
+}
+
+/*
+    Returns the number of ranges intersecting the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn)
+*/
+std::size_t FlatRange::CountIntervals(int start, int end) const{
+    if (start >= end){
+        return 0;
+    }
+    std::size_t first = countStartsAtOrBefore(start);
+    if (first > 0 && ends[first - 1] > start){
+        first--;
+    }
+    std::size_t last = countStartsBefore(end);
+    return last - first;
+}
+
+/*
+    Returns the first point at or after "point" that isn't covered
+
+    point: The point to start looking from
+    Time Complexity: O(logn)
+*/
+int FlatRange::NextGap(int point) const{
+    // ranges never touch, so the end of the range covering "point" is never covered
+    std::size_t count = countStartsAtOrBefore(point);
+    if (count > 0 && point < ends[count - 1]){
+        return ends[count - 1];
+    }
+    return point;
+}
+
+/*
+    Returns the first point at or after "point" that is covered,
+    or nothing if there are no ranges from there on
+
+    point: The point to start looking from
+    Time Complexity: O(logn)
+*/
+std::optional<int> FlatRange::FirstCovered(int point) const{
+    std::size_t count = countStartsAtOrBefore(point);
+    if (count > 0 && point < ends[count - 1]){
+        return point;
+    }
+    if (count == starts.size()){
+        return std::nullopt;
+    }
+    return starts[count];
+}
+
+/*
+    Looks up many points at once, setting bit i % 64 of bits[i / 64]
+    if points[i] is covered and clearing it otherwise
+
+    points: The points to look for, in any order
+    count: The number of points
+    bits: Bitmap of (count + 63) / 64 words to write the results to
+    Time Complexity: O(klogn), k being the number of points
+*/
+void FlatRange::ContainsMany(const int* points, std::size_t count, std::uint64_t* bits) const{
+    ContainsMany(points, count, bits, BestSimd());
+}
+
+/*
+    ContainsMany, using "simd" if the processor supports it
+*/
+void FlatRange::ContainsMany(const int* points, std::size_t count, std::uint64_t* bits, Simd simd) const{
+    std::uint64_t (*lookup)(const int*, const int*, std::size_t, const int*, std::size_t) = coversScalar;
+#ifdef FLAT_RANGE_X86
+    switch (std::min(simd, BestSimd())){
+    case Simd::AVX2:
+        lookup = coversAvx2;
+        break;
+    case Simd::SSE2:
+        lookup = coversSse2;
+        break;
+    case Simd::Scalar:
+        break;
+    }
+#else
+    (void)simd;
+#endif
+    for (std::size_t first = 0; first < count; first += 64){
+        std::size_t points64 = std::min<std::size_t>(64, count - first);
+        // the searches need at least one range to land on
+        bits[first / 64] = starts.empty() ? 0 : lookup(starts.data(), ends.data(), starts.size(), points + first, points64);
+    }
+}
+
+/*
+    Returns the fastest instruction set this processor supports
+    Checked once, the first time it is called
+*/
+FlatRange::Simd FlatRange::BestSimd(){
+#ifdef FLAT_RANGE_X86
+    static const Simd best = __builtin_cpu_supports("avx2") ? Simd::AVX2
+        : __builtin_cpu_supports("sse2") ? Simd::SSE2 : Simd::Scalar;
+    return best;
+#else
+    return Simd::Scalar;
+#endif
+}
+
+/*
+    Adds every range in the list to the data structure.
+    Gives the same result as calling Add on each of them one at a time,
+    but sorts and coalesces them first, then merges them with the
+    existing ranges in a single pass instead of shifting the arrays
+    once per range.
+
+    ranges: The list of selection ranges, in any order
+    Time Complexity: O(klogk + n), k being the number of ranges in the list
+*/
+void FlatRange::AddBatch(const std::vector<std::pair<int, int>>& ranges){
+    std::vector<std::pair<int, int>> added = coalesce(ranges);
+    if (added.empty()){
+        return;
+    }
+    std::vector<int> newStarts;
+    std::vector<int> newEnds;
+    newStarts.reserve(starts.size() + added.size());
+    newEnds.reserve(ends.size() + added.size());
+    std::size_t i = 0;
+    for (auto&& range : added){
+        int start = range.first;
+        int end = range.second;
+        // the ranges ending before "start" are untouched, so copy them over in one go
+        // the ends are sorted just like the starts, so they can be searched too
+        std::size_t untouched = std::lower_bound(ends.begin() + i, ends.end(), start) - ends.begin();
+        newStarts.insert(newStarts.end(), starts.begin() + i, starts.begin() + untouched);
+        newEnds.insert(newEnds.end(), ends.begin() + i, ends.begin() + untouched);
+        i = untouched;
+        // the previous selection may have been extended far enough to touch this one
+        if (!newStarts.empty() && start <= newEnds.back()){
+            start = newStarts.back();
+            end = std::max(end, newEnds.back());
+            newStarts.pop_back();
+            newEnds.pop_back();
+        }
+        // merge every range that touches the selection into it
+        for (; i < starts.size() && starts[i] <= end; i++){
+            start = std::min(start, starts[i]);
+            end = std::max(end, ends[i]);
+        }
+        newStarts.push_back(start);
+        newEnds.push_back(end);
+    }
+    newStarts.insert(newStarts.end(), starts.begin() + i, starts.end());
+    newEnds.insert(newEnds.end(), ends.begin() + i, ends.end());
+    starts.swap(newStarts);
+    ends.swap(newEnds);
+    sumLengths();
+}
+
+/*
+    Removes every range in the list from the data structure.
+    Gives the same result as calling Delete on each of them one at a time,
+    in a single pass like AddBatch.
+
+    ranges: The list of selection ranges, in any order
+    Time Complexity: O(klogk + n), k being the number of ranges in the list
+*/
+void FlatRange::DeleteBatch(const std::vector<std::pair<int, int>>& ranges){
+    std::vector<std::pair<int, int>> removed = coalesce(ranges);
+    if (removed.empty()){
+        return;
+    }
+    std::vector<int> newStarts;
+    std::vector<int> newEnds;
+    newStarts.reserve(starts.size() + removed.size());
+    newEnds.reserve(ends.size() + removed.size());
+    std::size_t i = 0;
+    for (auto&& range : removed){
+        int start = range.first;
+        int end = range.second;
+        // the ranges ending at or before "start" are untouched, so copy them over in one go
+        std::size_t untouched = std::upper_bound(ends.begin() + i, ends.end(), start) - ends.begin();
+        newStarts.insert(newStarts.end(), starts.begin() + i, starts.begin() + untouched);
+        newEnds.insert(newEnds.end(), ends.begin() + i, ends.begin() + untouched);
+        i = untouched;
+        // keep the parts of the overlapping ranges that stick out of the selection
+        for (; i < starts.size() && starts[i] < end; i++){
+            if (starts[i] < start){
+                newStarts.push_back(starts[i]);
+                newEnds.push_back(start);
+            }
+            // the part after "end" may still overlap the next selection,
+            // so trim the range in place and look at it again
+            if (ends[i] > end){
+                starts[i] = end;
+                break;
+            }
+        }
+    }
+    newStarts.insert(newStarts.end(), starts.begin() + i, starts.end());
+    newEnds.insert(newEnds.end(), ends.begin() + i, ends.end());
+    starts.swap(newStarts);
+    ends.swap(newEnds);
+    sumLengths();
+}
+
+/*
+    Calls Get on every selection range in the list.
+    Returns one list of ranges per selection range, in the order given.
+
+    ranges: The list of selection ranges, in any order
+    Time Complexity: O(klogn + r), k being the number of ranges in the list
+    and r the number of ranges returned
+*/
+std::vector<std::vector<std::pair<int, int>>> FlatRange::GetBatch(const std::vector<std::pair<int, int>>& ranges) const{
+    std::vector<std::vector<std::pair<int, int>>> ret;
+    ret.reserve(ranges.size());
+    for (auto&& range : ranges){
+        ret.push_back(Get(range.first, range.second));
+    }
+    return ret;
+}
+
+/*
+    Convenience function to print the start and endpoints of the range in reverse order.
+    Returns nothing, but prints to stdout.
+    Used for Debugging.
+*/
+void FlatRange::printAll() const{
+    for (std::size_t i = starts.size(); i > 0; i--){
+        std::cout << ends[i - 1] << ", " << starts[i - 1] << ", ";
+    }
+    std::cout << std::endl;
+}
+
+/*
+    Convenience function to serialize the range into a list of start and end points.
+    Returns a list in reverse order, matching Range::toVec.
+    Used for Testcase Verification.
+*/
+std::vector<int> FlatRange::toVec() const{
+    std::vector<int> vec;
+    vec.reserve(2 * starts.size());
+    for (std::size_t i = starts.size(); i > 0; i--){
+        vec.push_back(ends[i - 1]);
+        vec.push_back(starts[i - 1]);
+    }
+    return vec;
+}
@@ -0,0 +1,290 @@
+#ifndef _FLAT_RANGE_H_
+#define _FLAT_RANGE_H_
+
+#include "Range.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/*
+    Flat alternative to Range.
+    Stores the ranges as a sorted struct-of-arrays of start and end points
+    instead of one heap node per range, so lookups binary search over
+    contiguous memory rather than chasing pointers through a tree.
+    Exposes the same interface and produces the same results as Range,
+    and is selected by using it in place of Range.
+    Lookups are cheaper than Range, but Add and Delete have to shift
+    the elements after the point of modification, and bring the running
+    totals of the lengths after it up to date.
+*/
+class FlatRange
+{
+private:
+    // the start points of the ranges, in increasing order
+    std::vector<int> starts;
+    // the end points of the ranges, where ends[i] is the end of the range
+    // starting at starts[i]
+    std::vector<int> ends;
+    // running totals of the lengths of the ranges, where coveredThrough[i] is
+    // the total length of the ranges up to and including range i, modulo 2^32 like
+    // CoveredLength, so that CoveredLength doesn't have to add up every range
+    std::vector<unsigned int> coveredThrough;
+
+    /*
+        Recomputes every running total of the lengths, after the arrays were rebuilt
+        Time Complexity: O(n)
+    */
+    void sumLengths();
+
+    /*
+        Brings the running totals up to date after ranges "first" up to "last"
+        were replaced by "count" ranges, which are already in the arrays
+        Time Complexity: O(n - first)
+    */
+    void replaceTotals(std::size_t first, std::size_t last, std::size_t count);
+
+    /*
+        Returns the number of start points less than or equal to "value"
+        Time Complexity: O(logn)
+    */
+    std::size_t countStartsAtOrBefore(int value) const;
+
+    /*
+        Returns the number of start points strictly less than "value"
+        Time Complexity: O(logn)
+    */
+    std::size_t countStartsBefore(int value) const;
+
+    /*
+        Appends a range starting at or after every range so far, merging it
+        with the last one if they overlap or touch, for the bulk constructors
+        Throws std::invalid_argument if it starts before the last one
+    */
+    void appendSorted(int, int);
+public:
+    /*
+        Instruction sets ContainsMany can search with, from slowest to fastest
+    */
+    enum class Simd { Scalar, SSE2, AVX2 };
+
+    FlatRange();
+
+    /*
+        Builds the set from a list of ranges in any order, giving the same result
+        as calling Add on each of them, but sorting and coalescing them first and
+        filling the arrays in a single pass
+
+        ranges: The list of ranges, in any order
+        Time Complexity: O(klogk), k being the number of ranges in the list
+    */
+    explicit FlatRange(std::vector<std::pair<int, int>>);
+
+    /*
+        Builds the set from ranges sorted by start point, coalescing them
+        in a single pass as they are read, like the matching Range constructor
+        Throws std::invalid_argument if the input isn't sorted
+
+        first, last: Input iterators over the ranges, as std::pair<int, int>
+        Time Complexity: O(k), k being the number of ranges
+    */
+    template <typename InputIt>
+    FlatRange(SortedRangesTag, InputIt first, InputIt last);
+
+    /*
+        Adds a range to the data structure, merging together existing
+        ranges if neccessary
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(n)
+    */
+    void Add(int, int);
+
+    /*
+        Removes ranges that exist within the data structure
+        that intersect with the selection range
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(n)
+    */
+    void Delete(int, int);
+
+    /*
+        Returns a list of ranges that exist within the data structure
+        that intersect with the selection range
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn + k), k being the number of ranges returned
+    */
+    std::vector<std::pair<int, int>> Get(int, int) const;
+
+    /*
+        Returns whether "point" is covered by a range in the data structure
+        Does not allocate
+
+        point: The point to look for
+        Time Complexity: O(logn)
+    */
+    bool Contains(int) const;
+
+    /*
+        Returns the number of points in the selection range covered by
+        the data structure, i.e. the total length of the ranges Get would return
+        Does not allocate
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn)
+    */
+    unsigned int CoveredLength(int, int) const;
+
+    /*
+        Returns the number of ranges intersecting the selection range,
+        i.e. the number of ranges Get would return
+        Does not allocate
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn)
+    */
+    std::size_t CountIntervals(int, int) const;
+
+    /*
+        Returns the first point at or after "point" that isn't covered
+
+        point: The point to start looking from
+        Time Complexity: O(logn)
+    */
+    int NextGap(int) const;
+
+    /*
+        Returns the first point at or after "point" that is covered,
+        or nothing if there are no ranges from there on
+
+        point: The point to start looking from
+        Time Complexity: O(logn)
+    */
+    std::optional<int> FirstCovered(int) const;
+
+    /*
+        Looks up many points at once, setting bit i % 64 of bits[i / 64]
+        if points[i] is covered and clearing it otherwise.
+        Runs the binary searches of 64 points in lockstep, 8 to a register
+        with AVX2 or 4 with SSE2, so that their loads overlap rather than
+        each waiting on the last, falling back to one point at a time
+        on processors without either.
+        Does not allocate
+
+        points: The points to look for, in any order
+        count: The number of points
+        bits: Bitmap of (count + 63) / 64 words to write the results to
+        Time Complexity: O(klogn), k being the number of points
+    */
+    void ContainsMany(const int*, std::size_t, std::uint64_t*) const;
+
+    /*
+        ContainsMany, using "simd" rather than the fastest instruction set available,
+        or the fastest one available if the processor doesn't support "simd"
+        Used to compare the instruction sets against each other
+    */
+    void ContainsMany(const int*, std::size_t, std::uint64_t*, Simd) const;
+
+    /*
+        Returns the fastest instruction set this processor supports,
+        which ContainsMany uses by default
+    */
+    static Simd BestSimd();
+
+    /*
+        Adds every range in the list to the data structure.
+        Gives the same result as calling Add on each of them one at a time,
+        but sorts and coalesces them first, then merges them with the
+        existing ranges in a single pass instead of shifting the arrays
+        once per range.
+
+        ranges: The list of selection ranges, in any order
+        Time Complexity: O(klogk + n), k being the number of ranges in the list
+    */
+    void AddBatch(const std::vector<std::pair<int, int>>&);
+
+    /*
+        Removes every range in the list from the data structure.
+        Gives the same result as calling Delete on each of them one at a time,
+        in a single pass like AddBatch.
+
+        ranges: The list of selection ranges, in any order
+        Time Complexity: O(klogk + n), k being the number of ranges in the list
+    */
+    void DeleteBatch(const std::vector<std::pair<int, int>>&);
+
+    /*
+        Calls Get on every selection range in the list.
+        Returns one list of ranges per selection range, in the order given.
+
+        ranges: The list of selection ranges, in any order
+        Time Complexity: O(klogn + r), k being the number of ranges in the list
+        and r the number of ranges returned
+    */
+    std::vector<std::vector<std::pair<int, int>>> GetBatch(const std::vector<std::pair<int, int>>&) const;
+
+    /*
+        Exchanges the ranges of the two sets without copying them
+        Moving a FlatRange likewise only hands over its arrays
+        Time Complexity: O(1)
+    */
+    void swap(FlatRange&) noexcept;
+    friend void swap(FlatRange& first, FlatRange& second) noexcept { first.swap(second); }
+
+    /*
+        Returns a copy of the set, with arrays no larger than its ranges need
+        Time Complexity: O(n)
+    */
+    FlatRange Clone() const;
+
+    /*
+        Makes room for "count" ranges, so that Add and AddBatch don't reallocate
+        the arrays until the set holds more than that
+        Time Complexity: O(n) if the arrays grow, O(1) otherwise
+    */
+    void Reserve(std::size_t);
+
+    /*
+        Returns the number of ranges the set can hold before the arrays reallocate
+        Time Complexity: O(1)
+    */
+    std::size_t Capacity() const;
+
+    /*
+        Gives back the memory the arrays hold beyond what the ranges need,
+        such as after deleting most of them
+        Time Complexity: O(n)
+    */
+    void ShrinkToFit();
+
+    /*
+        Convenience function to print the start and endpoints of the range in reverse order.
+        Returns nothing, but prints to stdout.
+        Used for Debugging.
+    */
+    void printAll() const;
+
+    /*
+        Convenience function to serialize the range into a list of start and end points.
+        Returns a list in reverse order, matching Range::toVec.
+        Used for Testcase Verification.
+    */
+    std::vector<int> toVec() const;
+};
+
+template <typename InputIt>
+FlatRange::FlatRange(SortedRangesTag, InputIt first, InputIt last){
+    for (; first != last; ++first){
+        std::pair<int, int> range = *first;
+        appendSorted(range.first, range.second);
+    }
+    sumLengths();
+}
+#endif
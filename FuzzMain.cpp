@@ -0,0 +1,61 @@
+#include "DifferentialFuzz.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size);
+
+/*
+    Command line driver for the differential fuzzer, for when libFuzzer isn't available.
+    Build with "make fuzz", or "make sanitize" for range_fuzz_asan.
+
+    ./range_fuzz [traces] [seed] runs that many random traces (1000 and 1 by default)
+    against every backend, each one as it is and then moved against the lowest
+    or, every other trace, the highest int, and prints the shrunk trace of the
+    first mismatch.
+    The durable and snapshot backends write files to the temporary directory and
+    sync them, so pointing TMPDIR at a directory in memory, such as /dev/shm,
+    makes runs several times faster.
+    ./range_fuzz file... replays each file through the libFuzzer entry point,
+    e.g. to reproduce a crash libFuzzer found.
+*/
+int main(int argc, char** argv){
+    if (argc > 1 && std::strspn(argv[1], "0123456789") != std::strlen(argv[1])){
+        for (int i = 1; i < argc; i++){
+            std::ifstream file(argv[i], std::ios::binary);
+            if (!file){
+                std::fprintf(stderr, "can't read %s\n", argv[i]);
+                return 2;
+            }
+            std::vector<std::uint8_t> input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+            std::printf("%s: ok\n", argv[i]);
+        }
+        return 0;
+    }
+    std::size_t traces = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000;
+    unsigned seed = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 1;
+    std::mt19937 gen(seed);
+    std::size_t operations = 0;
+    for (std::size_t i = 0; i < traces; i++){
+        FuzzTrace trace = randomTrace(gen, 1 + gen() % 400);
+        operations += trace.size();
+        FuzzPlacement limit = i % 2 == 0 ? FuzzPlacement::Lowest : FuzzPlacement::Highest;
+        for (FuzzPlacement placement : {FuzzPlacement::Middle, limit}){
+            if (std::optional<FuzzFailure> failure = runDifferential(trace, placement)){
+                FuzzTrace shrunk = shrinkFailure(trace, *failure);
+                printFailure(std::cout, shrunk, runDifferential(shrunk, placement).value_or(*failure));
+                std::printf("(trace %zu of seed %u, shrunk from %zu operations)\n", i, seed, trace.size());
+                return 1;
+            }
+        }
+    }
+    std::printf("%zu traces, %zu operations, no mismatches\n", traces, operations);
+    return 0;
+}
@@ -0,0 +1,685 @@
+#include "HybridRange.h"
+#include <algorithm>
+#include <climits>
+#include <iterator>
+#include <iostream>
+
+// the vectorized bit counts rely on GCC's per function target attributes and
+// runtime processor detection, everything else uses the scalar one
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HYBRID_RANGE_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+    /*
+        Keys order the points as unsigned numbers, with INT_MIN at 0, so that
+        the high 16 bits of a key pick its chunk and the low 16 bits its point in it
+    */
+    std::uint32_t toKey(int point){
+        return static_cast<std::uint32_t>(point) ^ 0x80000000u;
+    }
+
+    int fromKey(std::uint32_t key){
+        return static_cast<int>(key ^ 0x80000000u);
+    }
+
+    /*
+        Returns the mask of bits "first" to "last" of a word, inclusive
+    */
+    std::uint64_t wordMask(unsigned int first, unsigned int last){
+        return (~0ULL >> (63 - last)) & (~0ULL << first);
+    }
+
+    /*
+        Sets or clears the points from "first" to "last" of a bitmap, inclusive
+    */
+    void setBits(std::uint64_t* words, std::uint32_t first, std::uint32_t last, bool value){
+        for (std::uint32_t w = first / 64; w <= last / 64; w++){
+            std::uint64_t mask = wordMask(w == first / 64 ? first % 64 : 0, w == last / 64 ? last % 64 : 63);
+            words[w] = value ? words[w] | mask : words[w] & ~mask;
+        }
+    }
+
+    /*
+        Returns the number of runs of a bitmap starting from "first" to "last", inclusive,
+        a run starting at every set bit whose lower neighbour is clear
+    */
+    std::uint32_t countStarts(const std::uint64_t* words, std::uint32_t first, std::uint32_t last){
+        std::uint32_t count = 0;
+        for (std::uint32_t w = first / 64; w <= last / 64; w++){
+            std::uint64_t below = (words[w] << 1) | (w > 0 ? words[w - 1] >> 63 : 0);
+            std::uint64_t starts = words[w] & ~below;
+            count += __builtin_popcountll(starts & wordMask(w == first / 64 ? first % 64 : 0, w == last / 64 ? last % 64 : 63));
+        }
+        return count;
+    }
+
+    /*
+        Returns the first point at or after "point" of a bitmap that is set,
+        or clear if "clear" is true, or 65536 if there is none
+    */
+    std::uint32_t nextBit(const std::uint64_t* words, std::uint32_t point, bool clear){
+        const std::uint64_t flip = clear ? ~0ULL : 0;
+        std::size_t w = point / 64;
+        std::uint64_t word = (words[w] ^ flip) & (~0ULL << (point % 64));
+        while (word == 0){
+            if (++w == HybridRange::BitmapWords){
+                return 65536;
+            }
+            word = words[w] ^ flip;
+        }
+        return w * 64 + __builtin_ctzll(word);
+    }
+
+    /*
+        Returns the number of set bits in "count" words, one word at a time
+        Built without any target flags, so the compiler can't use the popcount instruction
+    */
+    std::size_t countBitsScalar(const std::uint64_t* words, std::size_t count){
+        std::size_t bits = 0;
+        for (std::size_t i = 0; i < count; i++){
+            bits += __builtin_popcountll(words[i]);
+        }
+        return bits;
+    }
+
+#ifdef HYBRID_RANGE_X86
+    /*
+        countBitsScalar, with the popcount instruction
+    */
+    __attribute__((target("popcnt")))
+    std::size_t countBitsPopcnt(const std::uint64_t* words, std::size_t count){
+        std::size_t bits = 0;
+        for (std::size_t i = 0; i < count; i++){
+            bits += __builtin_popcountll(words[i]);
+        }
+        return bits;
+    }
+
+    /*
+        countBitsScalar, 4 words at a time
+        Looks up the number of bits in each nibble of the register with a byte
+        shuffle, then adds up the bytes of each word with a sum of absolute
+        differences, which is faster than 4 popcount instructions in a row
+    */
+    __attribute__((target("avx2")))
+    std::size_t countBitsAvx2(const std::uint64_t* words, std::size_t count){
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        __m256i total = _mm256_setzero_si256();
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4){
+            __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+            __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(value, nibble));
+            __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(value, 4), nibble));
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+        }
+        alignas(32) std::uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+        std::size_t bits = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        for (; i < count; i++){
+            bits += __builtin_popcountll(words[i]);
+        }
+        return bits;
+    }
+#endif
+
+    /*
+        Returns the number of points from "first" to "last" of a bitmap that are set,
+        counting the whole words between the two ends with "count"
+    */
+    std::size_t countRange(const std::uint64_t* words, std::uint32_t first, std::uint32_t last,
+                           std::size_t (*count)(const std::uint64_t*, std::size_t)){
+        std::uint32_t a = first / 64, b = last / 64;
+        if (a == b){
+            return __builtin_popcountll(words[a] & wordMask(first % 64, last % 64));
+        }
+        return __builtin_popcountll(words[a] & wordMask(first % 64, 63))
+            + count(words + a + 1, b - a - 1)
+            + __builtin_popcountll(words[b] & wordMask(0, last % 64));
+    }
+}
+
+HybridRange::HybridRange(){
+}
+
+/*
+    Returns the index of the first chunk whose key is at least "key"
+    Time Complexity: O(logc)
+*/
+std::size_t HybridRange::findChunk(std::uint32_t key) const{
+    return std::partition_point(chunks.begin(), chunks.end(), [&](const Chunk& chunk){
+        return chunk.key < key;
+    }) - chunks.begin();
+}
+
+/*
+    Adds the points from "first" to "last" of a chunk, inclusive
+    A list of runs merges the new run with every run it overlaps or touches,
+    like FlatRange::Add. A bitmap sets the bits, counting the runs that start
+    around them before and after, since those are the only ones that can change.
+*/
+void HybridRange::addTo(Chunk& chunk, std::uint16_t first, std::uint16_t last){
+    if (chunk.dense()){
+        std::uint32_t window = std::min<std::uint32_t>(last + 1, 65535);
+        std::uint32_t before = countStarts(chunk.bits.data(), first, window);
+        setBits(chunk.bits.data(), first, last, true);
+        chunk.runCount = chunk.runCount - before + countStarts(chunk.bits.data(), first, window);
+    } else {
+        std::vector<Run>& runs = chunk.runs;
+        auto from = std::partition_point(runs.begin(), runs.end(), [&](const Run& run){
+            return run.last + 1 < first;
+        });
+        auto to = std::partition_point(from, runs.end(), [&](const Run& run){
+            return run.start <= last + 1;
+        });
+        if (from == to){
+            runs.insert(from, Run{first, last});
+        } else {
+            from->start = std::min(from->start, first);
+            from->last = std::max((to - 1)->last, last);
+            runs.erase(from + 1, to);
+        }
+        chunk.runCount = runs.size();
+    }
+    rebalance(chunk);
+}
+
+/*
+    Removes the points from "first" to "last" of a chunk, inclusive
+    A list of runs keeps whatever sticks out of the first and last runs
+    the removal overlaps, like FlatRange::Delete. A bitmap clears the bits,
+    counting the runs around them like addTo.
+*/
+void HybridRange::removeFrom(Chunk& chunk, std::uint16_t first, std::uint16_t last){
+    if (chunk.dense()){
+        std::uint32_t window = std::min<std::uint32_t>(last + 1, 65535);
+        std::uint32_t before = countStarts(chunk.bits.data(), first, window);
+        setBits(chunk.bits.data(), first, last, false);
+        chunk.runCount = chunk.runCount - before + countStarts(chunk.bits.data(), first, window);
+    } else {
+        std::vector<Run>& runs = chunk.runs;
+        auto from = std::partition_point(runs.begin(), runs.end(), [&](const Run& run){
+            return run.last < first;
+        });
+        auto to = std::partition_point(from, runs.end(), [&](const Run& run){
+            return run.start <= last;
+        });
+        if (from == to){
+            return;
+        }
+        Run pieces[2];
+        std::size_t count = 0;
+        if (from->start < first){
+            pieces[count++] = Run{from->start, static_cast<std::uint16_t>(first - 1)};
+        }
+        if ((to - 1)->last > last){
+            pieces[count++] = Run{static_cast<std::uint16_t>(last + 1), (to - 1)->last};
+        }
+        if (count > static_cast<std::size_t>(to - from)){
+            // cutting a hole in a single run leaves one more run than before
+            *from = pieces[0];
+            runs.insert(from + 1, pieces[1]);
+        } else {
+            std::copy(pieces, pieces + count, from);
+            runs.erase(from + count, to);
+        }
+        chunk.runCount = runs.size();
+    }
+    rebalance(chunk);
+}
+
+/*
+    Switches a chunk to whichever container suits its number of runs
+    Past DenseRuns runs the list takes up more memory than the bitmap, and the
+    bitmap only goes back to a list once it is down to SparseRuns, half that,
+    so that a chunk going back and forth around the threshold doesn't have to
+    convert every time.
+*/
+void HybridRange::rebalance(Chunk& chunk){
+    if (!chunk.dense() && chunk.runCount > DenseRuns){
+        chunk.bits.assign(BitmapWords, 0);
+        for (const Run& run : chunk.runs){
+            setBits(chunk.bits.data(), run.start, run.last, true);
+        }
+        std::vector<Run>().swap(chunk.runs);
+    } else if (chunk.dense() && chunk.runCount <= SparseRuns){
+        std::vector<Run> runs;
+        runs.reserve(chunk.runCount);
+        visitRuns(chunk, 0, 65535, [&](std::uint16_t first, std::uint16_t last){
+            runs.push_back(Run{first, last});
+        });
+        std::vector<std::uint64_t>().swap(chunk.bits);
+        chunk.runs.swap(runs);
+    }
+}
+
+/*
+    Calls visit(first, last) on every run of a chunk, clipped to the
+    points from "first" to "last", in increasing order
+    Finds the runs of a bitmap by skipping from set bit to clear bit and
+    back, a word at a time
+*/
+template <typename Visitor>
+void HybridRange::visitRuns(const Chunk& chunk, std::uint16_t first, std::uint16_t last, Visitor&& visit){
+    if (chunk.dense()){
+        for (std::uint32_t point = first; point <= last; ){
+            std::uint32_t start = nextBit(chunk.bits.data(), point, false);
+            if (start > last){
+                return;
+            }
+            std::uint32_t end = nextBit(chunk.bits.data(), start, true);
+            visit(static_cast<std::uint16_t>(start), static_cast<std::uint16_t>(std::min<std::uint32_t>(end - 1, last)));
+            point = end;
+        }
+        return;
+    }
+    auto run = std::partition_point(chunk.runs.begin(), chunk.runs.end(), [&](const Run& run){
+        return run.last < first;
+    });
+    for (; run != chunk.runs.end() && run->start <= last; run++){
+        visit(std::max(run->start, first), std::min(run->last, last));
+    }
+}
+
+/*
+    Calls visit(start, end) on every range intersecting the selection range,
+    clipped to it, in increasing order
+    A range crossing a chunk boundary is stored as a run ending at the end of
+    one chunk and a run starting at the beginning of the next, so a run is held
+    back until the next one is known not to carry on from it.
+*/
+template <typename Visitor>
+void HybridRange::visitRanges(int start, int end, Visitor&& visit) const{
+    if (start >= end){
+        return;
+    }
+    std::uint32_t from = toKey(start);
+    std::uint32_t to = toKey(end) - 1;
+    bool pending = false;
+    std::uint64_t pendingStart = 0;
+    std::uint64_t pendingEnd = 0;
+    for (std::size_t i = findChunk(from >> 16); i < chunks.size() && chunks[i].key <= to >> 16; i++){
+        const Chunk& chunk = chunks[i];
+        std::uint64_t base = static_cast<std::uint64_t>(chunk.key) << 16;
+        std::uint16_t first = chunk.key == from >> 16 ? from & 0xFFFF : 0;
+        std::uint16_t last = chunk.key == to >> 16 ? to & 0xFFFF : 0xFFFF;
+        visitRuns(chunk, first, last, [&](std::uint16_t runStart, std::uint16_t runLast){
+            if (pending && pendingEnd == base + runStart){
+                pendingEnd = base + runLast + 1;
+                return;
+            }
+            if (pending){
+                visit(fromKey(pendingStart), fromKey(pendingEnd));
+            }
+            pending = true;
+            pendingStart = base + runStart;
+            pendingEnd = base + runLast + 1;
+        });
+    }
+    // INT_MAX can never be covered, so the end of a range always fits in a key
+    if (pending){
+        visit(fromKey(pendingStart), fromKey(pendingEnd));
+    }
+}
+
+/*
+    Adds a range to the data structure, merging together existing
+    ranges if neccessary
+    A range within a single chunk only touches that chunk, creating it if
+    needed. A range across several chunks rebuilds the list of chunks in one
+    pass, creating the missing chunks in between, and turns every chunk it
+    covers whole into a single run.
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logc + r) within a single chunk, O(c + r) across several
+*/
+void HybridRange::Add(int start, int end){
+    if (start >= end){
+        return;
+    }
+    std::uint32_t from = toKey(start);
+    std::uint32_t to = toKey(end) - 1;
+    std::uint32_t firstKey = from >> 16;
+    std::uint32_t lastKey = to >> 16;
+    std::size_t first = findChunk(firstKey);
+    if (firstKey == lastKey){
+        if (first == chunks.size() || chunks[first].key != firstKey){
+            chunks.insert(chunks.begin() + first, Chunk(firstKey));
+        }
+        addTo(chunks[first], from & 0xFFFF, to & 0xFFFF);
+        return;
+    }
+    std::size_t last = findChunk(lastKey + 1);
+    std::vector<Chunk> merged;
+    merged.reserve(first + (lastKey - firstKey + 1) + (chunks.size() - last));
+    std::move(chunks.begin(), chunks.begin() + first, std::back_inserter(merged));
+    std::size_t next = first;
+    for (std::uint32_t key = firstKey; key <= lastKey; key++){
+        Chunk chunk = next < last && chunks[next].key == key ? std::move(chunks[next++]) : Chunk(key);
+        std::uint16_t low = key == firstKey ? from & 0xFFFF : 0;
+        std::uint16_t high = key == lastKey ? to & 0xFFFF : 0xFFFF;
+        if (low == 0 && high == 0xFFFF){
+            std::vector<std::uint64_t>().swap(chunk.bits);
+            chunk.runs.assign(1, Run{0, 0xFFFF});
+            chunk.runCount = 1;
+        } else {
+            addTo(chunk, low, high);
+        }
+        merged.push_back(std::move(chunk));
+    }
+    std::move(chunks.begin() + last, chunks.end(), std::back_inserter(merged));
+    chunks.swap(merged);
+}
+
+/*
+    Removes ranges that exist within the data structure
+    that intersect with the selection range
+    Empties every chunk the selection covers, cuts the chunks at either end,
+    then drops the chunks left empty.
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(c + r)
+*/
+void HybridRange::Delete(int start, int end){
+    if (start >= end){
+        return;
+    }
+    std::uint32_t from = toKey(start);
+    std::uint32_t to = toKey(end) - 1;
+    std::size_t first = findChunk(from >> 16);
+    std::size_t i = first;
+    for (; i < chunks.size() && chunks[i].key <= to >> 16; i++){
+        Chunk& chunk = chunks[i];
+        std::uint16_t low = chunk.key == from >> 16 ? from & 0xFFFF : 0;
+        std::uint16_t high = chunk.key == to >> 16 ? to & 0xFFFF : 0xFFFF;
+        if (low == 0 && high == 0xFFFF){
+            chunk.runCount = 0;
+        } else {
+            removeFrom(chunk, low, high);
+        }
+    }
+    chunks.erase(std::remove_if(chunks.begin() + first, chunks.begin() + i, [](const Chunk& chunk){
+        return chunk.runCount == 0;
+    }), chunks.begin() + i);
+}
+
+/*
+    Returns a list of ranges that exist within the data structure
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logc + k + w)
+*/
+std::vector<std::pair<int, int>> HybridRange::Get(int start, int end) const{
+    std::vector<std::pair<int, int>> ret;
+    visitRanges(start, end, [&](int rangeStart, int rangeEnd){
+        ret.emplace_back(rangeStart, rangeEnd);
+    });
+    return ret;
+}
+
+/*
+    Returns whether "point" is covered by a range in the data structure
+
+    point: The point to look for
+    Time Complexity: O(logc + logr)
+*/
+bool HybridRange::Contains(int point) const{
+    std::uint32_t key = toKey(point);
+    std::size_t i = findChunk(key >> 16);
+    if (i == chunks.size() || chunks[i].key != key >> 16){
+        return false;
+    }
+    const Chunk& chunk = chunks[i];
+    std::uint32_t low = key & 0xFFFF;
+    if (chunk.dense()){
+        return (chunk.bits[low / 64] >> (low % 64)) & 1;
+    }
+    auto run = std::partition_point(chunk.runs.begin(), chunk.runs.end(), [&](const Run& run){
+        return run.last < low;
+    });
+    return run != chunk.runs.end() && run->start <= low;
+}
+
+/*
+    Returns the number of points in the selection range covered by
+    the data structure, i.e. the total length of the ranges Get would return
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logc + k + w)
+*/
+unsigned int HybridRange::CoveredLength(int start, int end) const{
+    return CoveredLength(start, end, BestSimd());
+}
+
+/*
+    CoveredLength, using "simd" if the processor supports it
+    Adds up the lengths of the runs of list chunks, and counts the bits of
+    bitmap chunks, only masking the words at either end of the selection
+*/
+unsigned int HybridRange::CoveredLength(int start, int end, Simd simd) const{
+    if (start >= end){
+        return 0;
+    }
+    std::size_t (*count)(const std::uint64_t*, std::size_t) = countBitsScalar;
+#ifdef HYBRID_RANGE_X86
+    switch (std::min(simd, BestSimd())){
+    case Simd::AVX2:
+        count = countBitsAvx2;
+        break;
+    case Simd::Popcnt:
+        count = countBitsPopcnt;
+        break;
+    case Simd::Scalar:
+        break;
+    }
+#else
+    (void)simd;
+#endif
+    std::uint32_t from = toKey(start);
+    std::uint32_t to = toKey(end) - 1;
+    unsigned int length = 0;
+    for (std::size_t i = findChunk(from >> 16); i < chunks.size() && chunks[i].key <= to >> 16; i++){
+        const Chunk& chunk = chunks[i];
+        std::uint16_t first = chunk.key == from >> 16 ? from & 0xFFFF : 0;
+        std::uint16_t last = chunk.key == to >> 16 ? to & 0xFFFF : 0xFFFF;
+        if (chunk.dense()){
+            length += countRange(chunk.bits.data(), first, last, count);
+        } else {
+            visitRuns(chunk, first, last, [&](std::uint16_t runStart, std::uint16_t runLast){
+                length += runLast - runStart + 1;
+            });
+        }
+    }
+    return length;
+}
+
+/*
+    Returns the fastest instruction set this processor supports
+    Checked once, the first time it is called
+*/
+HybridRange::Simd HybridRange::BestSimd(){
+#ifdef HYBRID_RANGE_X86
+    static const Simd best = __builtin_cpu_supports("avx2") ? Simd::AVX2
+        : __builtin_cpu_supports("popcnt") ? Simd::Popcnt : Simd::Scalar;
+    return best;
+#else
+    return Simd::Scalar;
+#endif
+}
+
+/*
+    Returns the number of ranges intersecting the selection range,
+    i.e. the number of ranges Get would return
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logc + k + w)
+*/
+std::size_t HybridRange::CountIntervals(int start, int end) const{
+    std::size_t count = 0;
+    visitRanges(start, end, [&](int, int){
+        count++;
+    });
+    return count;
+}
+
+/*
+    Returns the first point at or after "point" that isn't covered
+    Moves on to the next chunk as long as the chunk it's in is covered to its end
+
+    point: The point to start looking from
+    Time Complexity: O(logc + f)
+*/
+int HybridRange::NextGap(int point) const{
+    std::uint32_t key = toKey(point);
+    for (std::size_t i = findChunk(key >> 16); i < chunks.size() && chunks[i].key == key >> 16; i++){
+        const Chunk& chunk = chunks[i];
+        std::uint32_t low = key & 0xFFFF;
+        std::uint32_t gap = low;
+        if (chunk.dense()){
+            gap = nextBit(chunk.bits.data(), low, true);
+        } else {
+            auto run = std::partition_point(chunk.runs.begin(), chunk.runs.end(), [&](const Run& run){
+                return run.last < low;
+            });
+            if (run != chunk.runs.end() && run->start <= low){
+                gap = run->last + 1;
+            }
+        }
+        if (gap < 65536){
+            return fromKey((key & 0xFFFF0000u) | gap);
+        }
+        // INT_MAX is never covered, so the last chunk can't be covered to its end
+        key = (key & 0xFFFF0000u) + 0x10000;
+    }
+    return fromKey(key);
+}
+
+/*
+    Returns the first point at or after "point" that is covered,
+    or nothing if there are no ranges from there on
+    Chunks are never empty, so if the chunk "point" is in has nothing
+    from there on, the answer is the first point of the next one
+
+    point: The point to start looking from
+    Time Complexity: O(logc + w)
+*/
+std::optional<int> HybridRange::FirstCovered(int point) const{
+    std::uint32_t key = toKey(point);
+    std::size_t i = findChunk(key >> 16);
+    if (i < chunks.size() && chunks[i].key == key >> 16){
+        const Chunk& chunk = chunks[i];
+        std::uint32_t low = key & 0xFFFF;
+        std::uint32_t found = 65536;
+        if (chunk.dense()){
+            found = nextBit(chunk.bits.data(), low, false);
+        } else {
+            auto run = std::partition_point(chunk.runs.begin(), chunk.runs.end(), [&](const Run& run){
+                return run.last < low;
+            });
+            if (run != chunk.runs.end()){
+                found = std::max<std::uint32_t>(run->start, low);
+            }
+        }
+        if (found < 65536){
+            return fromKey((key & 0xFFFF0000u) | found);
+        }
+        i++;
+    }
+    if (i == chunks.size()){
+        return std::nullopt;
+    }
+    const Chunk& chunk = chunks[i];
+    std::uint32_t first = chunk.dense() ? nextBit(chunk.bits.data(), 0, false) : chunk.runs.front().start;
+    return fromKey((static_cast<std::uint32_t>(chunk.key) << 16) | first);
+}
+
+/*
+    Returns the number of chunks stored as bitmaps
+    Time Complexity: O(c)
+*/
+std::size_t HybridRange::DenseChunks() const{
+    return std::count_if(chunks.begin(), chunks.end(), [](const Chunk& chunk){
+        return chunk.dense();
+    });
+}
+
+/*
+    Returns the number of bytes the chunks and their containers take up
+    Time Complexity: O(c)
+*/
+std::size_t HybridRange::MemoryUsage() const{
+    std::size_t bytes = chunks.capacity() * sizeof(Chunk);
+    for (const Chunk& chunk : chunks){
+        bytes += chunk.runs.capacity() * sizeof(Run) + chunk.bits.capacity() * sizeof(std::uint64_t);
+    }
+    return bytes;
+}
+
+/*
+    Exchanges the chunks of the two sets without copying them
+
+    other: The set to exchange with
+    Time Complexity: O(1)
+*/
+void HybridRange::swap(HybridRange& other) noexcept{
+    chunks.swap(other.chunks);
+}
+
+/*
+    Returns a copy of the set
+    Copying a vector only allocates as much as its elements need
+
+    Time Complexity: O(c + r + b)
+*/
+HybridRange HybridRange::Clone() const{
+    return HybridRange(*this);
+}
+
+/*
+    Gives back the memory the list of chunks and the lists of runs hold beyond what they need
+    Bitmaps are always allocated at their exact size
+    Time Complexity: O(c + r)
+*/
+void HybridRange::ShrinkToFit(){
+    chunks.shrink_to_fit();
+    for (Chunk& chunk : chunks){
+        chunk.runs.shrink_to_fit();
+    }
+}
+
+/*
+    Convenience function to print the start and endpoints of the range in reverse order.
+    Returns nothing, but prints to stdout.
+    Used for Debugging.
+*/
+void HybridRange::printAll() const{
+    std::vector<int> vec = toVec();
+    for (std::size_t i = 0; i < vec.size(); i += 2){
+        std::cout << vec[i] << ", " << vec[i + 1] << ", ";
+    }
+    std::cout << std::endl;
+}
+
+/*
+    Convenience function to serialize the range into a list of start and end points.
+    Returns a list in reverse order, matching Range::toVec.
+    Used for Testcase Verification.
+*/
+std::vector<int> HybridRange::toVec() const{
+    std::vector<int> vec;
+    visitRanges(INT_MIN, INT_MAX, [&](int start, int end){
+        vec.push_back(start);
+        vec.push_back(end);
+    });
+    std::reverse(vec.begin(), vec.end());
+    return vec;
+}
@@ -0,0 +1,263 @@
+#ifndef _HYBRID_RANGE_H_
+#define _HYBRID_RANGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/*
+    Chunked alternative to Range for heavily fragmented sets, in the style of a
+    roaring bitmap.
+    Splits the key space into chunks of 65536 points, by the high 16 bits of
+    the key, and stores each chunk that has any points in it as whichever of
+    two containers is smaller:
+    - a sorted list of runs, 4 bytes each, while the chunk has at most DenseRuns
+      runs, which is the cheaper form for long or few ranges
+    - a bitmap of all 65536 points, a fixed 8 KiB, once it has more runs than that,
+      which is the cheaper form once ranges are short and close together
+    A chunk switches to a bitmap once Add takes it past DenseRuns runs and back
+    to a list of runs once Delete or Add brings it down to SparseRuns, so that
+    a chunk hovering around the threshold doesn't switch back and forth.
+    Ranges that cross chunk boundaries are stored cut up at them and joined
+    back together by Get.
+
+    Exposes the same interface and produces the same results as Range,
+    and is selected by using it in place of Range.
+    Coverage queries count the bits of bitmap chunks with the popcount
+    instruction, or 4 words at a time with AVX2 where the processor has it.
+*/
+class HybridRange
+{
+private:
+    // a run of the points from "start" to "last" of a chunk, inclusive, so that
+    // a run can reach the end of its chunk
+    struct Run
+    {
+        std::uint16_t start;
+        std::uint16_t last;
+    };
+
+    struct Chunk
+    {
+        // the high 16 bits of every key in the chunk
+        std::uint16_t key;
+        // the number of runs in the chunk, whichever container it is stored in
+        std::uint32_t runCount;
+        // the runs of the chunk in increasing order, never touching, while it is a list of runs
+        std::vector<Run> runs;
+        // BitmapWords words, bit i % 64 of word i / 64 being point i, while it is a bitmap
+        std::vector<std::uint64_t> bits;
+
+        explicit Chunk(std::uint16_t key) : key(key), runCount(0) {}
+        bool dense() const { return !bits.empty(); }
+    };
+
+    // the chunks that have any points in them, in increasing order of key
+    std::vector<Chunk> chunks;
+
+    /*
+        Returns the index of the first chunk whose key is at least "key"
+        Time Complexity: O(logc), c being the number of chunks
+    */
+    std::size_t findChunk(std::uint32_t key) const;
+
+    /*
+        Adds the points from "first" to "last" of a chunk, inclusive
+        Time Complexity: O(r) for a list of r runs, O(w) for a bitmap, w being the number of words covered
+    */
+    static void addTo(Chunk&, std::uint16_t first, std::uint16_t last);
+
+    /*
+        Removes the points from "first" to "last" of a chunk, inclusive
+        Time Complexity: O(r) for a list of r runs, O(w) for a bitmap, w being the number of words covered
+    */
+    static void removeFrom(Chunk&, std::uint16_t first, std::uint16_t last);
+
+    /*
+        Switches a chunk to whichever container suits its number of runs
+        Time Complexity: O(r) if it stays as it is, O(65536 / 64 + r) if it switches
+    */
+    static void rebalance(Chunk&);
+
+    /*
+        Calls visit(first, last) on every run of a chunk, clipped to the
+        points from "first" to "last", in increasing order
+    */
+    template <typename Visitor>
+    static void visitRuns(const Chunk&, std::uint16_t first, std::uint16_t last, Visitor&& visit);
+
+    /*
+        Calls visit(start, end) on every range intersecting the selection range,
+        clipped to it, in increasing order, joining runs across chunk boundaries
+    */
+    template <typename Visitor>
+    void visitRanges(int start, int end, Visitor&& visit) const;
+public:
+    /*
+        Instruction sets CoveredLength can count bits with, from slowest to fastest
+    */
+    enum class Simd { Scalar, Popcnt, AVX2 };
+
+    // number of runs past which a chunk switches to a bitmap, at which the list
+    // of runs takes up as much memory as the bitmap
+    static constexpr std::uint32_t DenseRuns = 2048;
+    // number of runs at which a bitmap switches back to a list of runs
+    static constexpr std::uint32_t SparseRuns = 1024;
+    // number of 64 bit words in the bitmap of a chunk
+    static constexpr std::size_t BitmapWords = 65536 / 64;
+
+    HybridRange();
+
+    /*
+        Adds a range to the data structure, merging together existing
+        ranges if neccessary
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logc + r) within a single chunk, r being the number of runs
+        in it, or O(c + r) across several, c being the number of chunks
+    */
+    void Add(int, int);
+
+    /*
+        Removes ranges that exist within the data structure
+        that intersect with the selection range
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(c + r), c being the number of chunks and r the number of runs
+        in the chunks at either end of the selection
+    */
+    void Delete(int, int);
+
+    /*
+        Returns a list of ranges that exist within the data structure
+        that intersect with the selection range
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logc + k + w), k being the number of ranges returned
+        and w the number of bitmap words in the selection
+    */
+    std::vector<std::pair<int, int>> Get(int, int) const;
+
+    /*
+        Returns whether "point" is covered by a range in the data structure
+        Does not allocate
+
+        point: The point to look for
+        Time Complexity: O(logc + logr)
+    */
+    bool Contains(int) const;
+
+    /*
+        Returns the number of points in the selection range covered by
+        the data structure, i.e. the total length of the ranges Get would return
+        Counts the bits of bitmap chunks with the fastest instruction set available
+        Does not allocate
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logc + k + w), k being the number of runs in
+        list chunks and w the number of bitmap words in the selection
+    */
+    unsigned int CoveredLength(int, int) const;
+
+    /*
+        CoveredLength, using "simd" rather than the fastest instruction set available,
+        or the fastest one available if the processor doesn't support "simd"
+        Used to compare the instruction sets against each other
+    */
+    unsigned int CoveredLength(int, int, Simd) const;
+
+    /*
+        Returns the fastest instruction set this processor supports,
+        which CoveredLength uses by default
+    */
+    static Simd BestSimd();
+
+    /*
+        Returns the number of ranges intersecting the selection range,
+        i.e. the number of ranges Get would return
+        Does not allocate
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logc + k + w), k being the number of ranges counted
+        and w the number of bitmap words in the selection
+    */
+    std::size_t CountIntervals(int, int) const;
+
+    /*
+        Returns the first point at or after "point" that isn't covered
+
+        point: The point to start looking from
+        Time Complexity: O(logc + f), f being the number of full chunks skipped over
+    */
+    int NextGap(int) const;
+
+    /*
+        Returns the first point at or after "point" that is covered,
+        or nothing if there are no ranges from there on
+
+        point: The point to start looking from
+        Time Complexity: O(logc + w), w being the number of bitmap words searched
+    */
+    std::optional<int> FirstCovered(int) const;
+
+    /*
+        Returns the number of chunks with any points in them
+        Time Complexity: O(1)
+    */
+    std::size_t Chunks() const { return chunks.size(); }
+
+    /*
+        Returns the number of chunks stored as bitmaps
+        Time Complexity: O(c)
+    */
+    std::size_t DenseChunks() const;
+
+    /*
+        Returns the number of bytes the chunks and their containers take up
+        Time Complexity: O(c)
+    */
+    std::size_t MemoryUsage() const;
+
+    /*
+        Exchanges the chunks of the two sets without copying them
+        Moving a HybridRange likewise only hands over its list of chunks
+        Time Complexity: O(1)
+    */
+    void swap(HybridRange&) noexcept;
+    friend void swap(HybridRange& first, HybridRange& second) noexcept { first.swap(second); }
+
+    /*
+        Returns a copy of the set, with lists no larger than its chunks need
+        Time Complexity: O(c + r + b), b being the number of bitmap words
+    */
+    HybridRange Clone() const;
+
+    /*
+        Gives back the memory the list of chunks and the lists of runs hold beyond
+        what they need, such as after deleting most of the ranges
+        Time Complexity: O(c + r)
+    */
+    void ShrinkToFit();
+
+    /*
+        Convenience function to print the start and endpoints of the range in reverse order.
+        Returns nothing, but prints to stdout.
+        Used for Debugging.
+    */
+    void printAll() const;
+
+    /*
+        Convenience function to serialize the range into a list of start and end points.
+        Returns a list in reverse order, matching Range::toVec.
+        Used for Testcase Verification.
+    */
+    std::vector<int> toVec() const;
+};
+#endif
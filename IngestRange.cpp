@@ -0,0 +1,193 @@
+#include "IngestRange.h"
+#include <algorithm>
+
+/*
+    Starts the background thread
+*/
+IngestRange::IngestRange(IngestOptions options)
+    : options(options), submitted(0), done(0), flushing(0), stopping(false) {
+    this->options.capacity = std::max<std::size_t>(this->options.capacity, 1);
+    // a batch can never grow past the capacity of the buffer
+    this->options.batchSize = std::min(std::max<std::size_t>(this->options.batchSize, 1), this->options.capacity);
+    worker = std::thread(&IngestRange::run, this);
+}
+
+/*
+    Applies every buffered modification, then stops the background thread
+*/
+IngestRange::~IngestRange(){
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    work.notify_one();
+    worker.join();
+}
+
+/*
+    Buffers a modification, blocking while the buffer is full
+    Only wakes the background thread when the buffer stops being empty or
+    fills up a batch, since it is either waiting for one of those or busy
+*/
+void IngestRange::submit(Op op, int start, int end){
+    // an empty selection changes nothing, so there is nothing to buffer
+    if (start >= end){
+        return;
+    }
+    std::unique_lock<std::mutex> guard(lock);
+    space.wait(guard, [&]{ return buffer.size() < options.capacity; });
+    buffer.push_back(Pending{op, start, end});
+    submitted++;
+    if (buffer.size() == 1 || buffer.size() == options.batchSize){
+        work.notify_one();
+    }
+}
+
+/*
+    Body of the background thread
+    Waits for the buffer to have something in it, then for up to maxDelay more
+    for it to fill a whole batch, unless a thread is flushing or the set is
+    being destroyed. Then swaps the buffer for an empty one, so the producers
+    can carry on while the batch is applied, and the two vectors take turns
+    from then on without allocating again.
+*/
+void IngestRange::run(){
+    std::vector<Pending> batch;
+    std::unique_lock<std::mutex> guard(lock);
+    while (true){
+        work.wait(guard, [&]{ return stopping || !buffer.empty(); });
+        if (buffer.empty()){
+            return;
+        }
+        work.wait_for(guard, options.maxDelay, [&]{
+            return stopping || flushing > 0 || buffer.size() >= options.batchSize;
+        });
+        batch.swap(buffer);
+        std::uint64_t sequence = submitted;
+        space.notify_all();
+        guard.unlock();
+        apply(batch);
+        batch.clear();
+        guard.lock();
+        done = sequence;
+        applied.notify_all();
+    }
+}
+
+/*
+    Applies a batch of modifications to the Range in order
+    Each run of consecutive Adds, or of consecutive Deletes, can be applied in
+    any order without changing the result, so it goes to AddBatch or DeleteBatch
+    to be coalesced and applied in one pass. While the set holds fewer ranges
+    than the run, its whole tree stays in cache and searching it costs less than
+    sorting the run would, so the run goes straight to Add or Delete instead.
+*/
+void IngestRange::apply(const std::vector<Pending>& batch){
+    std::vector<std::pair<int, int>> run;
+    std::lock_guard<std::mutex> guard(rangeLock);
+    for (std::size_t i = 0; i < batch.size(); ){
+        Op op = batch[i].op;
+        std::size_t first = i;
+        while (i < batch.size() && batch[i].op == op){
+            i++;
+        }
+        if (range.Size() < i - first || i - first == 1){
+            for (std::size_t j = first; j < i; j++){
+                if (op == Op::Add){
+                    range.Add(batch[j].start, batch[j].end);
+                } else {
+                    range.Delete(batch[j].start, batch[j].end);
+                }
+            }
+            continue;
+        }
+        run.clear();
+        for (std::size_t j = first; j < i; j++){
+            run.emplace_back(batch[j].start, batch[j].end);
+        }
+        if (op == Op::Add){
+            range.AddBatch(run);
+        } else {
+            range.DeleteBatch(run);
+        }
+    }
+}
+
+/*
+    Buffers the addition of a range, to be applied by the background thread
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(1) amortized
+*/
+void IngestRange::Add(int start, int end){
+    submit(Op::Add, start, end);
+}
+
+/*
+    Buffers the removal of the points in a range, to be applied by the background thread
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(1) amortized
+*/
+void IngestRange::Delete(int start, int end){
+    submit(Op::Delete, start, end);
+}
+
+/*
+    Returns once every modification made before the call has been applied
+    Tells the background thread not to wait for a full batch while anyone is flushing
+*/
+void IngestRange::Flush(){
+    std::unique_lock<std::mutex> guard(lock);
+    std::uint64_t target = submitted;
+    if (done >= target){
+        return;
+    }
+    flushing++;
+    work.notify_one();
+    applied.wait(guard, [&]{ return done >= target; });
+    flushing--;
+}
+
+/*
+    Returns a list of ranges that have been applied to the data structure
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(n)
+*/
+std::vector<std::pair<int, int>> IngestRange::Get(int start, int end) const{
+    std::lock_guard<std::mutex> guard(rangeLock);
+    return range.Get(start, end);
+}
+
+/*
+    Returns the number of modifications made but not yet applied
+*/
+std::size_t IngestRange::Backlog() const{
+    std::lock_guard<std::mutex> guard(lock);
+    return submitted - done;
+}
+
+/*
+    Convenience function to print the start and endpoints of the applied ranges in reverse order.
+    Returns nothing, but prints to stdout.
+    Used for Debugging.
+*/
+void IngestRange::printAll() const{
+    std::lock_guard<std::mutex> guard(rangeLock);
+    range.printAll();
+}
+
+/*
+    Convenience function to serialize the applied ranges into a list of start and end points.
+    Returns a list in reverse order, matching Range::toVec.
+    Used for Testcase Verification.
+*/
+std::vector<int> IngestRange::toVec() const{
+    std::lock_guard<std::mutex> guard(rangeLock);
+    return range.toVec();
+}
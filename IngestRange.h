@@ -0,0 +1,177 @@
+#ifndef _INGEST_RANGE_H_
+#define _INGEST_RANGE_H_
+
+#include "Range.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+    Controls how much an IngestRange buffers and how long it waits before applying it
+*/
+struct IngestOptions
+{
+    // number of modifications that may wait in the buffer, at least 1
+    // once it is full, Add and Delete block until the background thread takes it
+    std::size_t capacity = 1 << 18;
+    // number of buffered modifications at which the background thread
+    // applies them at once, rather than waiting for maxDelay to pass
+    std::size_t batchSize = 1 << 16;
+    // longest time a modification waits in the buffer before it is applied,
+    // unless the background thread is still busy with the previous batch
+    std::chrono::milliseconds maxDelay = std::chrono::milliseconds(2);
+};
+
+/*
+    Thread safe front end to a Range for a high rate of small modifications,
+    such as an unordered stream of adjacent or repeated ranges.
+
+    Add and Delete only append the modification to a buffer and return. A
+    background thread takes the whole buffer at once, cuts it into runs of
+    consecutive Adds and consecutive Deletes, and applies each run with
+    AddBatch or DeleteBatch, which sort and coalesce it and apply it in a single
+    pass over the Range. Modifications are applied in the order they were made,
+    so the result is the same as calling Add and Delete on the Range directly.
+    This pays off once the Range is too large to stay in cache; a small Range
+    is quicker to modify directly than through the buffer.
+
+    Memory is bounded: at most options.capacity modifications wait in the
+    buffer, plus the batch being applied. Once the buffer is full, Add and
+    Delete block until the background thread takes it, which slows the
+    producers down to the rate the Range can keep up with.
+
+    Get only reflects the modifications that have been applied. Call Flush
+    first to see every modification made before it, including one's own.
+*/
+class IngestRange
+{
+private:
+    enum class Op : std::uint8_t { Add, Delete };
+
+    // a single buffered modification
+    struct Pending
+    {
+        Op op;
+        int start;
+        int end;
+    };
+
+    Range range;
+    IngestOptions options;
+
+    // guards the Range, so that Get never sees a batch half applied
+    mutable std::mutex rangeLock;
+
+    // guards everything below
+    mutable std::mutex lock;
+    // signalled when the buffer has work for the background thread
+    std::condition_variable work;
+    // signalled when the background thread takes the buffer, making space
+    std::condition_variable space;
+    // signalled when the background thread finishes applying a batch
+    std::condition_variable applied;
+    // modifications not yet taken by the background thread
+    std::vector<Pending> buffer;
+    // sequence numbers of the last modification buffered and the last one applied
+    std::uint64_t submitted;
+    std::uint64_t done;
+    // number of threads waiting in Flush, which the background thread doesn't keep waiting
+    std::size_t flushing;
+    bool stopping;
+
+    std::thread worker;
+
+    /*
+        Buffers a modification, blocking while the buffer is full
+    */
+    void submit(Op op, int start, int end);
+
+    /*
+        Body of the background thread: takes the buffer and applies it until stopped,
+        applying whatever is left in the buffer before returning
+    */
+    void run();
+
+    /*
+        Applies a batch of modifications to the Range in order, one run of
+        consecutive Adds or Deletes at a time
+        Time Complexity: O(klogk + min(klogn, k + n)), k being the number of modifications
+    */
+    void apply(const std::vector<Pending>& batch);
+public:
+    /*
+        Starts the background thread
+
+        options: how much to buffer and how long to wait before applying it
+    */
+    explicit IngestRange(IngestOptions options = IngestOptions());
+
+    /*
+        Applies every buffered modification, then stops the background thread
+    */
+    ~IngestRange();
+    IngestRange(const IngestRange&) = delete;
+    IngestRange& operator=(const IngestRange&) = delete;
+
+    /*
+        Buffers the addition of a range, to be applied by the background thread
+        Blocks while the buffer is full
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(1) amortized
+    */
+    void Add(int, int);
+
+    /*
+        Buffers the removal of the points in a range, to be applied by the background thread
+        Blocks while the buffer is full
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(1) amortized
+    */
+    void Delete(int, int);
+
+    /*
+        Returns once every modification made before the call has been applied,
+        so that a Get made after it sees them all
+    */
+    void Flush();
+
+    /*
+        Returns a list of ranges that have been applied to the data structure
+        that intersect with the selection range
+        Doesn't wait for buffered modifications; call Flush first for that
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(n)
+    */
+    std::vector<std::pair<int, int>> Get(int, int) const;
+
+    /*
+        Returns the number of modifications made but not yet applied
+    */
+    std::size_t Backlog() const;
+
+    /*
+        Convenience function to print the start and endpoints of the applied ranges in reverse order.
+        Returns nothing, but prints to stdout.
+        Used for Debugging.
+    */
+    void printAll() const;
+
+    /*
+        Convenience function to serialize the applied ranges into a list of start and end points.
+        Returns a list in reverse order, matching Range::toVec.
+        Used for Testcase Verification.
+    */
+    std::vector<int> toVec() const;
+};
+#endif
@@ -0,0 +1,405 @@
+#include "Range.h"
+#include "FlatRange.h"
+#include "BTreeRange.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+    Performance regression suite, in the spirit of Google Benchmark.
+    Times Add, Delete and Get on every backend, for several workloads and set
+    sizes, and prints one machine readable row per case with the time,
+    allocations and peak resident memory per operation.
+    Build with "make perf" and run ./range_perf --help for the options.
+
+    Every case runs in a process of its own, so that the peak resident memory
+    reported for it isn't inflated by the cases before it.
+*/
+
+// counts calls to operator new, so that allocations per operation can be reported
+static std::atomic<std::size_t> allocations(0);
+
+void* operator new(std::size_t size){
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size != 0 ? size : 1)){
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size){
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept{
+    std::free(memory);
+}
+
+// keeps the optimizer from discarding the results of the queries
+static volatile std::size_t sink;
+
+// the operations that can be timed
+// Build is the initial population of the set, in increasing order
+enum class Op { Build, Add, Delete, Get };
+
+const char* opName(Op op){
+    switch (op){
+        case Op::Build: return "build";
+        case Op::Add: return "add";
+        case Op::Delete: return "delete";
+        case Op::Get: return "get";
+    }
+    return "";
+}
+
+/*
+    Describes how the set is populated and which selections the operations use
+    Every workload starts out with "n" ranges spread over [0, 20n), so that even
+    10^8 of them fit in an int
+*/
+struct Workload
+{
+    const char* name;
+    // returns the i-th of the n initial ranges, in increasing order
+    std::pair<int, int> (*initial)(std::size_t i, std::size_t n);
+    // returns a random selection for "op" on a set of n ranges
+    std::pair<int, int> (*selection)(Op op, std::mt19937_64& gen, std::size_t n);
+};
+
+/*
+    Returns a random integer in [0, bound)
+*/
+std::size_t below(std::mt19937_64& gen, std::size_t bound){
+    return std::uniform_int_distribution<std::size_t>(0, bound - 1)(gen);
+}
+
+// ranges of width 10 spaced 20 apart
+std::pair<int, int> spacedRange(std::size_t i, std::size_t){
+    int start = static_cast<int>(i) * 20;
+    return std::make_pair(start, start + 10);
+}
+
+// narrow selections anywhere in the set, each touching a range or two
+std::pair<int, int> uniformSelection(Op op, std::mt19937_64& gen, std::size_t n){
+    int point = static_cast<int>(below(gen, n * 20));
+    return std::make_pair(point, point + (op == Op::Get ? 40 : 10));
+}
+
+// ranges packed into clusters of 1024, each cluster followed by an empty
+// stretch as wide as itself
+std::pair<int, int> clusteredRange(std::size_t i, std::size_t){
+    int start = static_cast<int>(i / 1024) * 20480 + static_cast<int>(i % 1024) * 10;
+    return std::make_pair(start, start + 8);
+}
+
+// narrow selections concentrated on a few hot clusters, most of them
+// bridging or splitting the small gaps between ranges
+std::pair<int, int> clusteredSelection(Op op, std::mt19937_64& gen, std::size_t n){
+    std::size_t clusters = (n + 1023) / 1024;
+    double skew = std::uniform_real_distribution<double>(0, 1)(gen);
+    std::size_t cluster = std::min(clusters - 1, static_cast<std::size_t>(skew * skew * skew * clusters));
+    int point = static_cast<int>(cluster * 20480 + below(gen, 10240));
+    return std::make_pair(point, point + (op == Op::Get ? 100 : 5));
+}
+
+// wide selections, each spanning about a hundred ranges
+std::pair<int, int> overlappingSelection(Op, std::mt19937_64& gen, std::size_t n){
+    int point = static_cast<int>(below(gen, n * 20));
+    return std::make_pair(point, point + 2000);
+}
+
+// every Add fills the gap between two neighbouring ranges, merging them,
+// every Delete splits a range in two, and every Get clips both of its ends
+std::pair<int, int> adversarialSelection(Op op, std::mt19937_64& gen, std::size_t n){
+    int start = static_cast<int>(below(gen, n > 1 ? n - 1 : 1)) * 20;
+    switch (op){
+        case Op::Add: return std::make_pair(start + 10, start + 20);
+        case Op::Delete: return std::make_pair(start + 3, start + 7);
+        default: return std::make_pair(start + 5, start + 5 + 20 * 64);
+    }
+}
+
+const Workload workloads[] = {
+    {"uniform", spacedRange, uniformSelection},
+    {"clustered", clusteredRange, clusteredSelection},
+    {"overlapping", spacedRange, overlappingSelection},
+    {"adversarial", spacedRange, adversarialSelection},
+};
+
+// the measurements of a single case
+struct Result
+{
+    std::size_t iterations;
+    double nsPerOp;
+    double allocsPerOp;
+    long peakRssKb;
+};
+
+/*
+    Returns the peak resident memory of this process so far, in kilobytes
+*/
+long peakRss(){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/*
+    Appends to "gaps" the parts of "selection" not covered by "covered",
+    which holds the result of Get on the same selection
+*/
+void appendGaps(std::pair<int, int> selection, const std::vector<std::pair<int, int>>& covered,
+    std::vector<std::pair<int, int>>& gaps){
+    int next = selection.first;
+    for (auto&& piece : covered){
+        if (piece.first > next){
+            gaps.push_back(std::make_pair(next, piece.first));
+        }
+        next = piece.second;
+    }
+    if (next < selection.second){
+        gaps.push_back(std::make_pair(next, selection.second));
+    }
+}
+
+/*
+    Records "selection", widened by a range on each side, in "claimed", which is
+    sorted by start, unless it overlaps a selection already there
+    Returns whether it was recorded
+*/
+bool claim(std::vector<std::pair<int, int>>& claimed, std::pair<int, int> selection){
+    std::pair<int, int> widened = std::make_pair(selection.first - 20, selection.second + 20);
+    auto next = std::upper_bound(claimed.begin(), claimed.end(), widened);
+    if ((next != claimed.end() && next->first < widened.second)
+        || (next != claimed.begin() && std::prev(next)->second > widened.first)){
+        return false;
+    }
+    claimed.insert(next, widened);
+    return true;
+}
+
+/*
+    Populates a backend with "n" ranges of "workload", then times "op" on it
+    The operations run in chunks of doubling size, with the selections for each
+    chunk generated before its timer starts, until "minTime" seconds have passed
+    After each chunk of Add or Delete, the set is put back the way it was before
+    the chunk, outside of the timer, so that every chunk runs against the initial
+    set rather than one that drifts towards fully covered or empty. For the same
+    reason, a chunk of Add or Delete ends early rather than take a selection
+    touching one it already has, which keeps the chunks short when the
+    selections are wide compared to the set
+
+    workload: how to populate the set and pick selections
+    op: the operation to time
+    n: number of ranges to start with
+    minTime: minimum number of seconds to spend timing the operation
+*/
+template <typename RangeType>
+Result runCase(const Workload& workload, Op op, std::size_t n, double minTime){
+    typedef std::chrono::steady_clock Clock;
+    RangeType range;
+    std::size_t allocsBefore = allocations.load();
+    auto begin = Clock::now();
+    for (std::size_t i = 0; i < n; i++){
+        auto initial = workload.initial(i, n);
+        range.Add(initial.first, initial.second);
+    }
+    if (op == Op::Build){
+        double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+        return {n, elapsed / n, static_cast<double>(allocations.load() - allocsBefore) / n, peakRss()};
+    }
+
+    std::mt19937_64 gen(n);
+    std::vector<std::pair<int, int>> selections;
+    // what has to be deleted after a chunk of Add, or added back after a chunk of Delete
+    std::vector<std::pair<int, int>> restore;
+    // the selections of the current chunk, widened and sorted
+    std::vector<std::pair<int, int>> claimed;
+    std::size_t iterations = 0;
+    std::size_t allocs = 0;
+    double elapsed = 0;
+    for (std::size_t chunk = 1; elapsed < minTime * 1e9; chunk = std::min<std::size_t>(chunk * 2, 1024)){
+        selections.clear();
+        restore.clear();
+        claimed.clear();
+        for (std::size_t i = 0; i < chunk; i++){
+            auto selection = workload.selection(op, gen, n);
+            if (op != Op::Get && !claim(claimed, selection)){
+                break;
+            }
+            selections.push_back(selection);
+            if (op == Op::Add){
+                appendGaps(selection, range.Get(selection.first, selection.second), restore);
+            } else if (op == Op::Delete){
+                auto covered = range.Get(selection.first, selection.second);
+                restore.insert(restore.end(), covered.begin(), covered.end());
+            }
+        }
+        allocsBefore = allocations.load();
+        begin = Clock::now();
+        for (auto&& selection : selections){
+            if (op == Op::Add){
+                range.Add(selection.first, selection.second);
+            } else if (op == Op::Delete){
+                range.Delete(selection.first, selection.second);
+            } else {
+                sink = sink + range.Get(selection.first, selection.second).size();
+            }
+        }
+        elapsed += std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+        allocs += allocations.load() - allocsBefore;
+        iterations += selections.size();
+        for (auto&& piece : restore){
+            if (op == Op::Add){
+                range.Delete(piece.first, piece.second);
+            } else {
+                range.Add(piece.first, piece.second);
+            }
+        }
+    }
+    return {iterations, elapsed / iterations, static_cast<double>(allocs) / iterations, peakRss()};
+}
+
+// a backend and the function running a case on it
+struct Backend
+{
+    const char* name;
+    Result (*run)(const Workload&, Op, std::size_t, double);
+};
+
+const Backend backends[] = {
+    {"Range", runCase<Range>},
+    {"PooledRange", runCase<PooledRange>},
+    {"FlatRange", runCase<FlatRange>},
+    {"BTreeRange", runCase<BTreeRange<>>},
+};
+
+// command line options
+struct Options
+{
+    int minExponent = 2;
+    int maxExponent = 6;
+    double minTime = 0.2;
+    bool json = false;
+    std::string filter;
+};
+
+void printUsage(const char* program){
+    std::printf(
+        "usage: %s [--min-exp N] [--max-exp N] [--min-time SECONDS] [--filter TEXT] [--format csv|json]\n"
+        "  --min-exp, --max-exp  run set sizes from 10^min-exp to 10^max-exp ranges (default 2 to 6, at most 8)\n"
+        "  --min-time            seconds to spend timing each operation (default 0.2)\n"
+        "  --filter              only run cases whose name, backend/workload/op/size, contains TEXT\n"
+        "  --format              print comma separated values (default) or one JSON object per line\n",
+        program);
+}
+
+/*
+    Parses the command line into "options"
+    Returns whether it was valid
+*/
+bool parseOptions(int argc, char** argv, Options& options){
+    for (int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        if (i + 1 >= argc){
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--min-exp"){
+            options.minExponent = std::atoi(value.c_str());
+        } else if (arg == "--max-exp"){
+            options.maxExponent = std::atoi(value.c_str());
+        } else if (arg == "--min-time"){
+            options.minTime = std::atof(value.c_str());
+        } else if (arg == "--filter"){
+            options.filter = value;
+        } else if (arg == "--format" && (value == "csv" || value == "json")){
+            options.json = value == "json";
+        } else {
+            return false;
+        }
+    }
+    return options.minExponent >= 0 && options.maxExponent <= 8 && options.minExponent <= options.maxExponent;
+}
+
+/*
+    Prints the row for one case
+*/
+void printResult(const Options& options, const std::string& name, const Backend& backend,
+    const Workload& workload, Op op, std::size_t n, const Result& result){
+    if (options.json){
+        std::printf("{\"name\": \"%s\", \"backend\": \"%s\", \"workload\": \"%s\", \"op\": \"%s\", "
+            "\"size\": %zu, \"iterations\": %zu, \"ns_per_op\": %.2f, \"allocs_per_op\": %.3f, \"peak_rss_kb\": %ld}\n",
+            name.c_str(), backend.name, workload.name, opName(op), n,
+            result.iterations, result.nsPerOp, result.allocsPerOp, result.peakRssKb);
+    } else {
+        std::printf("%s,%s,%s,%s,%zu,%zu,%.2f,%.3f,%ld\n", name.c_str(), backend.name, workload.name, opName(op), n,
+            result.iterations, result.nsPerOp, result.allocsPerOp, result.peakRssKb);
+    }
+}
+
+int main(int argc, char** argv){
+    Options options;
+    if (!parseOptions(argc, argv, options)){
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (!options.json){
+        std::printf("name,backend,workload,op,size,iterations,ns_per_op,allocs_per_op,peak_rss_kb\n");
+    }
+    int failures = 0;
+    for (int exponent = options.minExponent; exponent <= options.maxExponent; exponent++){
+        std::size_t n = 1;
+        for (int i = 0; i < exponent; i++){
+            n *= 10;
+        }
+        for (const Workload& workload : workloads){
+            for (const Backend& backend : backends){
+                for (Op op : {Op::Build, Op::Add, Op::Delete, Op::Get}){
+                    std::string name = std::string(backend.name) + "/" + workload.name + "/" + opName(op) + "/" + std::to_string(n);
+                    if (name.find(options.filter) == std::string::npos){
+                        continue;
+                    }
+                    // the child inherits anything still buffered, which it would print again
+                    std::fflush(stdout);
+                    pid_t child = fork();
+                    if (child == 0){
+                        Result result = backend.run(workload, op, n, options.minTime);
+                        printResult(options, name, backend, workload, op, n, result);
+                        std::fflush(stdout);
+                        _exit(0);
+                    }
+                    int status = 0;
+                    if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+                        std::fprintf(stderr, "%s: failed\n", name.c_str());
+                        failures++;
+                    }
+                }
+            }
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,538 @@
+#ifndef _PERSISTENT_RANGE_H_
+#define _PERSISTENT_RANGE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*
+    The points that changed between two versions of a BasicPersistentRange
+*/
+template <typename Key>
+struct RangeDiff
+{
+    // ranges covered by the newer version but not the older one, in increasing order
+    std::vector<std::pair<Key, Key>> added;
+    // ranges covered by the older version but not the newer one, in increasing order
+    std::vector<std::pair<Key, Key>> removed;
+};
+
+/*
+    Persistent alternative to Range, whose versions share everything they have in common.
+
+    The ranges are kept in a treap of immutable, reference counted nodes.
+    Add and Delete never modify a node: they build new nodes for the O(logn)
+    nodes on the paths they change and point them at the untouched subtrees of
+    the old tree. Snapshot is therefore just a copy of the root pointer, O(1)
+    whatever the size of the set, and an old version stays valid, unchanged,
+    for as long as some copy of it is alive. Nodes are freed when the last
+    version using them goes away.
+
+    Each node's priority is a hash of its start point, so the shape of the
+    tree depends only on the ranges in it and not on the order they were added
+    in. Diff relies on this to line up two versions and skip every subtree they
+    share, so it costs time proportional to the change rather than the size.
+
+    Versions can be read from several threads at once, and a version can be
+    handed to another thread while this one keeps modifying its own copy, since
+    the reference counts are atomic. A single version must not be modified
+    while another thread is reading or copying it.
+    Exposes the same interface and produces the same results as Range.
+*/
+template <typename Key>
+class BasicPersistentRange
+{
+private:
+    struct Node;
+    typedef std::shared_ptr<const Node> Ptr;
+
+    struct Node
+    {
+        Key start;
+        Key end;
+        std::uint64_t priority;
+        // the number of ranges in the subtree rooted at this node
+        std::size_t count;
+        // ranges starting before and after this one
+        Ptr left;
+        Ptr right;
+    };
+
+    Ptr root;
+
+    static std::uint64_t priorityOf(Key);
+    static bool above(const Node*, const Node*);
+    static std::size_t countOf(const Ptr&);
+    static Ptr make(Key, Key, Ptr, Ptr);
+    static Ptr with(const Ptr&, Ptr, Ptr);
+    static void split(const Ptr&, Key, bool, Ptr&, Ptr&);
+    static Ptr join(const Ptr&, const Ptr&);
+    static const Node* last(const Ptr&);
+    static void collect(const Ptr&, std::vector<std::pair<Key, Key>>&);
+    static void collect(const Ptr&, Key, Key, std::vector<std::pair<Key, Key>>&);
+    static void diff(const Ptr&, const Ptr&, std::vector<std::pair<Key, Key>>&, std::vector<std::pair<Key, Key>>&);
+    static std::vector<std::pair<Key, Key>> subtract(const std::vector<std::pair<Key, Key>>&, const std::vector<std::pair<Key, Key>>&);
+public:
+    BasicPersistentRange();
+
+    /*
+        Adds a range to the data structure, merging together existing
+        ranges if neccessary
+        Versions taken before are unaffected
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn), expected
+    */
+    void Add(Key, Key);
+
+    /*
+        Removes ranges that exist within the data structure
+        that intersect with the selection range
+        Versions taken before are unaffected
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn), expected
+    */
+    void Delete(Key, Key);
+
+    /*
+        Returns a list of ranges that exist within the data structure
+        that intersect with the selection range
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn + k), k being the number of ranges returned
+    */
+    std::vector<std::pair<Key, Key>> Get(Key, Key) const;
+
+    /*
+        Returns the number of ranges in the data structure
+        Time Complexity: O(1)
+    */
+    std::size_t Size() const;
+
+    /*
+        Returns the current version of the set, which later modifications of
+        this one don't affect, and vice versa
+        Copying a BasicPersistentRange does the same; this just names the intent
+        Time Complexity: O(1)
+    */
+    BasicPersistentRange Snapshot() const;
+
+    /*
+        Returns the points covered by this version but not "older", and the
+        points covered by "older" but not this version
+        Only looks at the parts of the two versions that aren't shared, so
+        comparing a version with one it was derived from takes time
+        proportional to the modifications made in between
+
+        older: The version to compare against
+        Time Complexity: O(dlogn), d being the number of ranges that differ,
+        expected
+    */
+    RangeDiff<Key> Diff(const BasicPersistentRange& older) const;
+
+    /*
+        Convenience function to print the start and endpoints of the range in reverse order.
+        Returns nothing, but prints to stdout.
+        Used for Debugging.
+    */
+    void printAll() const;
+
+    /*
+        Convenience function to serialize the range into a list of start and end points.
+        Returns a list in reverse order, matching Range::toVec.
+        Used for Testcase Verification.
+    */
+    std::vector<Key> toVec() const;
+};
+
+typedef BasicPersistentRange<int> PersistentRange;
+
+template <typename Key>
+BasicPersistentRange<Key>::BasicPersistentRange() {
+
+}
+
+/*
+    Returns the priority of the node starting at "start", mixed with the
+    finalizer of SplitMix64 so that neighbouring start points get unrelated ones
+*/
+template <typename Key>
+std::uint64_t BasicPersistentRange<Key>::priorityOf(Key start){
+    std::uint64_t hash = static_cast<std::uint64_t>(start) + 0x9e3779b97f4a7c15ull;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+// returns whether "a" belongs above "b" in the tree, breaking ties between
+// equal priorities by start point so that the shape is always the same
+template <typename Key>
+bool BasicPersistentRange<Key>::above(const Node* a, const Node* b){
+    return a->priority > b->priority || (a->priority == b->priority && a->start < b->start);
+}
+
+template <typename Key>
+std::size_t BasicPersistentRange<Key>::countOf(const Ptr& node){
+    return node ? node->count : 0;
+}
+
+// builds a new node
+template <typename Key>
+typename BasicPersistentRange<Key>::Ptr BasicPersistentRange<Key>::make(Key start, Key end, Ptr left, Ptr right){
+    std::size_t count = countOf(left) + 1 + countOf(right);
+    return std::make_shared<const Node>(Node{start, end, priorityOf(start), count, std::move(left), std::move(right)});
+}
+
+// returns "node" with its children replaced, reusing it if they are the same
+template <typename Key>
+typename BasicPersistentRange<Key>::Ptr BasicPersistentRange<Key>::with(const Ptr& node, Ptr left, Ptr right){
+    if (left == node->left && right == node->right){
+        return node;
+    }
+    return make(node->start, node->end, std::move(left), std::move(right));
+}
+
+/*
+    Splits the tree under "node" into the ranges starting before "key" (or at
+    or before it, if "inclusive") in "less", and the rest in "rest"
+    Only the nodes on the path to "key" are copied
+    "less" and "rest" must not refer to "node"
+    Time Complexity: O(logn), expected
+*/
+template <typename Key>
+void BasicPersistentRange<Key>::split(const Ptr& node, Key key, bool inclusive, Ptr& less, Ptr& rest){
+    if (!node){
+        less = nullptr;
+        rest = nullptr;
+        return;
+    }
+    if (node->start < key || (inclusive && node->start == key)){
+        Ptr right;
+        split(node->right, key, inclusive, right, rest);
+        less = with(node, node->left, std::move(right));
+    } else {
+        Ptr left;
+        split(node->left, key, inclusive, less, left);
+        rest = with(node, std::move(left), node->right);
+    }
+}
+
+/*
+    Joins two trees, every range of "low" starting before every range of "high"
+    Time Complexity: O(logn), expected
+*/
+template <typename Key>
+typename BasicPersistentRange<Key>::Ptr BasicPersistentRange<Key>::join(const Ptr& low, const Ptr& high){
+    if (!low){
+        return high;
+    }
+    if (!high){
+        return low;
+    }
+    if (above(low.get(), high.get())){
+        return with(low, low->left, join(low->right, high));
+    }
+    return with(high, join(low, high->left), high->right);
+}
+
+// returns the range with the largest start point, or null for an empty tree
+template <typename Key>
+const typename BasicPersistentRange<Key>::Node* BasicPersistentRange<Key>::last(const Ptr& node){
+    const Node* at = node.get();
+    while (at != nullptr && at->right){
+        at = at->right.get();
+    }
+    return at;
+}
+
+// appends every range under "node" to "out", in increasing order
+template <typename Key>
+void BasicPersistentRange<Key>::collect(const Ptr& node, std::vector<std::pair<Key, Key>>& out){
+    if (!node){
+        return;
+    }
+    collect(node->left, out);
+    out.push_back(std::make_pair(node->start, node->end));
+    collect(node->right, out);
+}
+
+/*
+    Appends every range under "node" intersecting the selection range to "out",
+    clipped to it, in increasing order
+    The ends are sorted just like the starts, so whole subtrees can be skipped
+    on either side of the selection
+*/
+template <typename Key>
+void BasicPersistentRange<Key>::collect(const Ptr& node, Key start, Key end, std::vector<std::pair<Key, Key>>& out){
+    if (!node){
+        return;
+    }
+    if (node->end <= start){
+        collect(node->right, start, end, out);
+        return;
+    }
+    if (node->start >= end){
+        collect(node->left, start, end, out);
+        return;
+    }
+    collect(node->left, start, end, out);
+    out.push_back(std::make_pair(std::max(start, node->start), std::min(end, node->end)));
+    collect(node->right, start, end, out);
+}
+
+/*
+    Appends the ranges stored under "older" but not under "newer" to "removed",
+    and those stored under "newer" but not under "older" to "added", both in
+    increasing order
+    Subtrees shared by both are skipped. Elsewhere, both trees hold the same
+    shape around the ranges they have in common, so the one whose root belongs
+    higher up is matched against the other split at its start point
+*/
+template <typename Key>
+void BasicPersistentRange<Key>::diff(const Ptr& older, const Ptr& newer,
+    std::vector<std::pair<Key, Key>>& removed, std::vector<std::pair<Key, Key>>& added){
+    if (older == newer){
+        return;
+    }
+    if (!older){
+        collect(newer, added);
+        return;
+    }
+    if (!newer){
+        collect(older, removed);
+        return;
+    }
+    if (older->start == newer->start){
+        diff(older->left, newer->left, removed, added);
+        if (older->end != newer->end){
+            removed.push_back(std::make_pair(older->start, older->end));
+            added.push_back(std::make_pair(newer->start, newer->end));
+        }
+        diff(older->right, newer->right, removed, added);
+        return;
+    }
+    // split the lower of the two roots' trees around the higher one's start
+    bool olderAbove = above(older.get(), newer.get());
+    const Ptr& top = olderAbove ? older : newer;
+    const Ptr& other = olderAbove ? newer : older;
+    Ptr less;
+    Ptr rest;
+    Ptr same;
+    Ptr more;
+    split(other, top->start, false, less, rest);
+    split(rest, top->start, true, same, more);
+    diff(olderAbove ? top->left : less, olderAbove ? less : top->left, removed, added);
+    // "same" is the other tree's range starting where the top one does, if any
+    if (!same || same->end != top->end){
+        auto& fromTop = olderAbove ? removed : added;
+        auto& fromSame = olderAbove ? added : removed;
+        fromTop.push_back(std::make_pair(top->start, top->end));
+        if (same){
+            fromSame.push_back(std::make_pair(same->start, same->end));
+        }
+    }
+    diff(olderAbove ? top->right : more, olderAbove ? more : top->right, removed, added);
+}
+
+/*
+    Returns the points covered by the sorted, disjoint ranges of "from"
+    but not by those of "minus"
+    Time Complexity: O(a + b)
+*/
+template <typename Key>
+std::vector<std::pair<Key, Key>> BasicPersistentRange<Key>::subtract(const std::vector<std::pair<Key, Key>>& from,
+    const std::vector<std::pair<Key, Key>>& minus){
+    std::vector<std::pair<Key, Key>> ret;
+    std::size_t j = 0;
+    for (auto&& range : from){
+        Key start = range.first;
+        // skip the ranges of "minus" that end before this one starts
+        while (j < minus.size() && minus[j].second <= start){
+            j++;
+        }
+        // cut out every range of "minus" overlapping this one
+        std::size_t k = j;
+        for (; k < minus.size() && minus[k].first < range.second; k++){
+            if (start < minus[k].first){
+                ret.push_back(std::make_pair(start, minus[k].first));
+            }
+            start = std::max(start, minus[k].second);
+        }
+        if (start < range.second){
+            ret.push_back(std::make_pair(start, range.second));
+        }
+    }
+    return ret;
+}
+
+/*
+    Adds a range to the data structure, merging together existing
+    ranges if neccessary
+    The ranges touching the new one are cut out of the tree whole, with two splits,
+    rather than removed one at a time
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn), expected
+*/
+template <typename Key>
+void BasicPersistentRange<Key>::Add(Key start, Key end){
+    // an empty selection covers nothing, so there is nothing to add
+    if (start >= end){
+        return;
+    }
+    Ptr less;
+    Ptr rest;
+    split(root, start, false, less, rest);
+    // the last range starting before "start" merges if it reaches it
+    const Node* before = last(less);
+    if (before != nullptr && before->end >= start){
+        start = before->start;
+        end = std::max(end, before->end);
+        Ptr kept;
+        Ptr dropped;
+        split(less, start, false, kept, dropped);
+        less = std::move(kept);
+    }
+    // so does every range starting from "start" up to and including "end"
+    Ptr merged;
+    Ptr more;
+    split(rest, end, true, merged, more);
+    const Node* after = last(merged);
+    if (after != nullptr){
+        end = std::max(end, after->end);
+    }
+    root = join(join(less, make(start, end, nullptr, nullptr)), more);
+}
+
+/*
+    Removes ranges that exist within the data structure
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn), expected
+*/
+template <typename Key>
+void BasicPersistentRange<Key>::Delete(Key start, Key end){
+    // an empty selection covers nothing, so there is nothing to remove
+    if (start >= end){
+        return;
+    }
+    Ptr less;
+    Ptr rest;
+    split(root, start, false, less, rest);
+    // the parts of the outermost ranges that stick out of the selection survive
+    Ptr keptLeft;
+    Ptr keptRight;
+    const Node* before = last(less);
+    if (before != nullptr && before->end > start){
+        Key oldStart = before->start;
+        Key oldEnd = before->end;
+        Ptr kept;
+        Ptr dropped;
+        split(less, oldStart, false, kept, dropped);
+        less = std::move(kept);
+        keptLeft = make(oldStart, start, nullptr, nullptr);
+        if (oldEnd > end){
+            keptRight = make(end, oldEnd, nullptr, nullptr);
+        }
+    }
+    Ptr removed;
+    Ptr more;
+    split(rest, end, false, removed, more);
+    const Node* after = last(removed);
+    if (after != nullptr && after->end > end){
+        keptRight = make(end, after->end, nullptr, nullptr);
+    }
+    root = join(join(join(less, keptLeft), keptRight), more);
+}
+
+/*
+    Returns a list of ranges that exist within the data structure
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn + k), k being the number of ranges returned
+*/
+template <typename Key>
+std::vector<std::pair<Key, Key>> BasicPersistentRange<Key>::Get(Key start, Key end) const{
+    std::vector<std::pair<Key, Key>> ret;
+    // an empty selection can't intersect anything
+    if (start < end){
+        collect(root, start, end, ret);
+    }
+    return ret;
+}
+
+template <typename Key>
+std::size_t BasicPersistentRange<Key>::Size() const{
+    return countOf(root);
+}
+
+template <typename Key>
+BasicPersistentRange<Key> BasicPersistentRange<Key>::Snapshot() const{
+    return *this;
+}
+
+/*
+    Returns the points covered by this version but not "older", and the
+    points covered by "older" but not this version
+    The ranges that differ are found first; the ranges both versions share
+    can't overlap them, so only the differing ones need comparing point by point
+
+    older: The version to compare against
+    Time Complexity: O(dlogn), d being the number of ranges that differ, expected
+*/
+template <typename Key>
+RangeDiff<Key> BasicPersistentRange<Key>::Diff(const BasicPersistentRange& older) const{
+    std::vector<std::pair<Key, Key>> removed;
+    std::vector<std::pair<Key, Key>> added;
+    diff(older.root, root, removed, added);
+    RangeDiff<Key> ret;
+    ret.added = subtract(added, removed);
+    ret.removed = subtract(removed, added);
+    return ret;
+}
+
+/*
+    Convenience function to print the start and endpoints of the range in reverse order.
+    Returns nothing, but prints to stdout.
+    Used for Debugging.
+*/
+template <typename Key>
+void BasicPersistentRange<Key>::printAll() const{
+    std::vector<Key> vec = toVec();
+    for (std::size_t i = 0; i < vec.size(); i += 2){
+        std::cout << vec[i] << ", " << vec[i + 1] << ", ";
+    }
+    std::cout << std::endl;
+}
+
+/*
+    Convenience function to serialize the range into a list of start and end points.
+    Returns a list in reverse order, matching Range::toVec.
+    Used for Testcase Verification.
+*/
+template <typename Key>
+std::vector<Key> BasicPersistentRange<Key>::toVec() const{
+    std::vector<std::pair<Key, Key>> ranges;
+    collect(root, ranges);
+    std::vector<Key> vec;
+    vec.reserve(2 * ranges.size());
+    for (auto iter = ranges.rbegin(); iter != ranges.rend(); iter++){
+        vec.push_back(iter->second);
+        vec.push_back(iter->first);
+    }
+    return vec;
+}
+#endif
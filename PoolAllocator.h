@@ -0,0 +1,224 @@
+#ifndef _POOL_ALLOCATOR_H_
+#define _POOL_ALLOCATOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+/*
+    Recycles fixed size blocks, carved out of slabs that grow geometrically.
+    Freed blocks go on a free list and are handed out again before the next
+    slab is touched, so a container that keeps inserting and erasing nodes
+    stops calling operator new altogether once it has reached its largest size.
+    The slabs are only returned when the pool itself is destroyed.
+    Not thread safe; every container gets a pool of its own.
+*/
+class NodePool
+{
+private:
+    // a free block, reusing the block's own memory as the link
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    // the largest number of blocks allocated at once
+    static constexpr std::size_t maxSlabBlocks = 4096;
+
+    // size of every block, 0 until the first allocation decides it
+    std::size_t blockSize;
+    std::vector<void*> slabs;
+    FreeBlock* freeList;
+    // the unused tail of the newest slab
+    char* next;
+    char* slabEnd;
+    // number of blocks in the next slab
+    std::size_t nextSlabBlocks;
+
+    /*
+        Allocates a new slab of blocks, twice as large as the previous one
+    */
+    void grow(){
+        std::size_t bytes = blockSize * nextSlabBlocks;
+        char* slab = static_cast<char*>(::operator new(bytes));
+        slabs.push_back(slab);
+        next = slab;
+        slabEnd = slab + bytes;
+        nextSlabBlocks = std::min(nextSlabBlocks * 2, maxSlabBlocks);
+    }
+public:
+    NodePool() : blockSize(0), freeList(nullptr), next(nullptr), slabEnd(nullptr), nextSlabBlocks(16) {}
+    ~NodePool(){
+        for (void* slab : slabs){
+            ::operator delete(slab);
+        }
+    }
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    /*
+        Returns whether the pool can hand out blocks for objects of "size" bytes
+        The first size asked about decides the block size, later ones must match it
+    */
+    bool serves(std::size_t size, std::size_t alignment){
+        if (alignment > alignof(std::max_align_t)){
+            return false;
+        }
+        if (blockSize == 0){
+            // every block must be able to hold the free list link, and stay aligned
+            std::size_t rounded = std::max(size, sizeof(FreeBlock));
+            blockSize = (rounded + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+            return true;
+        }
+        return size <= blockSize && blockSize - size < alignof(std::max_align_t);
+    }
+
+    /*
+        Returns a block, reusing a freed one if there is any
+        Time Complexity: O(1), amortized
+    */
+    void* allocate(){
+        if (freeList != nullptr){
+            FreeBlock* block = freeList;
+            freeList = block->next;
+            return block;
+        }
+        if (next == slabEnd){
+            grow();
+        }
+        void* block = next;
+        next += blockSize;
+        return block;
+    }
+
+    /*
+        Puts a block back on the free list
+        Time Complexity: O(1)
+    */
+    void deallocate(void* block){
+        FreeBlock* freed = static_cast<FreeBlock*>(block);
+        freed->next = freeList;
+        freeList = freed;
+    }
+
+    /*
+        Returns the number of bytes held in slabs, in use or not
+    */
+    std::size_t Capacity() const{
+        std::size_t bytes = 0;
+        std::size_t blocks = 16;
+        for (std::size_t i = 0; i < slabs.size(); i++){
+            bytes += blocks * blockSize;
+            blocks = std::min(blocks * 2, maxSlabBlocks);
+        }
+        return bytes;
+    }
+};
+
+/*
+    Allocator handing out single objects from a NodePool, meant for node based
+    containers like std::map, which only ever allocate their nodes one at a time.
+    Anything else (arrays, or objects of a different size than the first one
+    allocated) goes straight to operator new.
+
+    Copies of an allocator share its pool, so that the rebound copies a container
+    makes for its nodes draw from the same pool. A container that is copied gets a
+    new pool of its own rather than sharing one with the original, and one that is
+    moved from hands its pool over and starts a new one, so that two containers
+    never touch the same pool, and can be used from different threads.
+*/
+template <typename T>
+class PoolAllocator
+{
+private:
+    template <typename U>
+    friend class PoolAllocator;
+
+    std::shared_ptr<NodePool> pool;
+
+    /*
+        Gives a moved from allocator a new pool, or "fallback" if there is no memory for one
+    */
+    void renew(const std::shared_ptr<NodePool>& fallback) noexcept{
+        try {
+            pool = std::make_shared<NodePool>();
+        } catch (const std::bad_alloc&){
+            pool = fallback;
+        }
+    }
+public:
+    typedef T value_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    PoolAllocator() : pool(std::make_shared<NodePool>()) {}
+    PoolAllocator(const PoolAllocator&) noexcept = default;
+    PoolAllocator& operator=(const PoolAllocator&) noexcept = default;
+
+    /*
+        Takes over the pool of "other", and gives "other" a new empty one, so that
+        a moved from container can still allocate without touching the pool of the
+        container its nodes went to. Only if that pool can't be allocated do the
+        two end up sharing one.
+    */
+    PoolAllocator(PoolAllocator&& other) noexcept : pool(std::move(other.pool)) {
+        other.renew(pool);
+    }
+    PoolAllocator& operator=(PoolAllocator&& other) noexcept{
+        if (this != &other){
+            pool = std::move(other.pool);
+            other.renew(pool);
+        }
+        return *this;
+    }
+
+    friend void swap(PoolAllocator& first, PoolAllocator& second) noexcept{
+        first.pool.swap(second.pool);
+    }
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept : pool(other.pool) {}
+
+    /*
+        Gives a copied container a pool of its own
+    */
+    PoolAllocator select_on_container_copy_construction() const{
+        return PoolAllocator();
+    }
+
+    T* allocate(std::size_t count){
+        if (count == 1 && pool->serves(sizeof(T), alignof(T))){
+            return static_cast<T*>(pool->allocate());
+        }
+        return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T* object, std::size_t count) noexcept{
+        if (count == 1 && pool->serves(sizeof(T), alignof(T))){
+            pool->deallocate(object);
+        } else {
+            ::operator delete(object);
+        }
+    }
+
+    /*
+        Returns the number of bytes held by the pool, in use or not
+    */
+    std::size_t Capacity() const{
+        return pool->Capacity();
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const{
+        return pool == other.pool;
+    }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& other) const{
+        return pool != other.pool;
+    }
+};
+#endif
@@ -2,16 +2,77 @@
 #include <map>
 #include <iostream>
 #include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#ifdef RANGE_PARALLEL_SORT
+#include <execution>
+#endif
 
-// nothing to do for constructor or destructor
-Range::Range() {
+// nothing to do for the constructors
+template <typename Key, typename Allocator>
+BasicRange<Key, Allocator>::BasicRange() {
 
 }
 
-Range::~Range() {
+template <typename Key, typename Allocator>
+BasicRange<Key, Allocator>::BasicRange(const Allocator& allocator) : table(allocator) {
 
 }
 
+/*
+    Builds the set from a list of ranges in any order
+    Once coalesced, the ranges are sorted and disjoint, so they are appended
+    from the lowest up without searching the map
+
+    ranges: The list of ranges, in any order
+    Time Complexity: O(klogk), k being the number of ranges in the list
+*/
+template <typename Key, typename Allocator>
+BasicRange<Key, Allocator>::BasicRange(std::vector<std::pair<Key, Key>> ranges, const Allocator& allocator) : table(allocator) {
+    ranges = coalesce(std::move(ranges));
+    appendSorted(ranges.begin(), ranges.end());
+}
+
+/*
+    Exchanges the ranges, subscribers and settings of the two sets
+    std::map swaps its root pointers and, with PoolAllocator, its pools,
+    so every node stays where it is
+
+    other: The set to exchange with
+    Time Complexity: O(1)
+*/
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::swap(BasicRange& other) noexcept{
+    table.swap(other.table);
+    std::swap(parallelThreshold, other.parallelThreshold);
+    std::swap(parallelThreads, other.parallelThreads);
+    feed.notify.swap(other.feed.notify);
+#ifdef RANGE_STATS
+    std::swap(stats, other.stats);
+#endif
+}
+
+/*
+    Returns a copy of the set without its subscriber
+    The copy constructor of std::map copies the tree node for node, which
+    is cheaper than inserting the ranges, and PoolAllocator gives the copy
+    a pool of its own
+
+    Time Complexity: O(n)
+*/
+template <typename Key, typename Allocator>
+BasicRange<Key, Allocator> BasicRange<Key, Allocator>::Clone() const{
+    return BasicRange(*this);
+}
+
 /*
     Adds a range to the data structure, merging together existing 
     ranges if neccessary
@@ -20,16 +81,58 @@ Range::~Range() {
     end: The end of the selection range
     Time Complexity: O(logn)
 */
-void Range::Add(int start, int end){
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::Add(Key start, Key end){
+#ifdef RANGE_STATS
+    ScopedLatency latency(stats.addLatency);
+    stats.adds++;
+#endif
+    // an empty selection covers nothing, so there is nothing to add
+    if (start >= end){
+        return;
+    }
+#ifdef RANGE_STATS
+    std::size_t before = table.size();
+#endif
     // find the maximal ranges whose starting point is less than or equal to that of
     // the "start" and "end" points
-    auto startIter = table.lower_bound(start);
-    auto endIter = table.lower_bound(end);
+    addAt(table.lower_bound(start), table.lower_bound(end), start, end);
+#ifdef RANGE_STATS
+    // the new range replaces every range it merged with
+    std::uint64_t merged = before + 1 - table.size();
+    stats.merged += merged;
+    stats.maxMerged.Raise(merged);
+#endif
+}
+
+/*
+    The body of Add, given startIter = table.lower_bound(start)
+    and endIter = table.lower_bound(end)
+    Returns the range containing "end" after adding, which is
+    table.lower_bound(end)
+*/
+template <typename Key, typename Allocator>
+typename BasicRange<Key, Allocator>::Table::iterator BasicRange<Key, Allocator>::addAt(typename Table::iterator startIter,
+    typename Table::iterator endIter, Key start, Key end){
+    // the points that become covered are the gaps between the ranges intersecting
+    // the selection, which the modification below is about to merge
+    if (feed.notify){
+        Key from = start;
+        for (auto&& range : makeView(startIter, endIter, start, end)){
+            if (from < range.first){
+                feed.notify(Change::Covered, from, range.first);
+            }
+            from = range.second;
+        }
+        if (from < end){
+            feed.notify(Change::Covered, from, end);
+        }
+    }
     // if "end" is less than every range in the table
     // this range is before the beginning, 
     // so insert a new range there
     if (endIter == table.end()){
-        table.insert(std::make_pair(start, end));
+        return table.insert(table.end(), std::make_pair(start, end));
     // if there is no entire existing range in between "start" and "end"
     } else if (startIter == endIter){
         // if "start" lies in an existing range while "end" does not, 
@@ -41,9 +144,11 @@ void Range::Add(int start, int end){
         }
         // if both "start" and "end" lie outside of an existing range
         // then insert a new range into the data structure from "start" to "end"
+        // it goes directly before startIter, so use that as the hint
         else if (start > startIter->second){
-            table.insert(std::make_pair(start, end));
+            return table.insert(startIter, std::make_pair(start, end));
         }
+        return startIter;
     // otherwise, there are one or more entire ranges between "start" and "end"
     // in this case, delete all the ranges between "start" and "end", as well as 
     // potentially the ranges they lie in
@@ -53,7 +158,7 @@ void Range::Add(int start, int end){
         // if "start" lies in an existing range
         // move the "start" value to the beginning of the existing range
         // also include this range when deleting (by incrementing the iterator)
-        if (start <= startIter->second && startIter != table.end()){
+        if (startIter != table.end() && start <= startIter->second){
             start = startIter->first;
             startIter++;
         }
@@ -65,8 +170,9 @@ void Range::Add(int start, int end){
         }
         // delete the neccessary ranges from the data structure
         // and replace them with the union of those ranges and the new range
-        table.erase(endIter, startIter);
-        table.insert(std::make_pair(start, end));
+        // which goes right where the deleted ranges used to be
+        auto next = table.erase(endIter, startIter);
+        return table.insert(next, std::make_pair(start, end));
     }
 }
 
@@ -78,24 +184,73 @@ void Range::Add(int start, int end){
     end: The end of the selection range
     Time Complexity: O(logn)
 */
-void Range::Delete(int start, int end){
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::Delete(Key start, Key end){
+#ifdef RANGE_STATS
+    ScopedLatency latency(stats.deleteLatency);
+    stats.deletes++;
+#endif
+    // an empty selection covers nothing, so there is nothing to remove
+    if (start >= end){
+        return;
+    }
     // find the maximal ranges whose starting point is less than or equal to that of
     // the "start" and "end" points
     auto startIter = table.lower_bound(start);
     auto endIter = table.lower_bound(end);
+#ifdef RANGE_STATS
+    // a range crossing "start" or "end" keeps the part outside of the selection
+    bool cutAtStart = startIter != table.end() && startIter->first < start && start < startIter->second;
+    bool cutAtEnd = endIter != table.end() && endIter->first < end && end < endIter->second;
+    bool sameRange = startIter == endIter;
+    std::size_t before = table.size();
+#endif
+    deleteAt(startIter, endIter, start, end);
+#ifdef RANGE_STATS
+    if (cutAtStart && cutAtEnd && sameRange){
+        stats.split++;
+    } else {
+        // the trimmed ranges stay, so only the ones erased entirely are gone
+        std::uint64_t trimmed = cutAtStart + cutAtEnd;
+        std::uint64_t erased = before - table.size();
+        stats.trimmed += trimmed;
+        stats.erased += erased;
+        stats.maxErased.Raise(erased);
+    }
+#endif
+}
+
+/*
+    The body of Delete, given startIter = table.lower_bound(start)
+    and endIter = table.lower_bound(end)
+    Returns a range whose start is less than or equal to "end" after deleting
+    (or table.end() if there is none), so that searches for larger values
+    can resume from it
+*/
+template <typename Key, typename Allocator>
+typename BasicRange<Key, Allocator>::Table::iterator BasicRange<Key, Allocator>::deleteAt(typename Table::iterator startIter,
+    typename Table::iterator endIter, Key start, Key end){
+    // the points that become uncovered are the ranges intersecting the selection,
+    // clipped to it
+    if (feed.notify){
+        for (auto&& range : makeView(startIter, endIter, start, end)){
+            feed.notify(Change::Uncovered, range.first, range.second);
+        }
+    }
     // if "end" is less than every range in the table
     // this range is before the beginning, 
     // so there is nothing to do but return
     if (endIter == table.end()){
-        return;
+        return endIter;
     }
     // only try to delete if there exist ranges between "start" and "end"
     // if startIter == endIter and start > startIter->second, that means
     // "start" and "end" are between ranges, so nothing needs to be done
     if ((startIter == endIter && start <= startIter->second) || startIter != endIter){
         // store the start and end points of the ranges that "start" and "end" point to
-        int oldStart = startIter->first;
-        int oldEnd = endIter->second;
+        // if "start" is before every range, there is no range for it to point to
+        Key oldStart = (startIter != table.end()) ? startIter->first : start;
+        Key oldEnd = endIter->second;
         // erase every interval between and including the ones containing "start" and "end"
         // only include "start" if lies in an existing range
         // need to create a temporary iterator and increment it in order 
@@ -104,18 +259,21 @@ void Range::Delete(int start, int end){
         if (vt != table.end() && start < vt->second){
             vt++;
         }
-        table.erase(endIter, vt);
+        auto next = table.erase(endIter, vt);
         // then if "start" isn't on the boundary, i.e. not the same as the old range's start  
         // then insert a range from the old range's start to "start"
-        if (start != oldStart && startIter != table.end()){
-            table.insert(std::make_pair(oldStart, start));
+        // each remaining piece goes right where the deleted ranges used to be
+        if (start != oldStart){
+            next = table.insert(next, std::make_pair(oldStart, start));
         }
         // likewise, if "end" existed in the old range
         // then insert a range from "end" to the old range's end
         if (end < oldEnd){
-            table.insert(std::make_pair(end, oldEnd));
+            next = table.insert(next, std::make_pair(end, oldEnd));
         }
+        return next;
     }
+    return startIter;
 }
 
 /*
@@ -126,42 +284,796 @@ void Range::Delete(int start, int end){
     end: The end of the selection range
     Time Complexity: O(n)
 */
-std::vector<std::pair<int, int>> Range::Get(int start, int end){
-    // need to go through the map in reverse because of how it's organized
-    auto startIter = table.lower_bound(start);
-    auto endIter = table.lower_bound(end);
+template <typename Key, typename Allocator>
+std::vector<std::pair<Key, Key>> BasicRange<Key, Allocator>::Get(Key start, Key end) const{
+#ifdef RANGE_STATS
+    ScopedLatency latency(stats.getLatency);
+    stats.gets++;
+#endif
+    std::vector<std::pair<Key, Key>> ret;
+    // copy the ranges on this thread up to the threshold, so narrow
+    // selections never pay for starting threads
+    View view = GetView(start, end);
+    auto iter = view.begin();
+    for (; iter != view.end() && ret.size() < parallelThreshold; ++iter){
+        ret.push_back(*iter);
+    }
+    if (iter != view.end()){
+        getParallel(iter.base(), view.end().base(), start, end, ret);
+    }
+#ifdef RANGE_STATS
+    stats.returned += ret.size();
+    stats.maxReturned.Raise(ret.size());
+#endif
+    // return the list of ranges
+    return ret;
+}
+
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::SetParallelGet(std::size_t threshold, std::size_t threads){
+    parallelThreshold = threshold;
+    parallelThreads = threads;
+}
+
+/*
+    Appends the ranges from "from" up to "last" to "ret", clipped to the selection,
+    with several threads
+    std::map can't be split by position without walking it, so the keys from
+    the start of "from" to "end" are cut into several chunks per thread
+    instead, and each range goes to the chunk its start point falls in, so no
+    range is ever split between chunks. The threads take chunks one at a time
+    until there are none left, so that a dense chunk doesn't hold up the rest,
+    and copy them into buffers of their own. Once every thread is done copying,
+    the calling thread works out where each buffer goes in the result, and the
+    same threads move the buffers there, so each Get starts its threads only once.
+    If a thread can't be started, the ones that were share the chunks.
+    An exception thrown while copying, such as running out of memory, stops the
+    threads taking more chunks, and is rethrown on the calling thread once they
+    have all finished.
+    Only reads the map, which std::map allows from several threads at once.
+
+    Time Complexity: O(logn * c + k / t), c being the number of chunks,
+    k the number of ranges and t the number of threads
+*/
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::getParallel(typename Table::const_reverse_iterator from,
+    typename Table::const_reverse_iterator last, Key start, Key end, std::vector<std::pair<Key, Key>>& ret) const{
+    auto clip = [&](typename Table::const_reverse_iterator iter){
+        return std::make_pair(iter->first < start ? start : iter->first, iter->second > end ? end : iter->second);
+    };
+    std::size_t threads = parallelThreads != 0 ? parallelThreads : std::thread::hardware_concurrency();
+    if (threads <= 1){
+        for (; from != last; ++from){
+            ret.push_back(clip(from));
+        }
+        return;
+    }
+    // a few chunks per thread keeps them all busy when the ranges are spread unevenly
+    std::size_t chunks = threads * 4;
+    // unsigned arithmetic gives the right distance even when it overflows Key,
+    // and splitting the multiplication keeps it from overflowing Length
+    Length width = static_cast<Length>(end) - static_cast<Length>(from->first);
+    std::vector<typename Table::const_reverse_iterator> bounds(chunks + 1);
+    bounds[0] = from;
+    bounds[chunks] = last;
+    for (std::size_t i = 1; i < chunks; i++){
+        Length offset = width / chunks * i + width % chunks * i / chunks;
+        Key cut = static_cast<Key>(static_cast<Length>(from->first) + offset);
+        // the range with the smallest start point at or after "cut"
+        bounds[i] = typename Table::const_reverse_iterator(table.upper_bound(cut));
+    }
+    std::vector<std::vector<std::pair<Key, Key>>> buffers(chunks);
+    std::vector<std::size_t> offsets(chunks + 1, ret.size());
+    std::atomic<std::size_t> nextCopy(0);
+    std::atomic<std::size_t> nextMove(0);
+    // guards everything below
+    std::mutex lock;
+    // signalled when a thread is done copying, and when the result is laid out
+    std::condition_variable progress;
+    std::size_t copied = 0;
+    bool placed = false;
+    // the first exception thrown by any of the threads
+    std::exception_ptr failure;
+    auto copyChunks = [&](){
+        try {
+            for (std::size_t i = nextCopy++; i < chunks; i = nextCopy++){
+                for (auto iter = bounds[i]; iter != bounds[i + 1]; ++iter){
+                    buffers[i].push_back(clip(iter));
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!failure){
+                failure = std::current_exception();
+            }
+            // the result is lost anyway, so leave the remaining chunks be
+            nextCopy = chunks;
+        }
+    };
+    auto moveChunks = [&](){
+        for (std::size_t i = nextMove++; i < chunks; i = nextMove++){
+            std::copy(buffers[i].begin(), buffers[i].end(), ret.begin() + offsets[i]);
+            // free each buffer as soon as it is copied, rather than holding twice the result
+            std::vector<std::pair<Key, Key>>().swap(buffers[i]);
+        }
+    };
+    auto helper = [&](){
+        copyChunks();
+        std::unique_lock<std::mutex> guard(lock);
+        copied++;
+        progress.notify_all();
+        progress.wait(guard, [&](){ return placed; });
+        bool failed = failure != nullptr;
+        guard.unlock();
+        if (!failed){
+            moveChunks();
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (std::size_t i = 1; i < threads; i++){
+        try {
+            pool.emplace_back(helper);
+        } catch (const std::system_error&) {
+            break;
+        }
+    }
+    copyChunks();
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        progress.wait(guard, [&](){ return copied == pool.size(); });
+        if (!failure){
+            try {
+                for (std::size_t i = 0; i < chunks; i++){
+                    offsets[i + 1] = offsets[i] + buffers[i].size();
+                }
+                ret.resize(offsets[chunks]);
+            } catch (...) {
+                failure = std::current_exception();
+            }
+        }
+        placed = true;
+    }
+    progress.notify_all();
+    // only written before "placed" was set, so it can be read without the lock
+    if (!failure){
+        moveChunks();
+    }
+    for (auto&& thread : pool){
+        thread.join();
+    }
+    if (failure){
+        std::rethrow_exception(failure);
+    }
+}
+
+/*
+    Returns a lazy view of the ranges that exist within the data structure
+    that intersect with the selection range, each clipped to the selection.
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn)
+*/
+template <typename Key, typename Allocator>
+typename BasicRange<Key, Allocator>::View BasicRange<Key, Allocator>::GetView(Key start, Key end) const{
+    return makeView(table.lower_bound(start), table.lower_bound(end), start, end);
+}
+
+/*
+    Writes up to "capacity" of the ranges that exist within the data structure
+    that intersect with the selection range into "buffer"
+    Returns the total number of intersecting ranges
+
+    start: The start of the selection range
+    end: The end of the selection range
+    buffer: Array to write the ranges to
+    capacity: Number of ranges "buffer" can hold
+    Time Complexity: O(logn + k), k being the number of intersecting ranges
+*/
+template <typename Key, typename Allocator>
+std::size_t BasicRange<Key, Allocator>::Get(Key start, Key end, std::pair<Key, Key>* buffer, std::size_t capacity) const{
+    std::size_t count = 0;
+    for (auto&& range : GetView(start, end)){
+        if (count < capacity){
+            buffer[count] = range;
+        }
+        count++;
+    }
+    return count;
+}
+
+/*
+    Returns whether "point" is covered by a range in the data structure
+
+    point: The point to look for
+    Time Complexity: O(logn)
+*/
+template <typename Key, typename Allocator>
+bool BasicRange<Key, Allocator>::Contains(Key point) const{
+    // the map is in reverse, so this is the range with the largest start at or before "point"
+    auto iter = table.lower_bound(point);
+    return iter != table.end() && point < iter->second;
+}
+
+/*
+    Returns the number of points in the selection range covered by the data structure
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn + k), k being the number of ranges intersecting the selection
+*/
+template <typename Key, typename Allocator>
+typename BasicRange<Key, Allocator>::Length BasicRange<Key, Allocator>::CoveredLength(Key start, Key end) const{
+    Length length = 0;
+    for (auto&& range : GetView(start, end)){
+        // unsigned subtraction gives the right distance even when it overflows Key
+        length += static_cast<Length>(range.second) - static_cast<Length>(range.first);
+    }
+    return length;
+}
+
+/*
+    Returns the number of ranges intersecting the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn + k), k being the number of ranges intersecting the selection
+*/
+template <typename Key, typename Allocator>
+std::size_t BasicRange<Key, Allocator>::CountIntervals(Key start, Key end) const{
+    View view = GetView(start, end);
+    return std::distance(view.begin(), view.end());
+}
+
+/*
+    Returns the first point at or after "point" that isn't covered
+
+    point: The point to start looking from
+    Time Complexity: O(logn)
+*/
+template <typename Key, typename Allocator>
+Key BasicRange<Key, Allocator>::NextGap(Key point) const{
+    // ranges never touch, so the end of the range covering "point" is never covered
+    auto iter = table.lower_bound(point);
+    if (iter != table.end() && point < iter->second){
+        return iter->second;
+    }
+    return point;
+}
+
+/*
+    Returns the first point at or after "point" that is covered,
+    or nothing if there are no ranges from there on
+
+    point: The point to start looking from
+    Time Complexity: O(logn)
+*/
+template <typename Key, typename Allocator>
+std::optional<Key> BasicRange<Key, Allocator>::FirstCovered(Key point) const{
+    auto iter = table.lower_bound(point);
+    if (iter != table.end() && point < iter->second){
+        return point;
+    }
+    // the map is in reverse, so the next range up is the one before
+    if (iter == table.begin()){
+        return std::nullopt;
+    }
+    return std::prev(iter)->first;
+}
+
+/*
+    Builds the view of the ranges intersecting the selection range, given
+    startIter = table.lower_bound(start) and endIter = table.lower_bound(end)
+    The view walks the map in reverse, from the first range intersecting the
+    selection up to (but not including) the first range starting at or after "end"
+*/
+template <typename Key, typename Allocator>
+typename BasicRange<Key, Allocator>::View BasicRange<Key, Allocator>::makeView(typename Table::const_iterator startIter,
+    typename Table::const_iterator endIter, Key start, Key end) const{
+    // an empty selection can't intersect anything
+    if (start >= end){
+        return View(ClippedIterator(table.rend(), start, end), ClippedIterator(table.rend(), start, end));
+    }
+    // a reverse iterator built from an iterator refers to the range before it
+    // in the map, i.e. the one with the next largest start point
+    // if "start" lies in the range startIter points to, the view begins there,
+    // otherwise it begins at the next range
+    typename Table::const_reverse_iterator first(startIter);
+    if (startIter != table.end() && start < startIter->second){
+        first = typename Table::const_reverse_iterator(std::next(startIter));
+    }
+    // likewise the view ends after the range endIter points to, unless
+    // said range starts exactly at "end", in which case it lies outside the selection
+    typename Table::const_reverse_iterator last(endIter);
+    if (endIter != table.end() && endIter->first == end){
+        last = typename Table::const_reverse_iterator(std::next(endIter));
+    }
+    return View(ClippedIterator(first, start, end), ClippedIterator(last, start, end));
+}
+
+/*
+    Returns table.lower_bound(key), searching forward from "from" instead of
+    from the root when the answer is at most "maxSteps" ranges away
+    "from" must be table.lower_bound of a value less than or equal to "key"
+    Time Complexity: O(1) when the answer is nearby, O(logn) otherwise
+*/
+template <typename Key, typename Allocator>
+typename BasicRange<Key, Allocator>::Table::iterator BasicRange<Key, Allocator>::seek(typename Table::iterator from, Key key,
+    int maxSteps){
+    return seekIn(table, from, key, maxSteps);
+}
+
+template <typename Key, typename Allocator>
+typename BasicRange<Key, Allocator>::Table::const_iterator BasicRange<Key, Allocator>::seek(typename Table::const_iterator from,
+    Key key, int maxSteps) const{
+    return seekIn(table, from, key, maxSteps);
+}
 
-    std::vector<std::pair<int, int>> ret;
-    // if they're both part of the same range
-    if (startIter == endIter){
-        // if "start" lies in the range,
-        // then there is something to return
-        // otherwise there is nothing
-        if (startIter != table.end() && start < startIter->second){
-            ret.push_back(std::make_pair(start, std::min(end, startIter->second)));
+template <typename Key, typename Allocator>
+template <typename Map, typename Iterator>
+Iterator BasicRange<Key, Allocator>::seekIn(Map& table, Iterator from, Key key, int maxSteps){
+    // the map is in reverse, so the ranges with larger start points
+    // are found by decrementing the iterator
+    // give up and search from the root if the answer is too far away
+    for (int step = 0; step < maxSteps; step++){
+        if (from == table.begin()){
+            return from;
         }
-    // otherwise "start" and "end" lie in different ranges
+        auto next = std::prev(from);
+        if (next->first > key){
+            return from;
+        }
+        from = next;
+    }
+    return table.lower_bound(key);
+}
+
+/*
+    Sorts a list of ranges by start point, drops empty ones and merges the
+    ones that overlap or touch, so that the result is a sorted list of
+    disjoint ranges covering exactly the same points.
+    Used to prepare the input of the batch functions and bulk constructors.
+
+    ranges: The list of ranges to coalesce
+    Time Complexity: O(klogk), k being the number of ranges
+*/
+template <typename Key>
+std::vector<std::pair<Key, Key>> coalesce(std::vector<std::pair<Key, Key>> ranges){
+#ifdef RANGE_PARALLEL_SORT
+    // starting the threads costs more than sorting a short list
+    if (ranges.size() >= 65536){
+        std::sort(std::execution::par, ranges.begin(), ranges.end());
     } else {
-        // first account for the range that startIter points to,
-        // if "start" lies in said range, add the interval from "start" to
-        // the end of said range to our return list 
-        auto iter = startIter;
-        if (start < iter->second && iter != table.end()){
-            ret.push_back(std::make_pair(start, iter->second));
-        }
-        iter--;
-        // add add the ranges that lie between "start" and "end" to the return list,
-        // excluding the ranges that startIter and endIter point to
-        for (; iter != endIter; iter--){
-            ret.push_back(std::make_pair(iter->first, iter->second));
-        }
-        // now add the range that endIter points to
-        // the end of this added range is the minimum of "end" and its own end
-        ret.push_back(std::make_pair(iter->first, std::min(iter->second, end)));
+        std::sort(ranges.begin(), ranges.end());
+    }
+#else
+    std::sort(ranges.begin(), ranges.end());
+#endif
+    std::size_t kept = 0;
+    for (auto&& range : ranges){
+        if (range.first >= range.second){
+            continue;
+        }
+        // extend the previous range if this one overlaps or touches it
+        if (kept > 0 && range.first <= ranges[kept - 1].second){
+            ranges[kept - 1].second = std::max(ranges[kept - 1].second, range.second);
+        } else {
+            ranges[kept++] = range;
+        }
+    }
+    ranges.resize(kept);
+    return ranges;
+}
+
+/*
+    Adds every range in the list to the data structure.
+    Gives the same result as calling Add on each of them one at a time,
+    but sorts and coalesces them first, then applies them in a single
+    forward pass over the existing ranges instead of searching the
+    tree from the root for each one.
+
+    ranges: The list of selection ranges, in any order
+    Time Complexity: O(klogk + min(klogn, k + n)), k being the number of ranges in the list
+*/
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::AddBatch(const std::vector<std::pair<Key, Key>>& ranges){
+    // table.end() is where a search for a value below every range ends up,
+    // so it is a valid place to start searching for anything
+    auto cursor = table.end();
+    std::vector<std::pair<Key, Key>> sorted = coalesce(ranges);
+    int steps = seekSteps(sorted.size());
+    for (auto&& range : sorted){
+        auto startIter = seek(cursor, range.first, steps);
+        auto endIter = seek(startIter, range.second);
+        cursor = addAt(startIter, endIter, range.first, range.second);
+    }
+}
+
+/*
+    Removes every range in the list from the data structure.
+    Gives the same result as calling Delete on each of them one at a time,
+    in a single forward pass like AddBatch.
+
+    ranges: The list of selection ranges, in any order
+    Time Complexity: O(klogk + min(klogn, k + n)), k being the number of ranges in the list
+*/
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::DeleteBatch(const std::vector<std::pair<Key, Key>>& ranges){
+    auto cursor = table.end();
+    std::vector<std::pair<Key, Key>> sorted = coalesce(ranges);
+    int steps = seekSteps(sorted.size());
+    for (auto&& range : sorted){
+        auto startIter = seek(cursor, range.first, steps);
+        auto endIter = seek(startIter, range.second);
+        cursor = deleteAt(startIter, endIter, range.first, range.second);
+    }
+}
+
+/*
+    Calls Get on every selection range in the list, visiting them
+    in order of start point in a single forward pass.
+    Returns one list of ranges per selection range, in the order given.
+
+    ranges: The list of selection ranges, in any order
+    Time Complexity: O(klogk + min(klogn, k + n) + r), k being the number of
+    ranges in the list and r the number of ranges returned
+*/
+template <typename Key, typename Allocator>
+std::vector<std::vector<std::pair<Key, Key>>> BasicRange<Key, Allocator>::GetBatch(const std::vector<std::pair<Key, Key>>& ranges) const{
+    std::vector<std::vector<std::pair<Key, Key>>> ret(ranges.size());
+    // the selections may overlap, so they can't be coalesced,
+    // but visiting them in order of start point still lets each search
+    // resume from where the previous one began
+    std::vector<std::size_t> order(ranges.size());
+    for (std::size_t i = 0; i < order.size(); i++){
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b){
+        return ranges[a].first < ranges[b].first;
+    });
+    auto cursor = table.end();
+    for (std::size_t i : order){
+        Key start = ranges[i].first;
+        Key end = ranges[i].second;
+        if (start >= end){
+            continue;
+        }
+        cursor = seek(cursor, start);
+        for (auto&& range : makeView(cursor, seek(cursor, end), start, end)){
+            ret[i].push_back(range);
+        }
     }
-    // return the list of ranges
     return ret;
-    
+}
+
+/*
+    Walks two lists of disjoint, non-touching ranges in increasing order at once,
+    calling "emit" with every maximal run of points for which "keep" holds
+    Moves from one edge (the start or end of a range in either list) to the next,
+    keeping track of whether each list covers the points after it
+    Time Complexity: O(n + m)
+*/
+template <typename Key, typename Allocator>
+template <typename First, typename Second, typename Keep, typename Emit>
+void BasicRange<Key, Allocator>::merge(First&& nextFirst, Second&& nextSecond, Keep keep, Emit&& emit){
+    std::pair<Key, Key> first = std::make_pair(Key(), Key());
+    std::pair<Key, Key> second = std::make_pair(Key(), Key());
+    bool hasFirst = nextFirst(first);
+    bool hasSecond = nextSecond(second);
+    bool inFirst = false;
+    bool inSecond = false;
+    Key keptFrom = Key();
+    while (hasFirst || hasSecond){
+        Key firstEdge = inFirst ? first.second : first.first;
+        Key secondEdge = inSecond ? second.second : second.first;
+        Key edge = (hasFirst && (!hasSecond || firstEdge < secondEdge)) ? firstEdge : secondEdge;
+        bool kept = keep(inFirst, inSecond);
+        // ranges within a list never touch, so each list
+        // enters or leaves at most one range at any edge
+        if (hasFirst && firstEdge == edge){
+            inFirst = !inFirst;
+            if (!inFirst){
+                hasFirst = nextFirst(first);
+            }
+        }
+        if (hasSecond && secondEdge == edge){
+            inSecond = !inSecond;
+            if (!inSecond){
+                hasSecond = nextSecond(second);
+            }
+        }
+        bool keeping = keep(inFirst, inSecond);
+        if (!kept && keeping){
+            keptFrom = edge;
+        } else if (kept && !keeping){
+            emit(keptFrom, edge);
+        }
+    }
+}
+
+namespace {
+    /*
+        Returns a callable reading the ranges of "table" in increasing order, for merge
+    */
+    template <typename Table, typename Key>
+    auto readRanges(const Table& table){
+        return [iter = table.rbegin(), end = table.rend()](std::pair<Key, Key>& next) mutable{
+            if (iter == end){
+                return false;
+            }
+            next = *iter++;
+            return true;
+        };
+    }
+
+    /*
+        Returns a callable appending ranges in increasing order to "table", for merge
+    */
+    template <typename Table, typename Key>
+    auto appendRanges(Table& table){
+        return [&table](Key start, Key end){
+            // the map is in decreasing order, so each new range goes first
+            table.emplace_hint(table.begin(), start, end);
+        };
+    }
+}
+
+/*
+    Returns a new set holding the points for which "keep" holds,
+    given whether they are in this set and in "other"
+    Time Complexity: O(n + m)
+*/
+template <typename Key, typename Allocator>
+template <typename Keep>
+BasicRange<Key, Allocator> BasicRange<Key, Allocator>::combine(const BasicRange& other, Keep keep) const{
+    BasicRange result(std::allocator_traits<Allocator>::select_on_container_copy_construction(table.get_allocator()));
+    merge(readRanges<Table, Key>(table), readRanges<Table, Key>(other.table), keep,
+        appendRanges<Table, Key>(result.table));
+    return result;
+}
+
+/*
+    Flips every point from "start" to "end"
+    Adds the whole range, merging it with the ranges it overlaps or touches,
+    then deletes the pieces of it that were covered before, one after the other
+    out of the merged range. Each deletion leaves the rest of the merged range
+    as the range holding the next piece, so none of them has to search
+    The subscriber is told about the gaps and pieces in one walk from "start" to "end",
+    rather than by addAt and deleteAt, which would report all of the gaps first
+*/
+template <typename Key, typename Allocator>
+typename BasicRange<Key, Allocator>::Table::iterator BasicRange<Key, Allocator>::toggleAt(typename Table::iterator from,
+    Key start, Key end, std::vector<std::pair<Key, Key>>& pieces){
+    auto startIter = seek(from, start);
+    auto endIter = seek(startIter, end);
+    pieces.clear();
+    for (auto&& piece : makeView(startIter, endIter, start, end)){
+        pieces.push_back(piece);
+    }
+    if (feed.notify){
+        Key gap = start;
+        for (auto&& piece : pieces){
+            if (gap < piece.first){
+                feed.notify(Change::Covered, gap, piece.first);
+            }
+            feed.notify(Change::Uncovered, piece.first, piece.second);
+            gap = piece.second;
+        }
+        if (gap < end){
+            feed.notify(Change::Covered, gap, end);
+        }
+    }
+    // detached while modifying, so that the changes aren't reported twice
+    Subscriber notify = std::move(feed.notify);
+    feed.notify = nullptr;
+    auto cursor = table.end();
+    try {
+        cursor = addAt(startIter, endIter, start, end);
+        for (auto&& piece : pieces){
+            cursor = deleteAt(cursor, cursor, piece.first, piece.second);
+        }
+    } catch (...) {
+        feed.notify = std::move(notify);
+        throw;
+    }
+    feed.notify = std::move(notify);
+    return cursor;
+}
+
+/*
+    Removes every range, telling the subscriber about each of them
+    in increasing order
+*/
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::clearTable(){
+    if (feed.notify){
+        for (auto iter = table.rbegin(); iter != table.rend(); iter++){
+            feed.notify(Change::Uncovered, iter->first, iter->second);
+        }
+    }
+    table.clear();
+}
+
+/*
+    Returns the points in this set, in "other", or in both
+    Time Complexity: O(n + m), m being the number of ranges in "other"
+*/
+template <typename Key, typename Allocator>
+BasicRange<Key, Allocator> BasicRange<Key, Allocator>::Union(const BasicRange& other) const{
+    return combine(other, [](bool inThis, bool inOther){ return inThis || inOther; });
+}
+
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::UnionWith(const BasicRange& other){
+    // the ranges of "other" are sorted and disjoint already,
+    // so this is AddBatch without the sorting
+    auto cursor = table.end();
+    for (auto iter = other.table.rbegin(); iter != other.table.rend(); iter++){
+        auto startIter = seek(cursor, iter->first);
+        auto endIter = seek(startIter, iter->second);
+        cursor = addAt(startIter, endIter, iter->first, iter->second);
+    }
+}
+
+/*
+    Returns the points in both this set and "other"
+    Time Complexity: O(n + m), m being the number of ranges in "other"
+*/
+template <typename Key, typename Allocator>
+BasicRange<Key, Allocator> BasicRange<Key, Allocator>::Intersect(const BasicRange& other) const{
+    return combine(other, [](bool inThis, bool inOther){ return inThis && inOther; });
+}
+
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::IntersectWith(const BasicRange& other){
+    if (&other == this){
+        return;
+    }
+    // delete the gaps between the ranges of "other", and everything around them
+    auto cursor = table.end();
+    Key from = std::numeric_limits<Key>::lowest();
+    for (auto iter = other.table.rbegin(); iter != other.table.rend(); iter++){
+        if (from < iter->first){
+            auto startIter = seek(cursor, from);
+            auto endIter = seek(startIter, iter->first);
+            cursor = deleteAt(startIter, endIter, from, iter->first);
+        }
+        from = iter->second;
+    }
+    // the largest value of Key can't be covered, so this is everything above "from"
+    Key highest = std::numeric_limits<Key>::max();
+    if (from < highest){
+        auto startIter = seek(cursor, from);
+        deleteAt(startIter, seek(startIter, highest), from, highest);
+    }
+}
+
+/*
+    Returns the points in this set that aren't in "other"
+    Time Complexity: O(n + m), m being the number of ranges in "other"
+*/
+template <typename Key, typename Allocator>
+BasicRange<Key, Allocator> BasicRange<Key, Allocator>::Difference(const BasicRange& other) const{
+    return combine(other, [](bool inThis, bool inOther){ return inThis && !inOther; });
+}
+
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::DifferenceWith(const BasicRange& other){
+    if (&other == this){
+        clearTable();
+        return;
+    }
+    auto cursor = table.end();
+    for (auto iter = other.table.rbegin(); iter != other.table.rend(); iter++){
+        auto startIter = seek(cursor, iter->first);
+        auto endIter = seek(startIter, iter->second);
+        cursor = deleteAt(startIter, endIter, iter->first, iter->second);
+    }
+}
+
+/*
+    Returns the points in exactly one of this set and "other"
+    Time Complexity: O(n + m), m being the number of ranges in "other"
+*/
+template <typename Key, typename Allocator>
+BasicRange<Key, Allocator> BasicRange<Key, Allocator>::SymmetricDifference(const BasicRange& other) const{
+    return combine(other, [](bool inThis, bool inOther){ return inThis != inOther; });
+}
+
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::SymmetricDifferenceWith(const BasicRange& other){
+    if (&other == this){
+        clearTable();
+        return;
+    }
+    std::vector<std::pair<Key, Key>> pieces;
+    auto cursor = table.end();
+    for (auto iter = other.table.rbegin(); iter != other.table.rend(); iter++){
+        cursor = toggleAt(cursor, iter->first, iter->second, pieces);
+    }
+}
+
+/*
+    Returns the points from "start" to "end" that aren't in this set
+    The bounds are merged as a list holding a single range, against
+    the ranges of this set clipped to the bounds
+
+    start: The start of the bounds
+    end: The end of the bounds
+    Time Complexity: O(logn + k), k being the number of ranges within the bounds
+*/
+template <typename Key, typename Allocator>
+BasicRange<Key, Allocator> BasicRange<Key, Allocator>::Complement(Key start, Key end) const{
+    BasicRange result(std::allocator_traits<Allocator>::select_on_container_copy_construction(table.get_allocator()));
+    if (start >= end){
+        return result;
+    }
+    bool given = false;
+    auto bounds = [&](std::pair<Key, Key>& next){
+        next = std::make_pair(start, end);
+        return !std::exchange(given, true);
+    };
+    View view = GetView(start, end);
+    auto covered = [iter = view.begin(), last = view.end()](std::pair<Key, Key>& next) mutable{
+        if (iter == last){
+            return false;
+        }
+        next = *iter++;
+        return true;
+    };
+    merge(bounds, covered, [](bool inBounds, bool inThis){ return inBounds && !inThis; },
+        appendRanges<Table, Key>(result.table));
+    return result;
+}
+
+/*
+    Replaces this set with the points from "start" to "end" that aren't in it
+
+    start: The start of the bounds
+    end: The end of the bounds
+    Time Complexity: O(logn + k), k being the number of ranges within the bounds,
+    plus the number of ranges dropped
+*/
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::ComplementWithin(Key start, Key end){
+    if (start >= end){
+        clearTable();
+        return;
+    }
+    // drop everything below the bounds, flip everything within them, then drop
+    // everything above them, so that the subscriber hears about them in order
+    Delete(std::numeric_limits<Key>::lowest(), start);
+    std::vector<std::pair<Key, Key>> pieces;
+    toggleAt(table.end(), start, end, pieces);
+    Delete(end, std::numeric_limits<Key>::max());
+}
+
+template <typename Key, typename Allocator>
+RangeStats BasicRange<Key, Allocator>::Stats() const{
+#ifdef RANGE_STATS
+    RangeStats ret = stats.Load();
+    ret.size = table.size();
+    // a red-black tree with n nodes is at most 2log(n + 1) high
+    for (std::size_t n = table.size() + 1; n > 1; n >>= 1){
+        ret.depth += 2;
+    }
+    return ret;
+#else
+    return RangeStats();
+#endif
+}
+
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::ResetStats(){
+#ifdef RANGE_STATS
+    stats = RangeCounters();
+#endif
+}
+
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::Subscribe(Subscriber subscriber){
+    feed.notify = std::move(subscriber);
 }
 
 /*
@@ -169,7 +1081,8 @@ std::vector<std::pair<int, int>> Range::Get(int start, int end){
     Returns nothing, but prints to stdout.
     Used for Debugging.
 */ 
-void Range::printAll() const{
+template <typename Key, typename Allocator>
+void BasicRange<Key, Allocator>::printAll() const{
     for (auto&& elem : table){
         std::cout << elem.second << ", " << elem.first << ", ";
     }
@@ -182,12 +1095,32 @@ void Range::printAll() const{
     Returns a list in reverse order.
     Used for Testcase Verification.
 */ 
-#include <vector>
-std::vector<int> Range::toVec() const{
-    std::vector<int> vec;
+template <typename Key, typename Allocator>
+std::vector<Key> BasicRange<Key, Allocator>::toVec() const{
+    std::vector<Key> vec;
     for (auto&& elem : table){
         vec.push_back(elem.second);
         vec.push_back(elem.first);
     }
     return vec;
-}
\ No newline at end of file
+}
+
+// the coordinate types the module is built for
+// 32 bit coordinates keep each node of the map as small as possible,
+// 64 bit coordinates are there for sets that don't fit in 32 bits
+template class BasicRange<std::int32_t>;
+template class BasicRange<std::int64_t>;
+template class BasicRange<std::uint64_t>;
+// and the same with their nodes drawn from a pool
+template class BasicRange<std::int32_t, PoolAllocator<std::pair<const std::int32_t, std::int32_t>>>;
+template class BasicRange<std::int64_t, PoolAllocator<std::pair<const std::int64_t, std::int64_t>>>;
+template class BasicRange<std::uint64_t, PoolAllocator<std::pair<const std::uint64_t, std::uint64_t>>>;
+// vectors of sets only move them while they grow if moving can't throw;
+// PoolAllocator moves without throwing and still leaves the set moved from a pool of its own
+static_assert(std::is_nothrow_move_constructible<Range>::value && std::is_nothrow_move_assignable<Range>::value,
+    "moving a Range must not throw");
+static_assert(std::is_nothrow_move_constructible<PooledRange>::value && std::is_nothrow_move_assignable<PooledRange>::value,
+    "moving a PooledRange must not throw");
+template std::vector<std::pair<std::int32_t, std::int32_t>> coalesce(std::vector<std::pair<std::int32_t, std::int32_t>>);
+template std::vector<std::pair<std::int64_t, std::int64_t>> coalesce(std::vector<std::pair<std::int64_t, std::int64_t>>);
+template std::vector<std::pair<std::uint64_t, std::uint64_t>> coalesce(std::vector<std::pair<std::uint64_t, std::uint64_t>>);
@@ -1,20 +1,272 @@
 #ifndef _RANGE_H_
 #define _RANGE_H_
 
+#include "PoolAllocator.h"
+#include "RangeStats.h"
 #include <map>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-class Range
+/*
+    Sorts a list of ranges by start point, drops empty ones and merges the
+    ones that overlap or touch, so that the result is a sorted list of
+    disjoint ranges covering exactly the same points.
+    Used to prepare the input of the batch functions and bulk constructors.
+    Sorts long lists in parallel when built with RANGE_PARALLEL_SORT defined.
+
+    ranges: The list of ranges to coalesce
+    Time Complexity: O(klogk), k being the number of ranges
+*/
+template <typename Key>
+std::vector<std::pair<Key, Key>> coalesce(std::vector<std::pair<Key, Key>>);
+
+/*
+    Tag selecting the bulk constructors whose input is already sorted by start point,
+    as in Range(SortedRanges, first, last)
+*/
+struct SortedRangesTag {};
+inline constexpr SortedRangesTag SortedRanges{};
+
+/*
+    Set of ranges over the coordinate type "Key", where a range from "start" to "end"
+    covers every point x with start <= x < end.
+    Any integral type can be used as "Key", but the definitions are only built for
+    std::int32_t, std::int64_t and std::uint64_t (see the bottom of Range.cpp).
+    Range is the 32 bit instantiation, BasicRange<std::int32_t>.
+
+    "Allocator" allocates the nodes of the underlying std::map. The definitions are
+    built for std::allocator and for PoolAllocator (see PoolAllocator.h), which
+    recycles the nodes of erased ranges instead of returning them to the heap;
+    PooledRange is the 32 bit instantiation using it.
+
+    The functions only ever compare coordinates and never compute anything from them
+    (such as end - 1), so they are safe to use right up to the limits of "Key".
+    The one exception is CoveredLength, which subtracts them as Length, the unsigned
+    counterpart of "Key", where the distance between any two coordinates fits.
+    Since ranges are half open, the largest value of "Key" itself can never be covered.
+
+    Defining RANGE_STATS when building makes Add, Delete and Get keep counters and
+    latency histograms, read through Stats. It changes the layout of the class,
+    so it must be defined for every file of the program or for none of them.
+*/
+template <typename Key, typename Allocator = std::allocator<std::pair<const Key, Key>>>
+class BasicRange
 {
 private:
+    typedef std::map<Key, Key, std::greater<Key>, Allocator> Table;
+
     // the map used to contain information about ranges
     // each key maps to a given range's start and the corresponding value
     // maps to said range's end
-    std::map<int, int, std::greater<int>> table;
+    Table table;
+
+    /*
+        The bodies of Add and Delete, given the ranges found by searching
+        for "start" and "end" (i.e. table.lower_bound(start) and table.lower_bound(end))
+        Both return the range around "end" after the modification,
+        which the batch functions resume searching from
+    */
+    typename Table::iterator addAt(typename Table::iterator, typename Table::iterator, Key, Key);
+    typename Table::iterator deleteAt(typename Table::iterator, typename Table::iterator, Key, Key);
+
+    /*
+        Returns table.lower_bound(key), searching forward from "from" instead of
+        from the root when the answer is at most "maxSteps" ranges away
+        "from" must be table.lower_bound of a value less than or equal to "key"
+        The const overload lets the queries resume searches too
+    */
+    typename Table::iterator seek(typename Table::iterator, Key, int maxSteps = 8);
+    typename Table::const_iterator seek(typename Table::const_iterator, Key, int maxSteps = 8) const;
+
+    /*
+        The body of both overloads of seek, for "table" and its iterators,
+        whether they are const or not
+    */
+    template <typename Map, typename Iterator>
+    static Iterator seekIn(Map& table, Iterator, Key, int maxSteps);
+
+    /*
+        Returns how many ranges seek should step over before searching from the root,
+        when moving from one of "count" sorted selections to the next
+        Once the selections are spread thinner than that, the next one is hardly
+        ever close enough, so stepping would only add cache misses to the search
+    */
+    int seekSteps(std::size_t count) const { return count * 8 >= table.size() ? 8 : 0; }
+
+    /*
+        Walks two lists of disjoint, non-touching ranges in increasing order at once,
+        calling "emit" with the start and end of every maximal run of points for
+        which "keep(inFirst, inSecond)" holds, in increasing order
+        Each list is read through a callable that stores the next range in its
+        argument and returns true, or returns false once the list is exhausted
+        "keep(false, false)" must be false
+        Time Complexity: O(n + m)
+    */
+    template <typename First, typename Second, typename Keep, typename Emit>
+    static void merge(First&& nextFirst, Second&& nextSecond, Keep keep, Emit&& emit);
+
+    /*
+        Returns a new set holding the points for which "keep" holds,
+        given whether they are in this set and in "other"
+        Time Complexity: O(n + m)
+    */
+    template <typename Keep>
+    BasicRange combine(const BasicRange& other, Keep keep) const;
+
+    /*
+        Flips every point from "start" to "end", so that the points that were in
+        the set are removed and the ones that weren't are added, given a range
+        "from" that seek can search forward from
+        Returns a range that later searches for values above "end" can resume from
+        "pieces" is used as scratch space
+    */
+    typename Table::iterator toggleAt(typename Table::iterator, Key, Key, std::vector<std::pair<Key, Key>>&);
+
+    /*
+        Appends ranges sorted by start point to an empty table, coalescing them as
+        they are read, for the bulk constructors
+    */
+    template <typename InputIt>
+    void appendSorted(InputIt, InputIt);
+
+    /*
+        Removes every range, telling the subscriber about each of them
+    */
+    void clearTable();
 public:
-    Range();
-    ~Range();
+    /*
+        The ways a modification can change a point, as told to subscribers
+    */
+    enum class Change { Covered, Uncovered };
+
+    /*
+        Callable told about every change to the set, with the kind of change
+        and the start and end of the range of points it applies to
+    */
+    typedef std::function<void(Change, Key, Key)> Subscriber;
+
+    /*
+        Iterator over the ranges intersecting a selection range,
+        each clipped to the selection, in increasing order.
+        Dereferencing yields the clipped range by value.
+    */
+    class ClippedIterator
+    {
+    private:
+        // walks the map backwards, which is in increasing order of start point
+        typename Table::const_reverse_iterator iter;
+        Key start;
+        Key end;
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef std::pair<Key, Key> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const std::pair<Key, Key>* pointer;
+        typedef std::pair<Key, Key> reference;
+
+        ClippedIterator(typename Table::const_reverse_iterator iter, Key start, Key end)
+            : iter(iter), start(start), end(end) {}
+
+        std::pair<Key, Key> operator*() const {
+            return std::make_pair(iter->first < start ? start : iter->first,
+                iter->second > end ? end : iter->second);
+        }
+        // the underlying iterator over the map, which the view's end never clips past
+        typename Table::const_reverse_iterator base() const { return iter; }
+        ClippedIterator& operator++() { ++iter; return *this; }
+        ClippedIterator operator++(int) { ClippedIterator old = *this; ++iter; return old; }
+        bool operator==(const ClippedIterator& other) const { return iter == other.iter; }
+        bool operator!=(const ClippedIterator& other) const { return iter != other.iter; }
+    };
+
+    /*
+        Lazy view of the ranges intersecting a selection range, as returned by GetView.
+        Only valid until the Range is next modified.
+    */
+    class View
+    {
+    private:
+        ClippedIterator first;
+        ClippedIterator last;
+    public:
+        View(ClippedIterator first, ClippedIterator last) : first(first), last(last) {}
+        ClippedIterator begin() const { return first; }
+        ClippedIterator end() const { return last; }
+        bool empty() const { return first == last; }
+    };
+
+    // the type of lengths, wide enough for the distance between any two coordinates
+    typedef typename std::make_unsigned<Key>::type Length;
+
+    BasicRange();
+    explicit BasicRange(const Allocator&);
+
+    /*
+        Builds the set from a list of ranges in any order, giving the same result
+        as calling Add on each of them, but sorting and coalescing them first and
+        building the map from the lowest range up, so that every node is
+        inserted in constant time instead of searched for
+
+        ranges: The list of ranges, in any order
+        Time Complexity: O(klogk), k being the number of ranges in the list
+    */
+    explicit BasicRange(std::vector<std::pair<Key, Key>>, const Allocator& = Allocator());
+
+    /*
+        Builds the set from ranges sorted by start point, such as a dump of
+        another set, giving the same result as calling Add on each of them.
+        Ranges may still overlap, touch or be empty; they are coalesced in a
+        single pass as they are read, so the input is never copied.
+        Throws std::invalid_argument if a range starts before the ranges it
+        would be merged with, which only happens if the input isn't sorted.
+
+        first, last: Input iterators over the ranges, as std::pair<Key, Key>
+        Time Complexity: O(k), k being the number of ranges
+    */
+    template <typename InputIt>
+    BasicRange(SortedRangesTag, InputIt first, InputIt last, const Allocator& allocator = Allocator());
+
+    /*
+        Copies every range into a map of its own, but not the subscriber
+        Copying is easy to do by accident, so prefer Clone where a copy is meant
+        Time Complexity: O(n)
+    */
+    BasicRange(const BasicRange&) = default;
+    BasicRange& operator=(const BasicRange&) = default;
+
+    /*
+        Takes over the map of "other" without copying or allocating a single
+        node, leaving "other" empty, so that sets can be returned by value and
+        kept in vectors that grow, sort and erase without copying them.
+        The subscriber moves along with the ranges.
+        Moving never throws, so std::vector moves sets rather than copying them.
+        Time Complexity: O(1), plus freeing the ranges this set held when assigning
+    */
+    BasicRange(BasicRange&&) = default;
+    BasicRange& operator=(BasicRange&&) = default;
+
+    /*
+        Exchanges the ranges, subscribers and settings of the two sets
+        without copying or allocating a single node
+        Time Complexity: O(1)
+    */
+    void swap(BasicRange&) noexcept;
+    friend void swap(BasicRange& first, BasicRange& second) noexcept { first.swap(second); }
+
+    /*
+        Returns a copy of the set, with the same ranges and settings but no
+        subscriber, rebuilding the map node for node in its existing shape
+        rather than inserting every range again
+        Time Complexity: O(n)
+    */
+    BasicRange Clone() const;
 
     /*
         Adds a range to the data structure, merging together existing 
@@ -24,7 +276,7 @@ public:
         end: The end of the selection range
         Time Complexity: O(logn)
     */
-    void Add(int, int);
+    void Add(Key, Key);
     /*
         Removes ranges that exist within the data structure
         that intersect with the selection range
@@ -33,17 +285,282 @@ public:
         end: The end of the selection range
         Time Complexity: O(logn)
     */
-    void Delete(int, int);
+    void Delete(Key, Key);
 
     /*
         Returns a list of ranges that exist within the data structure
         that intersect with the selection range
+        Selections holding more ranges than the parallel threshold are
+        copied by several threads, see SetParallelGet
 
         start: The start of the selection range
         end: The end of the selection range
         Time Complexity: O(n)
     */
-    std::vector<std::pair<int, int>> Get(int, int);
+    std::vector<std::pair<Key, Key>> Get(Key, Key) const;
+
+    // the number of ranges a selection must hold before Get goes parallel, by default
+    static constexpr std::size_t DefaultParallelThreshold = 65536;
+
+    /*
+        Sets when and how Get copies very wide selections with several threads.
+        Once Get has copied "threshold" ranges of a selection on its own, it cuts
+        the rest of the selection into chunks at evenly spaced keys, has "threads"
+        threads copy the ranges starting in each chunk into buffers of their own,
+        then has them move the buffers into their slots of the result at once.
+        With "threads" at 0, one thread is used per core, so on a single core
+        Get never goes parallel. The result is the same either way.
+
+        threshold: The number of ranges after which Get goes parallel
+        threads: The number of threads to use, or 0 for one per core
+        Time Complexity: O(1)
+    */
+    void SetParallelGet(std::size_t threshold, std::size_t threads = 0);
+
+    /*
+        Returns a lazy view of the ranges that exist within the data structure
+        that intersect with the selection range, each clipped to the selection.
+        Nothing is copied or allocated; the ranges are read from the map as the
+        view is iterated. The view is invalidated by Add and Delete.
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn)
+    */
+    View GetView(Key, Key) const;
+
+    /*
+        Calls "visit" with the start and end of every range that exists within the data
+        structure that intersects with the selection range, clipped to the selection
+        Does not allocate
+
+        start: The start of the selection range
+        end: The end of the selection range
+        visit: Callable taking the start and end of a range
+        Time Complexity: O(logn + k), k being the number of ranges visited
+    */
+    template <typename Visitor>
+    void ForEach(Key start, Key end, Visitor&& visit) const;
+
+    /*
+        Writes the ranges that exist within the data structure that intersect
+        with the selection range to "out", as std::pair<Key, Key>
+        Returns the output iterator past the last range written
+        Does not allocate, unless writing to "out" does
+
+        start: The start of the selection range
+        end: The end of the selection range
+        out: Output iterator to write the ranges to
+        Time Complexity: O(logn + k), k being the number of ranges written
+    */
+    template <typename OutputIt>
+    OutputIt Get(Key start, Key end, OutputIt out) const;
+
+    /*
+        Writes up to "capacity" of the ranges that exist within the data structure
+        that intersect with the selection range into "buffer"
+        Returns the total number of intersecting ranges, which is more than
+        "capacity" if the buffer was too small to hold all of them
+        Does not allocate
+
+        start: The start of the selection range
+        end: The end of the selection range
+        buffer: Array to write the ranges to
+        capacity: Number of ranges "buffer" can hold
+        Time Complexity: O(logn + k), k being the number of intersecting ranges
+    */
+    std::size_t Get(Key, Key, std::pair<Key, Key>*, std::size_t) const;
+
+    /*
+        Returns whether "point" is covered by a range in the data structure
+        Does not allocate
+
+        point: The point to look for
+        Time Complexity: O(logn)
+    */
+    bool Contains(Key) const;
+
+    /*
+        Returns the number of points in the selection range covered by
+        the data structure, i.e. the total length of the ranges Get would return
+        Does not allocate
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn + k), k being the number of ranges intersecting the selection
+    */
+    Length CoveredLength(Key, Key) const;
+
+    /*
+        Returns the number of ranges intersecting the selection range,
+        i.e. the number of ranges Get would return
+        Does not allocate
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn + k), k being the number of ranges intersecting the selection
+    */
+    std::size_t CountIntervals(Key, Key) const;
+
+    /*
+        Returns the first point at or after "point" that isn't covered
+        There always is one, since the largest value of Key can't be covered
+
+        point: The point to start looking from
+        Time Complexity: O(logn)
+    */
+    Key NextGap(Key) const;
+
+    /*
+        Returns the first point at or after "point" that is covered,
+        or nothing if there are no ranges from there on
+
+        point: The point to start looking from
+        Time Complexity: O(logn)
+    */
+    std::optional<Key> FirstCovered(Key) const;
+
+    /*
+        Adds every range in the list to the data structure.
+        Gives the same result as calling Add on each of them one at a time,
+        but sorts and coalesces them first, then applies them in a single
+        forward pass over the existing ranges instead of searching the
+        tree from the root for each one.
+
+        ranges: The list of selection ranges, in any order
+        Time Complexity: O(klogk + min(klogn, k + n)), k being the number of ranges in the list
+    */
+    void AddBatch(const std::vector<std::pair<Key, Key>>&);
+
+    /*
+        Removes every range in the list from the data structure.
+        Gives the same result as calling Delete on each of them one at a time,
+        in a single forward pass like AddBatch.
+
+        ranges: The list of selection ranges, in any order
+        Time Complexity: O(klogk + min(klogn, k + n)), k being the number of ranges in the list
+    */
+    void DeleteBatch(const std::vector<std::pair<Key, Key>>&);
+
+    /*
+        Calls Get on every selection range in the list, visiting them
+        in order of start point in a single forward pass.
+        Returns one list of ranges per selection range, in the order given.
+
+        ranges: The list of selection ranges, in any order
+        Time Complexity: O(klogk + min(klogn, k + n) + r), k being the number of
+        ranges in the list and r the number of ranges returned
+    */
+    std::vector<std::vector<std::pair<Key, Key>>> GetBatch(const std::vector<std::pair<Key, Key>>&) const;
+
+    /*
+        Set algebra between whole sets.
+        Each operation comes in two forms: one returning a new set and leaving both
+        operands alone, and one modifying this set in place.
+        All of them walk both sets in increasing order in a single pass, rather than
+        searching one set from the root for every range of the other. The returning
+        forms merge both sets into a new one. The in place forms walk this set like
+        the batch functions do, skipping ahead with a search where the ranges of
+        "other" are far apart, and only touch the ranges that change, so combining
+        a large set with a small one costs little more than the small one.
+    */
+
+    /*
+        Returns the points in this set, in "other", or in both
+        Time Complexity: O(n + m), m being the number of ranges in "other",
+        or O(min(mlogn, n + m)) in place
+    */
+    BasicRange Union(const BasicRange&) const;
+    void UnionWith(const BasicRange&);
+
+    /*
+        Returns the points in both this set and "other"
+        Time Complexity: O(n + m), m being the number of ranges in "other",
+        or O(min(mlogn, n + m)) in place
+    */
+    BasicRange Intersect(const BasicRange&) const;
+    void IntersectWith(const BasicRange&);
+
+    /*
+        Returns the points in this set that aren't in "other"
+        Time Complexity: O(n + m), m being the number of ranges in "other",
+        or O(min(mlogn, n + m)) in place
+    */
+    BasicRange Difference(const BasicRange&) const;
+    void DifferenceWith(const BasicRange&);
+
+    /*
+        Returns the points in exactly one of this set and "other"
+        Time Complexity: O(n + m), m being the number of ranges in "other",
+        or O(min(mlogn, n + m)) in place
+    */
+    BasicRange SymmetricDifference(const BasicRange&) const;
+    void SymmetricDifferenceWith(const BasicRange&);
+
+    /*
+        Returns the points from "start" to "end" that aren't in this set
+        ComplementWithin drops every range outside of the bounds
+
+        start: The start of the bounds
+        end: The end of the bounds
+        Time Complexity: O(logn + k), k being the number of ranges within the bounds,
+        plus the number of ranges dropped in place
+    */
+    BasicRange Complement(Key, Key) const;
+    void ComplementWithin(Key, Key);
+
+    /*
+        Attaches "subscriber", replacing any attached before, so that it is
+        told exactly which points every later modification covers or uncovers.
+        Each call names a range of points that changed, so a mirror of the set
+        can be kept up to date by applying just those ranges, instead of
+        calling Get on the whole region after every modification.
+        Every modifying function reports its changes, including the batch and
+        set algebra ones. Within one modification the ranges are reported in
+        increasing order, never overlap, and are never empty; adding points
+        that are already covered, or deleting ones that aren't, reports nothing.
+        The subscriber is called before the change is applied, and must not
+        use the set. Pass an empty Subscriber to detach it.
+        Copies of the set start without a subscriber, and assigning another
+        set to this one replaces its ranges without reporting them.
+        Moving a set hands its subscriber over to the set moved to, as does
+        swapping two sets, since the ranges it watches go there.
+        While none is attached, modifications do no extra work.
+
+        subscriber: The callable to tell about changes
+    */
+    void Subscribe(Subscriber);
+
+    /*
+        Returns what the set has been doing since it was created or ResetStats
+        was last called: how often Add, Delete and Get were called, how many
+        ranges they merged, erased and returned, and how long they took.
+        Only kept when the program is built with RANGE_STATS defined, and
+        otherwise returns stats with "enabled" false and every counter at zero.
+        The counters are atomic, so Stats and Get may be called from several threads
+        at once, like the other const functions; the counters of calls that are
+        still running may or may not be included. Add, Delete and ResetStats still
+        need the set to themselves.
+        Time Complexity: O(1)
+    */
+    RangeStats Stats() const;
+
+    /*
+        Sets every counter and histogram of Stats back to zero
+        Time Complexity: O(1)
+    */
+    void ResetStats();
+
+    /*
+        Returns the number of disjoint ranges in the data structure
+        Time Complexity: O(1)
+    */
+    std::size_t Size() const { return table.size(); }
+
+    /*
+        Returns a copy of the allocator used for the nodes of the map
+    */
+    Allocator GetAllocator() const { return table.get_allocator(); }
 
     /*
         Convenience function to print the start and endpoints of the range in reverse order.
@@ -57,6 +574,129 @@ public:
         Returns a list in reverse order.
         Used for Testcase Verification.
     */ 
-    std::vector<int> toVec() const;
+    std::vector<Key> toVec() const;
+private:
+    /*
+        Builds the view of the ranges intersecting the selection range, given
+        startIter = table.lower_bound(start) and endIter = table.lower_bound(end)
+    */
+    View makeView(typename Table::const_iterator, typename Table::const_iterator, Key, Key) const;
+
+    /*
+        Appends the ranges from "from" up to "last" to "ret", clipped to the selection
+        from "start" to "end", with several threads, for Get on very wide selections
+    */
+    void getParallel(typename Table::const_reverse_iterator, typename Table::const_reverse_iterator, Key, Key,
+        std::vector<std::pair<Key, Key>>&) const;
+
+    // Get goes parallel once it has copied this many ranges of a selection
+    std::size_t parallelThreshold = DefaultParallelThreshold;
+    // the number of threads a parallel Get uses, 0 for one per core
+    std::size_t parallelThreads = 0;
+
+    /*
+        Holds the subscriber, if any
+        Copying a set doesn't copy its subscriber, since changes to the copy
+        are no concern of whoever watches the original, but moving it does,
+        since the moved to set holds the very same ranges
+    */
+    struct Feed
+    {
+        Subscriber notify;
+
+        Feed() {}
+        Feed(const Feed&) {}
+        Feed& operator=(const Feed&) { return *this; }
+        Feed(Feed&& other) noexcept : notify(std::move(other.notify)) { other.notify = nullptr; }
+        Feed& operator=(Feed&& other) noexcept{
+            notify = std::move(other.notify);
+            other.notify = nullptr;
+            return *this;
+        }
+    };
+
+    Feed feed;
+
+#ifdef RANGE_STATS
+    // updated by Get too, which is const and may be called by several threads at once
+    mutable RangeCounters stats;
+#endif
 };
+
+template <typename Key, typename Allocator>
+template <typename InputIt>
+BasicRange<Key, Allocator>::BasicRange(SortedRangesTag, InputIt first, InputIt last, const Allocator& allocator)
+    : table(allocator) {
+    appendSorted(first, last);
+}
+
+/*
+    Appends ranges sorted by start point to an empty table
+    Keeps extending the current range while the next one overlaps or touches it,
+    and adds it once one doesn't. The map is in decreasing order, so each range
+    added goes first, which is where the hint makes inserting it take constant time
+*/
+template <typename Key, typename Allocator>
+template <typename InputIt>
+void BasicRange<Key, Allocator>::appendSorted(InputIt first, InputIt last){
+    bool pending = false;
+    Key start = Key();
+    Key end = Key();
+    for (; first != last; ++first){
+        std::pair<Key, Key> range = *first;
+        if (range.first >= range.second){
+            continue;
+        }
+        if (pending && range.first < start){
+            throw std::invalid_argument("BasicRange: ranges are not sorted by start point");
+        }
+        if (pending && range.first <= end){
+            if (range.second > end){
+                end = range.second;
+            }
+            continue;
+        }
+        if (pending){
+            table.emplace_hint(table.begin(), start, end);
+        }
+        start = range.first;
+        end = range.second;
+        pending = true;
+    }
+    if (pending){
+        table.emplace_hint(table.begin(), start, end);
+    }
+}
+
+template <typename Key, typename Allocator>
+template <typename Visitor>
+void BasicRange<Key, Allocator>::ForEach(Key start, Key end, Visitor&& visit) const{
+    for (auto&& range : GetView(start, end)){
+        visit(range.first, range.second);
+    }
+}
+
+template <typename Key, typename Allocator>
+template <typename OutputIt>
+OutputIt BasicRange<Key, Allocator>::Get(Key start, Key end, OutputIt out) const{
+    for (auto&& range : GetView(start, end)){
+        *out++ = range;
+    }
+    return out;
+}
+
+// the definitions live in Range.cpp, which builds them for these coordinate types
+extern template class BasicRange<std::int32_t>;
+extern template class BasicRange<std::int64_t>;
+extern template class BasicRange<std::uint64_t>;
+extern template class BasicRange<std::int32_t, PoolAllocator<std::pair<const std::int32_t, std::int32_t>>>;
+extern template class BasicRange<std::int64_t, PoolAllocator<std::pair<const std::int64_t, std::int64_t>>>;
+extern template class BasicRange<std::uint64_t, PoolAllocator<std::pair<const std::uint64_t, std::uint64_t>>>;
+
+typedef BasicRange<std::int32_t> Range;
+
+// Range drawing its nodes from a pool of its own
+template <typename Key>
+using BasicPooledRange = BasicRange<Key, PoolAllocator<std::pair<const Key, Key>>>;
+typedef BasicPooledRange<std::int32_t> PooledRange;
 #endif
\ No newline at end of file
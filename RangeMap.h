@@ -0,0 +1,382 @@
+#ifndef _RANGE_MAP_H_
+#define _RANGE_MAP_H_
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/*
+    Merge rules for BasicRangeMap, deciding the payload of points that are
+    added again while they already have one
+    Each is called with the existing payload and the one being added
+*/
+
+// the payload being added replaces the existing one
+struct OverwriteMerge
+{
+    template <typename Value>
+    Value operator()(const Value&, const Value& incoming) const { return incoming; }
+};
+
+// the existing payload stays, so only uncovered points take the new one
+struct KeepMerge
+{
+    template <typename Value>
+    Value operator()(const Value& existing, const Value&) const { return existing; }
+};
+
+// the larger of the two payloads wins, e.g. the later of two expiry times
+struct MaxMerge
+{
+    template <typename Value>
+    Value operator()(const Value& existing, const Value& incoming) const { return existing < incoming ? incoming : existing; }
+};
+
+// the smaller of the two payloads wins
+struct MinMerge
+{
+    template <typename Value>
+    Value operator()(const Value& existing, const Value& incoming) const { return incoming < existing ? incoming : existing; }
+};
+
+/*
+    Sibling of Range that attaches a payload of type "Value" to every covered point,
+    such as the ID of the owner of a region or the time it expires.
+
+    The ranges are kept in the same std::map as Range, keyed by start point in
+    decreasing order, with the payload stored inline next to the end point
+    rather than behind a pointer of its own. Add and Delete search the map just
+    like Range does, but where Range merges every range a new one touches,
+    ranges here only merge when their payloads are equal: adding over points
+    that are already covered gives them "merge(existing, incoming)" instead,
+    splitting the ranges at the selection's edges where needed. Neighbouring
+    ranges that touch and have equal payloads are always joined, so every
+    range is as wide as it can be.
+
+    "Merge" is a callable taking the existing and the incoming payload and
+    returning the one to keep; OverwriteMerge, KeepMerge, MaxMerge and MinMerge
+    cover the common cases. "Value" must be copyable and comparable with ==.
+    Like BTreeRange, it is a template and lives entirely in this header.
+*/
+template <typename Key, typename Value, typename Merge = OverwriteMerge>
+class BasicRangeMap
+{
+public:
+    /*
+        A range and its payload, as returned by Get
+    */
+    struct Segment
+    {
+        Key start;
+        Key end;
+        Value value;
+
+        bool operator==(const Segment& other) const {
+            return start == other.start && end == other.end && value == other.value;
+        }
+        bool operator!=(const Segment& other) const { return !(*this == other); }
+    };
+private:
+    // the end of a range and its payload, stored inline in the map node
+    struct Entry
+    {
+        Key end;
+        Value value;
+    };
+
+    typedef std::map<Key, Entry, std::greater<Key>> Table;
+
+    // maps each range's start to its end and payload, like Range's table
+    Table table;
+    Merge merge;
+
+    /*
+        Returns the range with the next larger start point after "iter",
+        or table.end() if there is none
+        The map is in decreasing order, so that is the one before it
+    */
+    typename Table::iterator next(typename Table::iterator);
+
+    /*
+        Returns the first range starting at or after "key", or table.end() if there is none
+    */
+    typename Table::iterator firstFrom(Key);
+
+    /*
+        Splits the range containing "key", if any, into the part before "key" and
+        the part from "key" on, both keeping its payload, so that no range crosses "key"
+        Time Complexity: O(logn)
+    */
+    void splitAt(Key);
+
+    /*
+        Joins each range from "from" up to and including the first one starting at
+        or after "end" with the next one if they touch and have equal payloads
+    */
+    void joinFrom(typename Table::iterator, Key);
+public:
+    explicit BasicRangeMap(Merge merge = Merge());
+
+    /*
+        Covers the selection range with "value". Points that had no payload get
+        "value", and points that had one get "merge(existing, value)". Touching
+        neighbours that end up with equal payloads are joined.
+
+        start: The start of the selection range
+        end: The end of the selection range
+        value: The payload to add
+        Time Complexity: O(logn + k), k being the number of ranges intersecting the selection
+    */
+    void Add(Key, Key, const Value&);
+
+    /*
+        Removes the payloads of every point in the selection range, cutting
+        the ranges on either edge of it down to the part outside of it
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn + k), k being the number of ranges removed
+    */
+    void Delete(Key, Key);
+
+    /*
+        Returns the ranges that intersect with the selection range, clipped
+        to it, each with its payload, in increasing order
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn + k), k being the number of ranges returned
+    */
+    std::vector<Segment> Get(Key, Key) const;
+
+    /*
+        Calls "visit" with the start, end and payload of every range that
+        intersects with the selection range, clipped to the selection
+        Does not allocate
+
+        start: The start of the selection range
+        end: The end of the selection range
+        visit: Callable taking the start, end and payload of a range
+        Time Complexity: O(logn + k), k being the number of ranges visited
+    */
+    template <typename Visitor>
+    void ForEach(Key start, Key end, Visitor&& visit) const;
+
+    /*
+        Returns the payload of "point", or nothing if it isn't covered
+
+        point: The point to look up
+        Time Complexity: O(logn)
+    */
+    std::optional<Value> At(Key) const;
+
+    /*
+        Returns the number of ranges in the data structure
+        Time Complexity: O(1)
+    */
+    std::size_t Size() const { return table.size(); }
+
+    /*
+        Convenience function to print the start and endpoints of the range in reverse order,
+        with each range's payload after its start point.
+        Returns nothing, but prints to stdout.
+        Used for Debugging.
+    */
+    void printAll() const;
+};
+
+template <typename Value, typename Merge = OverwriteMerge>
+using RangeMap = BasicRangeMap<int, Value, Merge>;
+
+template <typename Key, typename Value, typename Merge>
+BasicRangeMap<Key, Value, Merge>::BasicRangeMap(Merge merge) : merge(std::move(merge)) {
+
+}
+
+template <typename Key, typename Value, typename Merge>
+typename BasicRangeMap<Key, Value, Merge>::Table::iterator BasicRangeMap<Key, Value, Merge>::next(typename Table::iterator iter){
+    return iter == table.begin() ? table.end() : std::prev(iter);
+}
+
+template <typename Key, typename Value, typename Merge>
+typename BasicRangeMap<Key, Value, Merge>::Table::iterator BasicRangeMap<Key, Value, Merge>::firstFrom(Key key){
+    // lower_bound finds the range starting at or before "key",
+    // which is the one wanted only if it starts exactly there,
+    // otherwise it is the next one
+    auto iter = table.lower_bound(key);
+    if (iter != table.end() && iter->first == key){
+        return iter;
+    }
+    return next(iter);
+}
+
+/*
+    Splits the range containing "key", if any, into the part before "key" and
+    the part from "key" on, both keeping its payload
+    Time Complexity: O(logn)
+*/
+template <typename Key, typename Value, typename Merge>
+void BasicRangeMap<Key, Value, Merge>::splitAt(Key key){
+    auto iter = table.lower_bound(key);
+    if (iter != table.end() && iter->first < key && key < iter->second.end){
+        // the new part goes directly before iter in the map
+        table.emplace_hint(iter, key, iter->second);
+        iter->second.end = key;
+    }
+}
+
+/*
+    Joins each range from "from" up to and including the first one starting at
+    or after "end" with the next one if they touch and have equal payloads
+*/
+template <typename Key, typename Value, typename Merge>
+void BasicRangeMap<Key, Value, Merge>::joinFrom(typename Table::iterator from, Key end){
+    if (from == table.end()){
+        return;
+    }
+    for (auto after = next(from); after != table.end(); after = next(from)){
+        if (from->second.end == after->first && from->second.value == after->second.value){
+            from->second.end = after->second.end;
+            table.erase(after);
+        } else if (after->first >= end){
+            return;
+        } else {
+            from = after;
+        }
+    }
+}
+
+/*
+    Covers the selection range with "value"
+    First cuts the ranges crossing the selection's edges in two, so that every
+    range is either entirely inside of the selection or entirely outside of it.
+    Then walks the ranges inside in increasing order, merging "value" into each
+    of them and filling the gaps between them with new ranges, and finally joins
+    the touching neighbours with equal payloads, from the range before the
+    selection to the one after it
+
+    start: The start of the selection range
+    end: The end of the selection range
+    value: The payload to add
+    Time Complexity: O(logn + k), k being the number of ranges intersecting the selection
+*/
+template <typename Key, typename Value, typename Merge>
+void BasicRangeMap<Key, Value, Merge>::Add(Key start, Key end, const Value& value){
+    // an empty selection covers nothing, so there is nothing to add
+    if (start >= end){
+        return;
+    }
+    splitAt(start);
+    splitAt(end);
+    Key from = start;
+    auto iter = firstFrom(start);
+    for (; iter != table.end() && iter->first < end; iter = next(iter)){
+        // the gap before this range goes directly after it in the map
+        if (from < iter->first){
+            table.emplace_hint(std::next(iter), from, Entry{iter->first, value});
+        }
+        iter->second.value = merge(iter->second.value, value);
+        from = iter->second.end;
+    }
+    // and so does the gap after the last one, which goes first in the map
+    // if no range starts after the selection
+    if (from < end){
+        table.emplace_hint(iter == table.end() ? table.begin() : std::next(iter), from, Entry{end, value});
+    }
+    // the range before the selection may now touch an equal payload too
+    auto first = table.upper_bound(start);
+    joinFrom(first == table.end() ? firstFrom(start) : first, end);
+}
+
+/*
+    Removes the payloads of every point in the selection range
+    Cuts the ranges crossing the selection's edges in two, then erases every
+    range inside of it. The parts left on either side are separated by the
+    selection, so nothing needs joining
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn + k), k being the number of ranges removed
+*/
+template <typename Key, typename Value, typename Merge>
+void BasicRangeMap<Key, Value, Merge>::Delete(Key start, Key end){
+    // an empty selection covers nothing, so there is nothing to remove
+    if (start >= end){
+        return;
+    }
+    splitAt(start);
+    splitAt(end);
+    // in the map's decreasing order, the ranges inside of the selection run from
+    // the first one starting before "end" up to the first one starting before "start"
+    table.erase(table.upper_bound(end), table.upper_bound(start));
+}
+
+/*
+    Returns the ranges that intersect with the selection range, clipped
+    to it, each with its payload, in increasing order
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn + k), k being the number of ranges returned
+*/
+template <typename Key, typename Value, typename Merge>
+std::vector<typename BasicRangeMap<Key, Value, Merge>::Segment> BasicRangeMap<Key, Value, Merge>::Get(Key start, Key end) const{
+    std::vector<Segment> ret;
+    ForEach(start, end, [&](Key from, Key to, const Value& value){
+        ret.push_back(Segment{from, to, value});
+    });
+    return ret;
+}
+
+/*
+    Calls "visit" with every range that intersects with the selection range,
+    clipped to it, walking the map backwards from the range containing "start"
+*/
+template <typename Key, typename Value, typename Merge>
+template <typename Visitor>
+void BasicRangeMap<Key, Value, Merge>::ForEach(Key start, Key end, Visitor&& visit) const{
+    // an empty selection can't intersect anything
+    if (start >= end){
+        return;
+    }
+    // a reverse iterator built from an iterator refers to the range with the
+    // next larger start point, so step back over the range containing "start"
+    auto startIter = table.lower_bound(start);
+    typename Table::const_reverse_iterator iter(startIter);
+    if (startIter != table.end() && start < startIter->second.end){
+        iter = typename Table::const_reverse_iterator(std::next(startIter));
+    }
+    for (; iter != table.rend() && iter->first < end; iter++){
+        visit(iter->first < start ? start : iter->first, iter->second.end > end ? end : iter->second.end,
+            iter->second.value);
+    }
+}
+
+template <typename Key, typename Value, typename Merge>
+std::optional<Value> BasicRangeMap<Key, Value, Merge>::At(Key point) const{
+    auto iter = table.lower_bound(point);
+    if (iter != table.end() && point < iter->second.end){
+        return iter->second.value;
+    }
+    return std::nullopt;
+}
+
+/*
+    Convenience function to print the start and endpoints of the range in reverse order,
+    with each range's payload after its start point.
+    Returns nothing, but prints to stdout.
+    Used for Debugging.
+*/
+template <typename Key, typename Value, typename Merge>
+void BasicRangeMap<Key, Value, Merge>::printAll() const{
+    for (auto&& elem : table){
+        std::cout << elem.second.end << ", " << elem.first << ": " << elem.second.value << ", ";
+    }
+    std::cout << std::endl;
+}
+#endif
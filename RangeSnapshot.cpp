@@ -0,0 +1,333 @@
+#include "RangeSnapshot.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    /*
+        Returns the header describing a snapshot of "count" ranges of type Key,
+        without the checksum filled in
+    */
+    template <typename Key>
+    SnapshotHeader makeHeader(std::uint64_t count){
+        SnapshotHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+        header.version = snapshotVersion;
+        header.keyBytes = sizeof(Key);
+        header.keySigned = std::is_signed<Key>::value;
+        header.byteOrder = snapshotByteOrder;
+        header.count = count;
+        return header;
+    }
+
+    /*
+        Throws std::runtime_error, mentioning "path"
+    */
+    [[noreturn]] void fail(const std::string& path, const char* reason){
+        throw std::runtime_error("snapshot " + path + ": " + reason);
+    }
+
+    /*
+        Writes "bytes" bytes from "data" to "file", throwing if it can't
+    */
+    void writeAll(std::FILE* file, const void* data, std::size_t bytes, const std::string& path){
+        if (bytes != 0 && std::fwrite(data, 1, bytes, file) != bytes){
+            std::fclose(file);
+            fail(path, "write failed");
+        }
+    }
+
+    /*
+        Syncs the directory holding "path", so that a file
+        just renamed into it stays there after a crash
+        Returns whether it succeeded
+    */
+    bool syncDirectory(const std::string& path){
+        std::size_t slash = path.find_last_of('/');
+        std::string directory = slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+        int fd = open(directory.c_str(), O_RDONLY);
+        if (fd < 0){
+            return false;
+        }
+        bool synced = fsync(fd) == 0;
+        close(fd);
+        return synced;
+    }
+
+    /*
+        Writes one of the two arrays of a snapshot, folding it into "hash"
+        "which" picks the start (first) or end (second) of each range
+    */
+    template <typename Key, typename Which>
+    void writeArray(std::FILE* file, const BasicRange<Key>& range, Which which,
+        std::uint64_t& hash, const std::string& path){
+        // buffer the coordinates so that they are written in large blocks
+        const std::size_t blockSize = 4096;
+        Key block[blockSize];
+        std::size_t used = 0;
+        auto flush = [&](){
+            hash = snapshotChecksum(hash, block, used);
+            writeAll(file, block, used * sizeof(Key), path);
+            used = 0;
+        };
+        range.ForEach(std::numeric_limits<Key>::lowest(), std::numeric_limits<Key>::max(), [&](Key start, Key end){
+            block[used++] = which(start, end);
+            if (used == blockSize){
+                flush();
+            }
+        });
+        flush();
+    }
+}
+
+/*
+    Folds "count" coordinates into the running checksum "hash", one coordinate at a time
+*/
+template <typename Key>
+std::uint64_t snapshotChecksum(std::uint64_t hash, const Key* keys, std::size_t count){
+    const std::uint64_t prime = 1099511628211ULL;
+    for (std::size_t i = 0; i < count; i++){
+        hash = (hash ^ static_cast<std::uint64_t>(keys[i])) * prime;
+    }
+    return hash;
+}
+
+/*
+    Writes every range in "range" to a snapshot file at "path"
+    Time Complexity: O(n)
+*/
+template <typename Key>
+void SaveSnapshot(const BasicRange<Key>& range, const std::string& path){
+    std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr){
+        fail(temporary, "can't be created");
+    }
+    // the checksum is only known once the arrays are written,
+    // so the header is written twice
+    SnapshotHeader header = makeHeader<Key>(range.Size());
+    writeAll(file, &header, sizeof(header), temporary);
+    std::uint64_t hash = snapshotChecksumSeed;
+    writeArray(file, range, [](Key start, Key){ return start; }, hash, temporary);
+    writeArray(file, range, [](Key, Key end){ return end; }, hash, temporary);
+    header.checksum = hash;
+    if (std::fseek(file, 0, SEEK_SET) != 0){
+        std::fclose(file);
+        fail(temporary, "seek failed");
+    }
+    writeAll(file, &header, sizeof(header), temporary);
+    // make sure the contents are on disk before the rename makes them visible
+    if (std::fflush(file) != 0 || fsync(fileno(file)) != 0){
+        std::fclose(file);
+        fail(temporary, "sync failed");
+    }
+    if (std::fclose(file) != 0){
+        fail(temporary, "close failed");
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0){
+        fail(path, "can't be replaced");
+    }
+    if (!syncDirectory(path)){
+        fail(path, "sync failed");
+    }
+}
+
+/*
+    Reads a snapshot file back into a new Range
+    The snapshot is already sorted and coalesced, so the sorted constructor
+    appends every range straight from the mapping, next to the previous one,
+    without copying the file or sorting it again
+    Time Complexity: O(n)
+*/
+template <typename Key>
+BasicRange<Key> LoadSnapshot(const std::string& path){
+    BasicMappedRange<Key> mapped(path);
+    try {
+        return BasicRange<Key>(SortedRanges, mapped.begin(), mapped.end());
+    } catch (const std::invalid_argument&){
+        // only a file that was tampered with and given a matching checksum gets here
+        fail(path, "is not sorted");
+    }
+}
+
+/*
+    Maps the snapshot file at "path", validating its header
+    and, if "verify" is set, its checksum
+*/
+template <typename Key>
+BasicMappedRange<Key>::BasicMappedRange(const std::string& path, bool verify)
+    : mapping(nullptr), length(0), starts(nullptr), ends(nullptr), count(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0){
+        fail(path, "can't be opened");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0){
+        close(fd);
+        fail(path, "can't be read");
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length < sizeof(SnapshotHeader)){
+        close(fd);
+        fail(path, "is too short to be a snapshot");
+    }
+    mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping stays valid after the file is closed
+    close(fd);
+    if (mapping == MAP_FAILED){
+        mapping = nullptr;
+        fail(path, "can't be mapped");
+    }
+
+    // from here on, the destructor won't run if the constructor throws,
+    // so the mapping has to be released by hand
+    auto reject = [&](const char* reason){
+        munmap(mapping, length);
+        mapping = nullptr;
+        fail(path, reason);
+    };
+    SnapshotHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    SnapshotHeader expected = makeHeader<Key>(header.count);
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0){
+        reject("is not a snapshot");
+    }
+    if (header.byteOrder != expected.byteOrder){
+        reject("was written on a machine of a different byte order");
+    }
+    if (header.version != expected.version){
+        reject("has an unsupported version");
+    }
+    if (header.keyBytes != expected.keyBytes || header.keySigned != expected.keySigned){
+        reject("was written with a different coordinate type");
+    }
+    // checked without multiplying, which could overflow for a corrupt count
+    if (header.count > (length - sizeof(header)) / (2 * sizeof(Key))
+        || length != sizeof(header) + 2 * sizeof(Key) * header.count){
+        reject("has the wrong size");
+    }
+    count = static_cast<std::size_t>(header.count);
+    starts = reinterpret_cast<const Key*>(static_cast<const char*>(mapping) + sizeof(header));
+    ends = starts + count;
+    if (verify){
+        std::uint64_t hash = snapshotChecksum(snapshotChecksumSeed, starts, count);
+        if (snapshotChecksum(hash, ends, count) != header.checksum){
+            reject("is corrupt");
+        }
+    }
+}
+
+template <typename Key>
+BasicMappedRange<Key>::BasicMappedRange(BasicMappedRange&& other) noexcept
+    : mapping(other.mapping), length(other.length), starts(other.starts), ends(other.ends), count(other.count) {
+    other.mapping = nullptr;
+    other.length = 0;
+    other.starts = nullptr;
+    other.ends = nullptr;
+    other.count = 0;
+}
+
+template <typename Key>
+BasicMappedRange<Key>::~BasicMappedRange() {
+    if (mapping != nullptr){
+        munmap(mapping, length);
+    }
+}
+
+/*
+    Returns the number of start points less than or equal to "value"
+    Time Complexity: O(logn)
+*/
+template <typename Key>
+std::size_t BasicMappedRange<Key>::countStartsAtOrBefore(Key value) const{
+    return std::upper_bound(starts, starts + count, value) - starts;
+}
+
+/*
+    Returns the number of start points strictly less than "value"
+    Time Complexity: O(logn)
+*/
+template <typename Key>
+std::size_t BasicMappedRange<Key>::countStartsBefore(Key value) const{
+    return std::lower_bound(starts, starts + count, value) - starts;
+}
+
+/*
+    Returns a list of ranges that exist within the snapshot
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn + k), k being the number of ranges returned
+*/
+template <typename Key>
+std::vector<std::pair<Key, Key>> BasicMappedRange<Key>::Get(Key start, Key end) const{
+    std::vector<std::pair<Key, Key>> ret;
+    // an empty selection can't intersect anything
+    if (start >= end){
+        return ret;
+    }
+    // find the first range that overlaps "start" or comes after it,
+    // and one past the last range that starts before "end"
+    std::size_t first = countStartsAtOrBefore(start);
+    if (first > 0 && ends[first - 1] > start){
+        first--;
+    }
+    std::size_t last = countStartsBefore(end);
+    for (std::size_t i = first; i < last; i++){
+        ret.push_back(std::make_pair(std::max(start, starts[i]), std::min(end, ends[i])));
+    }
+    return ret;
+}
+
+/*
+    Convenience function to print the start and endpoints of the range in reverse order.
+    Returns nothing, but prints to stdout.
+    Used for Debugging.
+*/
+template <typename Key>
+void BasicMappedRange<Key>::printAll() const{
+    for (std::size_t i = count; i > 0; i--){
+        std::cout << ends[i - 1] << ", " << starts[i - 1] << ", ";
+    }
+    std::cout << std::endl;
+}
+
+/*
+    Convenience function to serialize the range into a list of start and end points.
+    Returns a list in reverse order, matching Range::toVec.
+    Used for Testcase Verification.
+*/
+template <typename Key>
+std::vector<Key> BasicMappedRange<Key>::toVec() const{
+    std::vector<Key> vec;
+    vec.reserve(2 * count);
+    for (std::size_t i = count; i > 0; i--){
+        vec.push_back(ends[i - 1]);
+        vec.push_back(starts[i - 1]);
+    }
+    return vec;
+}
+
+// the same coordinate types as Range
+template class BasicMappedRange<std::int32_t>;
+template class BasicMappedRange<std::int64_t>;
+template class BasicMappedRange<std::uint64_t>;
+template void SaveSnapshot(const BasicRange<std::int32_t>&, const std::string&);
+template void SaveSnapshot(const BasicRange<std::int64_t>&, const std::string&);
+template void SaveSnapshot(const BasicRange<std::uint64_t>&, const std::string&);
+template BasicRange<std::int32_t> LoadSnapshot(const std::string&);
+template BasicRange<std::int64_t> LoadSnapshot(const std::string&);
+template BasicRange<std::uint64_t> LoadSnapshot(const std::string&);
+template std::uint64_t snapshotChecksum(std::uint64_t, const std::int32_t*, std::size_t);
+template std::uint64_t snapshotChecksum(std::uint64_t, const std::int64_t*, std::size_t);
+template std::uint64_t snapshotChecksum(std::uint64_t, const std::uint64_t*, std::size_t);
@@ -0,0 +1,199 @@
+#ifndef _RANGE_SNAPSHOT_H_
+#define _RANGE_SNAPSHOT_H_
+
+#include "Range.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+    On-disk snapshots of a Range.
+
+    A snapshot file is laid out as:
+        SnapshotHeader
+        Key starts[count]   start points of the ranges, in increasing order
+        Key ends[count]     end points, ends[i] belonging to starts[i]
+    with every field in the byte order of the machine that wrote it.
+    The arrays are exactly what a binary search needs, so a snapshot can be
+    mapped into memory and queried as is (see BasicMappedRange) rather than
+    being read back into a Range.
+*/
+
+// the first bytes of every snapshot file
+const char snapshotMagic[8] = {'R', 'A', 'N', 'G', 'E', 'S', 'N', 'P'};
+// incremented whenever the layout of the file changes
+const std::uint32_t snapshotVersion = 1;
+// written as is, reads back differently on a machine of the other byte order
+const std::uint32_t snapshotByteOrder = 0x01020304;
+
+struct SnapshotHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    // sizeof(Key) and whether Key is signed, so that a snapshot can't be
+    // read back with the wrong coordinate type
+    std::uint32_t keyBytes;
+    std::uint32_t keySigned;
+    std::uint32_t byteOrder;
+    // number of ranges in the snapshot
+    std::uint64_t count;
+    // checksum of the starts followed by the ends, see snapshotChecksum
+    std::uint64_t checksum;
+};
+
+/*
+    Folds "count" coordinates into the running checksum "hash", one coordinate at a time
+    The checksum of a snapshot starts from snapshotChecksumSeed and covers the
+    starts followed by the ends (64 bit FNV-1a, taking each coordinate as one word)
+
+    hash: the checksum so far
+    keys: the coordinates to add to the checksum
+    count: number of coordinates
+*/
+const std::uint64_t snapshotChecksumSeed = 14695981039346656037ULL;
+template <typename Key>
+std::uint64_t snapshotChecksum(std::uint64_t hash, const Key* keys, std::size_t count);
+
+/*
+    Writes every range in "range" to a snapshot file at "path"
+    The snapshot is written to a temporary file which then replaces "path",
+    so a crash never leaves a partially written snapshot behind
+    Throws std::runtime_error if the file can't be written
+
+    range: The set of ranges to save
+    path: Where to save the snapshot
+    Time Complexity: O(n)
+*/
+template <typename Key>
+void SaveSnapshot(const BasicRange<Key>& range, const std::string& path);
+
+/*
+    Reads a snapshot file back into a new Range, building it straight from
+    the mapped arrays, which are already sorted
+    Throws std::runtime_error if the file is missing, corrupt, or was
+    written with a different coordinate type
+
+    path: The snapshot file to read
+    Time Complexity: O(n)
+*/
+template <typename Key>
+BasicRange<Key> LoadSnapshot(const std::string& path);
+
+/*
+    Read-only set of ranges backed directly by a memory mapped snapshot file.
+    Opening it only validates the header (and the checksum, unless told not to);
+    nothing is copied or deserialized, and the operating system pages the file
+    in as Get touches it.
+*/
+template <typename Key>
+class BasicMappedRange
+{
+private:
+    // the whole mapped file
+    void* mapping;
+    std::size_t length;
+    // the arrays inside the mapping
+    const Key* starts;
+    const Key* ends;
+    std::size_t count;
+
+    /*
+        Returns the number of start points less than or equal to "value"
+        Time Complexity: O(logn)
+    */
+    std::size_t countStartsAtOrBefore(Key value) const;
+
+    /*
+        Returns the number of start points strictly less than "value"
+        Time Complexity: O(logn)
+    */
+    std::size_t countStartsBefore(Key value) const;
+public:
+    /*
+        Iterator over every range in the snapshot in increasing order,
+        reading each straight out of the mapping.
+        Dereferencing yields the range by value.
+    */
+    class Iterator
+    {
+    private:
+        const Key* start;
+        const Key* end;
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef std::pair<Key, Key> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const std::pair<Key, Key>* pointer;
+        typedef std::pair<Key, Key> reference;
+
+        Iterator(const Key* start, const Key* end) : start(start), end(end) {}
+
+        std::pair<Key, Key> operator*() const { return std::make_pair(*start, *end); }
+        Iterator& operator++() { ++start; ++end; return *this; }
+        Iterator operator++(int) { Iterator old = *this; ++*this; return old; }
+        bool operator==(const Iterator& other) const { return start == other.start; }
+        bool operator!=(const Iterator& other) const { return start != other.start; }
+    };
+
+    /*
+        Maps the snapshot file at "path"
+        Throws std::runtime_error if the file is missing, corrupt, or was
+        written with a different coordinate type
+
+        path: The snapshot file to map
+        verify: Whether to check the checksum, which reads the whole file
+    */
+    explicit BasicMappedRange(const std::string& path, bool verify = true);
+    BasicMappedRange(BasicMappedRange&&) noexcept;
+    BasicMappedRange(const BasicMappedRange&) = delete;
+    BasicMappedRange& operator=(const BasicMappedRange&) = delete;
+    ~BasicMappedRange();
+
+    /*
+        Returns a list of ranges that exist within the snapshot
+        that intersect with the selection range
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn + k), k being the number of ranges returned
+    */
+    std::vector<std::pair<Key, Key>> Get(Key, Key) const;
+
+    /*
+        Returns the number of ranges in the snapshot
+    */
+    std::size_t Size() const { return count; }
+
+    /*
+        Returns iterators over every range in the snapshot, valid while it stays mapped
+        Time Complexity: O(1)
+    */
+    Iterator begin() const { return Iterator(starts, ends); }
+    Iterator end() const { return Iterator(starts + count, ends + count); }
+
+    /*
+        Convenience function to print the start and endpoints of the range in reverse order.
+        Returns nothing, but prints to stdout.
+        Used for Debugging.
+    */
+    void printAll() const;
+
+    /*
+        Convenience function to serialize the range into a list of start and end points.
+        Returns a list in reverse order, matching Range::toVec.
+        Used for Testcase Verification.
+    */
+    std::vector<Key> toVec() const;
+};
+
+// the definitions live in RangeSnapshot.cpp, which builds them for the same
+// coordinate types as Range
+extern template class BasicMappedRange<std::int32_t>;
+extern template class BasicMappedRange<std::int64_t>;
+extern template class BasicMappedRange<std::uint64_t>;
+
+typedef BasicMappedRange<std::int32_t> MappedRange;
+#endif
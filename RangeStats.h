@@ -0,0 +1,241 @@
+#ifndef _RANGE_STATS_H_
+#define _RANGE_STATS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Histogram of the latencies of one kind of call, in buckets of powers of two
+    nanoseconds, so that the rare slow calls stand out from the common fast ones
+*/
+struct LatencyHistogram
+{
+    static constexpr std::size_t Buckets = 40;
+
+    // buckets[i] counts the calls that took from 2^i up to 2^(i + 1) nanoseconds,
+    // with the calls that took under a nanosecond counted in the first one
+    std::uint64_t buckets[Buckets] = {};
+
+    /*
+        Counts a call that took "ns" nanoseconds
+        Time Complexity: O(1)
+    */
+    void Record(std::uint64_t ns){
+        buckets[BucketOf(ns)]++;
+    }
+
+    /*
+        Returns the bucket a call that took "ns" nanoseconds is counted in
+        Time Complexity: O(1)
+    */
+    static std::size_t BucketOf(std::uint64_t ns){
+        std::size_t bucket = 0;
+        while (ns > 1 && bucket + 1 < Buckets){
+            ns >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    /*
+        Returns the number of calls counted
+    */
+    std::uint64_t Count() const{
+        std::uint64_t count = 0;
+        for (std::uint64_t calls : buckets){
+            count += calls;
+        }
+        return count;
+    }
+
+    /*
+        Returns the number of nanoseconds that at least "fraction" of the calls took
+        less than, rounded up to a power of two, or 0 if no calls were counted
+
+        fraction: The fraction of the calls, from 0 to 1, e.g. 0.99 for the 99th percentile
+    */
+    std::uint64_t Percentile(double fraction) const{
+        std::uint64_t count = Count();
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < Buckets; i++){
+            seen += buckets[i];
+            if (seen > 0 && seen >= fraction * count){
+                return std::uint64_t(2) << i;
+            }
+        }
+        return 0;
+    }
+};
+
+/*
+    What a Range has been doing, as returned by Range::Stats
+    The counters are only kept when the program is built with RANGE_STATS
+    defined; otherwise "enabled" is false and everything else is zero.
+    Only the calls made through Add, Delete and Get are counted, not the
+    batch or set algebra functions.
+*/
+struct RangeStats
+{
+    // whether the counters are being kept
+    bool enabled = false;
+
+    // the number of calls to Add, Delete and Get
+    std::uint64_t adds = 0;
+    std::uint64_t deletes = 0;
+    std::uint64_t gets = 0;
+
+    // existing ranges that an Add merged with, in total and the most in a single call
+    std::uint64_t merged = 0;
+    std::uint64_t maxMerged = 0;
+
+    // ranges Delete removed entirely, cut short at one end, or split in two
+    std::uint64_t erased = 0;
+    std::uint64_t trimmed = 0;
+    std::uint64_t split = 0;
+    // the most ranges a single Delete erased
+    std::uint64_t maxErased = 0;
+
+    // ranges returned by Get, in total and the most in a single call
+    std::uint64_t returned = 0;
+    std::uint64_t maxReturned = 0;
+
+    // the number of ranges when the stats were taken
+    std::size_t size = 0;
+    // the most nodes a search can visit with that many ranges, which is the
+    // height a red-black tree of that size can reach, 2log(n + 1)
+    std::size_t depth = 0;
+
+    LatencyHistogram addLatency;
+    LatencyHistogram deleteLatency;
+    LatencyHistogram getLatency;
+};
+
+/*
+    A counter that any number of threads can update at once, with relaxed atomics,
+    since nothing else is ordered by it
+    Copying it copies the count it has at the time
+*/
+class RelaxedCounter
+{
+private:
+    std::atomic<std::uint64_t> count;
+public:
+    RelaxedCounter() : count(0) {}
+    RelaxedCounter(const RelaxedCounter& other) noexcept : count(other.Load()) {}
+    RelaxedCounter& operator=(const RelaxedCounter& other) noexcept{
+        count.store(other.Load(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    void operator++(int){ count.fetch_add(1, std::memory_order_relaxed); }
+    void operator+=(std::uint64_t by){ count.fetch_add(by, std::memory_order_relaxed); }
+
+    /*
+        Sets the counter to "value" if that is larger than its count
+    */
+    void Raise(std::uint64_t value){
+        std::uint64_t current = Load();
+        while (current < value && !count.compare_exchange_weak(current, value, std::memory_order_relaxed)){}
+    }
+
+    std::uint64_t Load() const{ return count.load(std::memory_order_relaxed); }
+};
+
+/*
+    LatencyHistogram whose buckets any number of threads can count calls in at once
+*/
+struct ConcurrentLatencyHistogram
+{
+    RelaxedCounter buckets[LatencyHistogram::Buckets];
+
+    /*
+        Counts a call that took "ns" nanoseconds
+        Time Complexity: O(1)
+    */
+    void Record(std::uint64_t ns){
+        buckets[LatencyHistogram::BucketOf(ns)]++;
+    }
+
+    /*
+        Returns the counts of the buckets so far
+        Calls counted meanwhile may or may not be included
+    */
+    LatencyHistogram Load() const{
+        LatencyHistogram ret;
+        for (std::size_t i = 0; i < LatencyHistogram::Buckets; i++){
+            ret.buckets[i] = buckets[i].Load();
+        }
+        return ret;
+    }
+};
+
+/*
+    The counters behind RangeStats, as a Range keeps them when built with RANGE_STATS
+    Every counter is atomic, so that several threads can call Get, which is const,
+    on the same Range at once, as they can on a standard container, without racing
+    on the counters
+*/
+struct RangeCounters
+{
+    RelaxedCounter adds;
+    RelaxedCounter deletes;
+    RelaxedCounter gets;
+    RelaxedCounter merged;
+    RelaxedCounter maxMerged;
+    RelaxedCounter erased;
+    RelaxedCounter trimmed;
+    RelaxedCounter split;
+    RelaxedCounter maxErased;
+    RelaxedCounter returned;
+    RelaxedCounter maxReturned;
+    ConcurrentLatencyHistogram addLatency;
+    ConcurrentLatencyHistogram deleteLatency;
+    ConcurrentLatencyHistogram getLatency;
+
+    /*
+        Returns the counters so far, leaving "size" and "depth" for the Range to fill in
+        Each counter is read separately, so calls made meanwhile may be counted by
+        some of them and not others
+    */
+    RangeStats Load() const{
+        RangeStats ret;
+        ret.enabled = true;
+        ret.adds = adds.Load();
+        ret.deletes = deletes.Load();
+        ret.gets = gets.Load();
+        ret.merged = merged.Load();
+        ret.maxMerged = maxMerged.Load();
+        ret.erased = erased.Load();
+        ret.trimmed = trimmed.Load();
+        ret.split = split.Load();
+        ret.maxErased = maxErased.Load();
+        ret.returned = returned.Load();
+        ret.maxReturned = maxReturned.Load();
+        ret.addLatency = addLatency.Load();
+        ret.deleteLatency = deleteLatency.Load();
+        ret.getLatency = getLatency.Load();
+        return ret;
+    }
+};
+
+/*
+    Records the time from its construction to its destruction in "histogram"
+*/
+class ScopedLatency
+{
+private:
+    ConcurrentLatencyHistogram& histogram;
+    std::chrono::steady_clock::time_point start;
+public:
+    explicit ScopedLatency(ConcurrentLatencyHistogram& histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+    ~ScopedLatency(){
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        histogram.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+};
+#endif
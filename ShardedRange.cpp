@@ -0,0 +1,207 @@
+#include "ShardedRange.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    /*
+        Holds the locks of a contiguous run of shards, taking them in increasing
+        order on construction and releasing them on destruction
+        Exclusive locks are taken unless "shared" is set
+    */
+    template <typename Shard>
+    class ShardLocks
+    {
+    private:
+        Shard* first;
+        Shard* last;
+        bool shared;
+    public:
+        ShardLocks(Shard* first, Shard* last, bool shared) : first(first), last(last), shared(shared) {
+            for (Shard* shard = first; shard <= last; shard++){
+                if (shared){
+                    shard->lock.lock_shared();
+                } else {
+                    shard->lock.lock();
+                }
+            }
+        }
+        ~ShardLocks() {
+            for (Shard* shard = first; shard <= last; shard++){
+                if (shared){
+                    shard->lock.unlock_shared();
+                } else {
+                    shard->lock.unlock();
+                }
+            }
+        }
+        ShardLocks(const ShardLocks&) = delete;
+        ShardLocks& operator=(const ShardLocks&) = delete;
+    };
+}
+
+/*
+    Creates a set split into "count" shards of equal width between "lowest" and "highest"
+*/
+ShardedRange::ShardedRange(std::size_t count, int lowest, int highest) {
+    if (highest <= lowest){
+        throw std::invalid_argument("ShardedRange: highest must be above lowest");
+    }
+    // the widths are computed in 64 bits, as highest - lowest may not fit in an int,
+    // and the count is converted first, so that the division stays signed
+    long long width = (static_cast<long long>(highest) - lowest) / static_cast<long long>(std::max<std::size_t>(count, 1));
+    for (std::size_t i = 1; i < count; i++){
+        boundaries.push_back(static_cast<int>(lowest + width * static_cast<long long>(i)));
+    }
+    shards.reset(new Shard[boundaries.size() + 1]);
+}
+
+/*
+    Creates a set split at the given boundaries, in increasing order
+*/
+ShardedRange::ShardedRange(const std::vector<int>& boundaries) : boundaries(boundaries) {
+    // out of order boundaries would hand the same points to several shards,
+    // and let a selection's last shard come before its first
+    if (std::adjacent_find(boundaries.begin(), boundaries.end(), std::greater_equal<int>()) != boundaries.end()){
+        throw std::invalid_argument("ShardedRange: boundaries must be strictly increasing");
+    }
+    shards.reset(new Shard[boundaries.size() + 1]);
+}
+
+/*
+    Returns the index of the shard containing "value"
+    Time Complexity: O(log s), s being the number of shards
+*/
+std::size_t ShardedRange::shardOf(int value) const{
+    return std::upper_bound(boundaries.begin(), boundaries.end(), value) - boundaries.begin();
+}
+
+/*
+    Returns the indices of the first and last shard overlapping the selection range
+    The selection must not be empty
+*/
+std::pair<std::size_t, std::size_t> ShardedRange::shardsOf(int start, int end) const{
+    // "end" itself isn't part of the selection, so if it falls exactly on a
+    // boundary, the shard starting there isn't touched
+    std::size_t last = std::lower_bound(boundaries.begin(), boundaries.end(), end) - boundaries.begin();
+    return std::make_pair(shardOf(start), last);
+}
+
+/*
+    Returns the selection range clipped to shard "index"
+*/
+std::pair<int, int> ShardedRange::clip(std::size_t index, int start, int end) const{
+    if (index > 0){
+        start = std::max(start, boundaries[index - 1]);
+    }
+    if (index < boundaries.size()){
+        end = std::min(end, boundaries[index]);
+    }
+    return std::make_pair(start, end);
+}
+
+/*
+    Adds a range to the data structure, merging together existing
+    ranges if neccessary
+    Each shard gets the part of the range that lies within it
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn)
+*/
+void ShardedRange::Add(int start, int end){
+    // an empty selection covers nothing, so there is nothing to add
+    if (start >= end){
+        return;
+    }
+    auto touched = shardsOf(start, end);
+    ShardLocks<const Shard> locks(&shards[touched.first], &shards[touched.second], false);
+    for (std::size_t i = touched.first; i <= touched.second; i++){
+        auto piece = clip(i, start, end);
+        shards[i].range.Add(piece.first, piece.second);
+    }
+}
+
+/*
+    Removes ranges that exist within the data structure
+    that intersect with the selection range
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(logn)
+*/
+void ShardedRange::Delete(int start, int end){
+    // an empty selection covers nothing, so there is nothing to remove
+    if (start >= end){
+        return;
+    }
+    auto touched = shardsOf(start, end);
+    ShardLocks<const Shard> locks(&shards[touched.first], &shards[touched.second], false);
+    for (std::size_t i = touched.first; i <= touched.second; i++){
+        auto piece = clip(i, start, end);
+        shards[i].range.Delete(piece.first, piece.second);
+    }
+}
+
+/*
+    Returns a list of ranges that exist within the data structure
+    that intersect with the selection range
+    Pieces of the same range in neighbouring shards touch at the boundary
+    between them, and get stitched back together
+
+    start: The start of the selection range
+    end: The end of the selection range
+    Time Complexity: O(n)
+*/
+std::vector<std::pair<int, int>> ShardedRange::Get(int start, int end) const{
+    std::vector<std::pair<int, int>> ret;
+    // an empty selection can't intersect anything
+    if (start >= end){
+        return ret;
+    }
+    auto touched = shardsOf(start, end);
+    ShardLocks<const Shard> locks(&shards[touched.first], &shards[touched.second], true);
+    for (std::size_t i = touched.first; i <= touched.second; i++){
+        auto piece = clip(i, start, end);
+        shards[i].range.ForEach(piece.first, piece.second, [&](int first, int second){
+            if (!ret.empty() && ret.back().second == first){
+                ret.back().second = second;
+            } else {
+                ret.push_back(std::make_pair(first, second));
+            }
+        });
+    }
+    return ret;
+}
+
+/*
+    Convenience function to print the start and endpoints of the range in reverse order.
+    Returns nothing, but prints to stdout.
+    Used for Debugging.
+*/
+void ShardedRange::printAll() const{
+    for (auto&& elem : toVec()){
+        std::cout << elem << ", ";
+    }
+    std::cout << std::endl;
+}
+
+/*
+    Convenience function to serialize the range into a list of start and end points.
+    Returns a list in reverse order, matching Range::toVec.
+    Used for Testcase Verification.
+*/
+std::vector<int> ShardedRange::toVec() const{
+    // every range lies between the lowest and highest int, and the highest int
+    // itself can't be covered, so this selection returns all of them
+    auto all = Get(std::numeric_limits<int>::lowest(), std::numeric_limits<int>::max());
+    std::vector<int> vec;
+    vec.reserve(2 * all.size());
+    for (auto iter = all.rbegin(); iter != all.rend(); iter++){
+        vec.push_back(iter->second);
+        vec.push_back(iter->first);
+    }
+    return vec;
+}
@@ -0,0 +1,129 @@
+#ifndef _SHARDED_RANGE_H_
+#define _SHARDED_RANGE_H_
+
+#include "Range.h"
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+/*
+    Thread safe variant of Range that splits the coordinate space into contiguous
+    shards, each backed by its own Range and lock, so that modifications to
+    different shards run in parallel.
+
+    A range spanning several shards is stored as one piece per shard, split at
+    the shard boundaries; Get and toVec stitch the pieces back together, so the
+    results are exactly those of a single Range. Operations lock every shard they
+    touch (in increasing order, so they can't deadlock), which makes each of them
+    atomic, even across shards. Get only takes the locks in shared mode, so reads
+    never block each other.
+*/
+class ShardedRange
+{
+private:
+    // a single partition of the coordinate space
+    struct Shard
+    {
+        Range range;
+        mutable std::shared_mutex lock;
+    };
+
+    // boundaries[i] is where shard i ends and shard i + 1 begins
+    // the first shard extends down to the lowest int, the last up to the highest
+    std::vector<int> boundaries;
+    std::unique_ptr<Shard[]> shards;
+
+    /*
+        Returns the index of the shard containing "value"
+        Time Complexity: O(log s), s being the number of shards
+    */
+    std::size_t shardOf(int value) const;
+
+    /*
+        Returns the indices of the first and last shard overlapping the selection range
+        The selection must not be empty
+    */
+    std::pair<std::size_t, std::size_t> shardsOf(int start, int end) const;
+
+    /*
+        Returns the selection range clipped to shard "index"
+    */
+    std::pair<int, int> clip(std::size_t index, int start, int end) const;
+public:
+    /*
+        Creates a set split into "count" shards of equal width between "lowest" and
+        "highest". Values below "lowest" go in the first shard, values at or above
+        "highest" in the last.
+        Throws std::invalid_argument if "highest" isn't above "lowest"
+
+        count: number of shards, at least 1
+        lowest: the start of the first shard's share of the coordinates; the first
+        shard ends, and the second one starts, one width above it
+        highest: the end of the last shard's share of the coordinates, give or take
+        the rounding of the width
+    */
+    ShardedRange(std::size_t count = 16, int lowest = 0, int highest = 1 << 30);
+
+    /*
+        Creates a set split at the given boundaries, in increasing order,
+        so that there is one more shard than there are boundaries
+        Throws std::invalid_argument if the boundaries aren't strictly increasing
+
+        boundaries: the points where each shard ends and the next one begins
+    */
+    explicit ShardedRange(const std::vector<int>& boundaries);
+
+    /*
+        Adds a range to the data structure, merging together existing
+        ranges if neccessary
+        Blocks operations on the shards the range overlaps
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn)
+    */
+    void Add(int, int);
+
+    /*
+        Removes ranges that exist within the data structure
+        that intersect with the selection range
+        Blocks operations on the shards the range overlaps
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(logn)
+    */
+    void Delete(int, int);
+
+    /*
+        Returns a list of ranges that exist within the data structure
+        that intersect with the selection range
+        Only blocks modifications to the shards the range overlaps
+
+        start: The start of the selection range
+        end: The end of the selection range
+        Time Complexity: O(n)
+    */
+    std::vector<std::pair<int, int>> Get(int, int) const;
+
+    /*
+        Returns the number of shards
+    */
+    std::size_t ShardCount() const { return boundaries.size() + 1; }
+
+    /*
+        Convenience function to print the start and endpoints of the range in reverse order.
+        Returns nothing, but prints to stdout.
+        Used for Debugging.
+    */
+    void printAll() const;
+
+    /*
+        Convenience function to serialize the range into a list of start and end points.
+        Returns a list in reverse order, matching Range::toVec.
+        Used for Testcase Verification.
+    */
+    std::vector<int> toVec() const;
+};
+#endif
@@ -1,7 +1,34 @@
 #include "Tests.h"
 #include "Range.h"
+#include "FlatRange.h"
+#include "HybridRange.h"
+#include "BTreeRange.h"
+#include "ConcurrentRange.h"
+#include "ShardedRange.h"
+#include "RangeSnapshot.h"
+#include "DurableRange.h"
+#include "PersistentRange.h"
+#include "RangeMap.h"
+#include "CompressedRange.h"
+#include "IngestRange.h"
+#include "DifferentialFuzz.h"
 #include <assert.h>
+#include <cstdio>
 #include <iostream>
+#include <cstdint>
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <stdexcept>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include <csignal>
+#include <sys/resource.h>
+#include <sys/stat.h>
 
 // macro used to declutter output with success messages
 // only prints out failed testcases if enabled
@@ -12,11 +39,12 @@
     Function used to verify correctness of the Add and deleteRange functions
     Checks input "range" against "ans" and prints message dependant on whether they match or not
 
-    range: Range object to be verified
+    range: Range (or other backend) object to be verified
     ans: expected output from toVec() called on Range object
     funcname: name of function calling verifyAnswer
 */
-void verifyAnswer(const Range& range, const std::vector<int>& ans, const char* funcname){
+template <typename RangeType, typename Key>
+void verifyAnswer(const RangeType& range, const std::vector<Key>& ans, const char* funcname){
     bool success = (range.toVec() == ans);
 #if ONLY_PRINT_FAILURES 
     if (success){
@@ -49,8 +77,9 @@ void verifyAnswer(const Range& range, const std::vector<int>& ans, const char* f
     ans: expected output from Get function 
     funcname: name of function calling verifyAnswer
 */
-void verifyAnswer(const std::vector<std::pair<int, int>>& actual, 
-    const std::vector<std::pair<int, int>>& expected, const char* funcname){
+template <typename Key>
+void verifyAnswer(const std::vector<std::pair<Key, Key>>& actual, 
+    const std::vector<std::pair<Key, Key>>& expected, const char* funcname){
     bool success = (actual == expected);
 #if ONLY_PRINT_FAILURES 
     if (success){
@@ -78,11 +107,36 @@ void verifyAnswer(const std::vector<std::pair<int, int>>& actual,
     std::cout << "--------------------------------------" << std::endl;
 }
 
+/*
+    Function used to verify correctness of the GetBatch function
+    Checks every list in "actual" against the matching list in "expected"
+
+    actual: actual output from GetBatch function
+    expected: expected output from GetBatch function
+    funcname: name of function calling verifyAnswer
+*/
+void verifyAnswer(const std::vector<std::vector<std::pair<int, int>>>& actual,
+    const std::vector<std::vector<std::pair<int, int>>>& expected, const char* funcname){
+    std::vector<std::pair<int, int>> flatActual;
+    std::vector<std::pair<int, int>> flatExpected;
+    // lists are separated by a (0, 0) pair, which Get never returns
+    for (auto&& list : actual){
+        flatActual.insert(flatActual.end(), list.begin(), list.end());
+        flatActual.push_back(std::make_pair(0, 0));
+    }
+    for (auto&& list : expected){
+        flatExpected.insert(flatExpected.end(), list.begin(), list.end());
+        flatExpected.push_back(std::make_pair(0, 0));
+    }
+    verifyAnswer(flatActual, flatExpected, funcname);
+}
+
 // tests adding a range that is already contained in another
 // should add nothing to data structure
+template <typename RangeType>
 void addIntoExistingRegion()
 {
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(2, 8);
     std::vector<int> ans = {10, 0};
@@ -91,9 +145,10 @@ void addIntoExistingRegion()
 
 // tests adding a range into an empty region
 // should add normally to data structure
+template <typename RangeType>
 void addIntoEmptyRegion()
 {
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(11, 20);
     std::vector<int> ans = {20, 11, 10, 0};
@@ -102,9 +157,10 @@ void addIntoEmptyRegion()
 
 // tests adding a range that overlaps an existing one
 // should extend existing range's start and end
+template <typename RangeType>
 void addOverExistingRegion()
 {
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -115,8 +171,9 @@ void addOverExistingRegion()
 
 // tests adding a range that overlaps an existing one but has the same start point
 // should extend existing range's end
+template <typename RangeType>
 void addOverExistingRegionLeftBoundary(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -127,8 +184,9 @@ void addOverExistingRegionLeftBoundary(){
 
 // tests adding a range that overlaps an existing one but has the same end point
 // should extend existing range's start 
+template <typename RangeType>
 void addOverExistingRegionRightBoundary(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -139,8 +197,9 @@ void addOverExistingRegionRightBoundary(){
 
 // tests adding a range that overlaps multiple existing ranges
 // should merge into the union of all ranges involved
+template <typename RangeType>
 void addOverMultipleRegions(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -154,8 +213,9 @@ void addOverMultipleRegions(){
 
 // tests adding a range that contains an existing range and partially contains another
 // should merge all existing ranges
+template <typename RangeType>
 void addPartialOverlapLeft(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(5, 35);
@@ -165,8 +225,9 @@ void addPartialOverlapLeft(){
 
 // also tests adding a range that fully contains an existing range and partially contains another
 // should merge all existing ranges
+template <typename RangeType>
 void addPartialOverlapRight(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(10, 20);
     range.Add(30, 40);
     range.Add(5, 35);
@@ -176,8 +237,9 @@ void addPartialOverlapRight(){
 
 // tests adding a range that partially contains two ranges
 // should merge all existing ranges
+template <typename RangeType>
 void addPartialOverlapBoth(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(30, 40);
     range.Add(5, 35);
@@ -187,8 +249,9 @@ void addPartialOverlapBoth(){
 
 // tests adding range that overlaps leftmost existing range
 // should extend that range both ways
+template <typename RangeType>
 void addOverLeftMostRegion(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -199,8 +262,9 @@ void addOverLeftMostRegion(){
 
 // tests adding range that overlaps rightmost existing range
 // should extend that range both ways
+template <typename RangeType>
 void addOverRightMostRegion(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -211,8 +275,9 @@ void addOverRightMostRegion(){
 
 // tests adding range that overlaps existing range in the middle
 // should extend that range both ways
+template <typename RangeType>
 void addOverMiddleRegion(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30); 
     range.Add(40, 50);
@@ -224,8 +289,9 @@ void addOverMiddleRegion(){
 // tests adding a range that contains an existing range and partially contains another
 // also starts at the same start point as the existing range
 // should merge all ranges
+template <typename RangeType>
 void addPartialOverlapBoundaryLeft(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(30, 40);
     range.Add(0, 35);
@@ -237,8 +303,9 @@ void addPartialOverlapBoundaryLeft(){
 // tests adding a range that contains an existing range and partially contains another
 // also ends at the same end point as the existing range
 // should merge all ranges
+template <typename RangeType>
 void addPartialOverlapBoundaryRight(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(30, 40);
     range.Add(5, 40);
@@ -251,8 +318,9 @@ void addPartialOverlapBoundaryRight(){
 // new range starts at the same start point as one of the existing ranges and 
 // ends at the same end point as the other existing range
 // should merge all ranges
+template <typename RangeType>
 void addFullOverlapBoundary(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(30, 40);
     range.Add(0, 40);
@@ -263,8 +331,9 @@ void addFullOverlapBoundary(){
 
 // tests adding an already existing range to data structure
 // should not change existing ranges
+template <typename RangeType>
 void addDuplicateRanges(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(0, 10);
 
@@ -274,8 +343,9 @@ void addDuplicateRanges(){
 
 // tests extending an existing range to the left
 // should extend existing range
+template <typename RangeType>
 void addExtendLeft(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(-10, 5);
     
@@ -285,8 +355,9 @@ void addExtendLeft(){
 
 // tests extending an existing range to the right
 // should extend existing range
+template <typename RangeType>
 void addExtendRight(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(5, 20);
     
@@ -294,35 +365,51 @@ void addExtendRight(){
     verifyAnswer(range, ans, __FUNCTION__);  
 }
 
+// tests adding a range whose start is not before its end
+// should add nothing to data structure
+template <typename RangeType>
+void addEmptyRange(){
+    RangeType range = RangeType();
+    range.Add(0, 10);
+    range.Add(20, 20);
+    range.Add(40, 30);
+
+    std::vector<int> ans = {10, 0};
+    verifyAnswer(range, ans, __FUNCTION__);
+}
+
 /*
     Runs all of the test cases pertaining to the Add function
 */
+template <typename RangeType>
 void addTests()
 {
-    addIntoExistingRegion();
-    addIntoEmptyRegion();
-
-    addOverExistingRegion();
-    addOverExistingRegionLeftBoundary();
-    addOverExistingRegionRightBoundary();
-    addOverMultipleRegions();
-    addDuplicateRanges();
-    addExtendLeft();
-    addExtendRight();
-
-    addOverLeftMostRegion();
-    addPartialOverlapLeft();
-    addPartialOverlapRight();
-    addPartialOverlapBoth();
-    addPartialOverlapBoundaryLeft();
-    addPartialOverlapBoundaryRight();
-    addFullOverlapBoundary();
+    addIntoExistingRegion<RangeType>();
+    addIntoEmptyRegion<RangeType>();
+
+    addOverExistingRegion<RangeType>();
+    addOverExistingRegionLeftBoundary<RangeType>();
+    addOverExistingRegionRightBoundary<RangeType>();
+    addOverMultipleRegions<RangeType>();
+    addDuplicateRanges<RangeType>();
+    addExtendLeft<RangeType>();
+    addExtendRight<RangeType>();
+
+    addOverLeftMostRegion<RangeType>();
+    addPartialOverlapLeft<RangeType>();
+    addPartialOverlapRight<RangeType>();
+    addPartialOverlapBoth<RangeType>();
+    addPartialOverlapBoundaryLeft<RangeType>();
+    addPartialOverlapBoundaryRight<RangeType>();
+    addFullOverlapBoundary<RangeType>();
+    addEmptyRange<RangeType>();
 }
 
 // tests removing from an empty data structure
 // should do nothing
+template <typename RangeType>
 void deleteNothing(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Delete(-5, 15);
     std::vector<int> ans = {}; 
     verifyAnswer(range, ans, __FUNCTION__);
@@ -330,8 +417,9 @@ void deleteNothing(){
 
 // tests removing part of an existing range
 // should delete middle part of range and leave sides in tact
+template <typename RangeType>
 void deleteNormal(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 20);
     range.Delete(5, 15);
     std::vector<int> ans = {20, 15, 5, 0}; 
@@ -341,8 +429,9 @@ void deleteNormal(){
 
 // tests removing part of an existing range
 // should delete left side of range and leave right side in tact
+template <typename RangeType>
 void deleteLeftBoundary(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 20);
     range.Delete(0, 15);
     std::vector<int> ans = {20, 15}; 
@@ -351,8 +440,9 @@ void deleteLeftBoundary(){
 
 // tests removing part of an existing range
 // should delete right side of range and leave left side in tact
+template <typename RangeType>
 void deleteRightBoundary(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 20);
     range.Delete(5, 20);
     std::vector<int> ans = {5, 0}; 
@@ -361,8 +451,9 @@ void deleteRightBoundary(){
 
 // tests removing multiple ranges from data structure
 // should render data structure empty
+template <typename RangeType>
 void deleteMultipleIntervals(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -374,8 +465,9 @@ void deleteMultipleIntervals(){
 // tests removing multiple ranges from data structure
 // selection includes start point of leftmost range
 // should render data structure empty
+template <typename RangeType>
 void deleteMultipleIntervalsLeftBoundary(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -386,8 +478,9 @@ void deleteMultipleIntervalsLeftBoundary(){
 // tests removing multiple ranges from data structure
 // selection includes end point of rightmost range
 // should render data structure empty
+template <typename RangeType>
 void deleteMultipleIntervalsRightBoundary(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -400,8 +493,9 @@ void deleteMultipleIntervalsRightBoundary(){
 // selection includes end point of rightmost range 
 // and start point of leftmost ranges
 // should render data structure empty
+template <typename RangeType>
 void deleteMultipleIntervalsBothBoundaries(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -412,8 +506,9 @@ void deleteMultipleIntervalsBothBoundaries(){
 
 // tests removing multiple times from same range
 // should leave holes in range where deletion occured
+template <typename RangeType>
 void deleteMultipleFromInterval(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 40);
     range.Delete(5, 15);
     range.Delete(25, 35);
@@ -423,8 +518,9 @@ void deleteMultipleFromInterval(){
 
 // tests removing multiple times from multiple ranges
 // should leave holes where deletion occured
+template <typename RangeType>
 void deleteMultipleTimesMultipleIntervals(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 20);
     range.Add(40, 60);
     range.Add(80, 100);
@@ -436,8 +532,9 @@ void deleteMultipleTimesMultipleIntervals(){
 
 // tests removing leftmost existing range
 // should delete leftmost existing range
+template <typename RangeType>
 void deleteLeftMostRegion(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -448,8 +545,9 @@ void deleteLeftMostRegion(){
 
 // tests removing rightmost existing range
 // should delete righrmost existing range
+template <typename RangeType>
 void deleteRightMostRegion(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -460,8 +558,9 @@ void deleteRightMostRegion(){
 
 // tests removing leftmost existing range
 // should delete leftmost existing range
+template <typename RangeType>
 void deleteMiddleRegion(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -470,32 +569,46 @@ void deleteMiddleRegion(){
     verifyAnswer(range, ans, __FUNCTION__);
 }
 
+// tests removing an empty selection from inside an existing range
+// should not split the existing range
+template <typename RangeType>
+void deleteEmptyRange(){
+    RangeType range = RangeType();
+    range.Add(0, 10);
+    range.Delete(5, 5);
+    std::vector<int> ans = {10, 0};
+    verifyAnswer(range, ans, __FUNCTION__);
+}
+
 /*
     Runs all of the test cases pertaining to the Delete function
 */
+template <typename RangeType>
 void deleteTests()
 {
-    deleteNothing();
-    deleteNormal();
-    deleteLeftBoundary();
-    deleteRightBoundary();
-    deleteMultipleFromInterval();
-
-    deleteMultipleIntervals();
-    deleteMultipleIntervalsLeftBoundary();
-    deleteMultipleIntervalsRightBoundary();
-    deleteMultipleIntervalsBothBoundaries();
-    deleteMultipleTimesMultipleIntervals();
-
-    deleteLeftMostRegion();
-    deleteRightMostRegion();
-    deleteMiddleRegion();
+    deleteNothing<RangeType>();
+    deleteNormal<RangeType>();
+    deleteLeftBoundary<RangeType>();
+    deleteRightBoundary<RangeType>();
+    deleteMultipleFromInterval<RangeType>();
+
+    deleteMultipleIntervals<RangeType>();
+    deleteMultipleIntervalsLeftBoundary<RangeType>();
+    deleteMultipleIntervalsRightBoundary<RangeType>();
+    deleteMultipleIntervalsBothBoundaries<RangeType>();
+    deleteMultipleTimesMultipleIntervals<RangeType>();
+
+    deleteLeftMostRegion<RangeType>();
+    deleteRightMostRegion<RangeType>();
+    deleteMiddleRegion<RangeType>();
+    deleteEmptyRange<RangeType>();
 }
 
 // tests getting an empty range
 // should return nothing
+template <typename RangeType>
 void getEmptyInterval(){
-    Range range = Range();
+    RangeType range = RangeType();
     auto res = range.Get(-10, 10);
     std::vector<std::pair<int, int>> ans = {}; 
     verifyAnswer(res, ans, __FUNCTION__);    
@@ -503,8 +616,9 @@ void getEmptyInterval(){
 
 // tests getting a range with overlap on both sides
 // should return the entire range in the data structure
+template <typename RangeType>
 void getIntervalOvelappingBothSides(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     auto res = range.Get(-5, 15);
     std::vector<std::pair<int, int>> ans = {{0, 10}}; 
@@ -513,8 +627,9 @@ void getIntervalOvelappingBothSides(){
 
 // tests getting a range that is contained inside of existing range
 // should return part of the range
+template <typename RangeType>
 void getPartialInterval(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     auto res = range.Get(2, 8);
     std::vector<std::pair<int, int>> ans = {{2, 8}}; 
@@ -524,8 +639,9 @@ void getPartialInterval(){
 // tests getting a range that is contained inside of existing range
 // selection includes start point of range
 // should return part of the range
+template <typename RangeType>
 void getPartialIntervalLeftBoundary(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     auto res = range.Get(0, 8);
     std::vector<std::pair<int, int>> ans = {{0, 8}}; 
@@ -535,8 +651,9 @@ void getPartialIntervalLeftBoundary(){
 // tests getting a range that is contained inside of existing range
 // selection includes endpoint of range
 // should return part of the range
+template <typename RangeType>
 void getPartialIntervalRightBoundary(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     auto res = range.Get(2, 10);
     std::vector<std::pair<int, int>> ans = {{2, 10}}; 
@@ -545,8 +662,9 @@ void getPartialIntervalRightBoundary(){
 
 // tests getting multiple disjoint ranges with selection overlapping ranges
 // should return list of all ranges in data structure
+template <typename RangeType>
 void getMultipleIntervalsOver(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     auto res = range.Get(-10, 40);
@@ -556,8 +674,9 @@ void getMultipleIntervalsOver(){
 
 // tests getting multiple disjoint ranges with exact selection
 // should return list of all ranges in data structure
+template <typename RangeType>
 void getMultipleIntervalsBoundary(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     auto res = range.Get(0, 30);
@@ -567,8 +686,9 @@ void getMultipleIntervalsBoundary(){
 
 // tests getting an entire range and part of another
 // should return one whole range and one partial range
+template <typename RangeType>
 void getMultipleIntervalsLeftPartial(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     auto res = range.Get(5, 30);
@@ -578,8 +698,9 @@ void getMultipleIntervalsLeftPartial(){
 
 // also tests getting an entire range and part of another
 // should return one whole range and one partial range
+template <typename RangeType>
 void getMultipleIntervalsRightPartial(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     auto res = range.Get(0, 25);
@@ -589,8 +710,9 @@ void getMultipleIntervalsRightPartial(){
 
 // tests getting an parts of two ranges
 // should return two partial ranges
+template <typename RangeType>
 void getMultipleIntervalsBothPartial(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -601,8 +723,9 @@ void getMultipleIntervalsBothPartial(){
 
 // tests getting the leftmost range in the data structure
 // should return the leftmost range in the data structure
+template <typename RangeType>
 void getLeftMostInterval(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -613,8 +736,9 @@ void getLeftMostInterval(){
 
 // tests getting the rightmost range in the data structure
 // should return the rightmost range in the data structure
+template <typename RangeType>
 void getRightMostInterval(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -625,8 +749,9 @@ void getRightMostInterval(){
 
 // tests getting the middle range in the data structure
 // should return the middle range in the data structure
+template <typename RangeType>
 void getMiddleInterval(){
-    Range range = Range();
+    RangeType range = RangeType();
     range.Add(0, 10);
     range.Add(20, 30);
     range.Add(40, 50);
@@ -635,44 +760,2888 @@ void getMiddleInterval(){
     verifyAnswer(res, ans, __FUNCTION__);        
 }
 
+// tests getting a selection that ends exactly where a range begins
+// should not return an empty range for the range outside the selection
+template <typename RangeType>
+void getEndingAtIntervalStart(){
+    RangeType range = RangeType();
+    range.Add(0, 10);
+    range.Add(20, 30);
+    auto res = range.Get(5, 20);
+    std::vector<std::pair<int, int>> ans = {{5, 10}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests getting an empty selection inside an existing range
+// should return nothing
+template <typename RangeType>
+void getEmptySelection(){
+    RangeType range = RangeType();
+    range.Add(0, 10);
+    auto res = range.Get(5, 5);
+    std::vector<std::pair<int, int>> ans = {};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
 /*
     Runs all of the test cases pertaining to the Get function
 */
+template <typename RangeType>
 void getTests()
 {
-    getEmptyInterval();
-    getPartialInterval();
-    getPartialIntervalLeftBoundary();
-    getPartialIntervalRightBoundary();
-    getIntervalOvelappingBothSides();
+    getEmptyInterval<RangeType>();
+    getPartialInterval<RangeType>();
+    getPartialIntervalLeftBoundary<RangeType>();
+    getPartialIntervalRightBoundary<RangeType>();
+    getIntervalOvelappingBothSides<RangeType>();
+
+    getMultipleIntervalsLeftPartial<RangeType>();
+    getMultipleIntervalsRightPartial<RangeType>();
+    getMultipleIntervalsOver<RangeType>();
+    getMultipleIntervalsBoundary<RangeType>();
+    getMultipleIntervalsBothPartial<RangeType>();
+
+    getLeftMostInterval<RangeType>();
+    getMiddleInterval<RangeType>();
+    getRightMostInterval<RangeType>();
+    getEndingAtIntervalStart<RangeType>();
+    getEmptySelection<RangeType>();
+}
+
+// tests adding an unsorted batch of overlapping, touching and empty ranges
+// should match adding the same ranges one at a time
+template <typename RangeType>
+void addBatchUnsorted(){
+    std::vector<std::pair<int, int>> batch = {{40, 45}, {0, 5}, {3, 8}, {60, 60}, {8, 12}, {25, 30}, {-20, -10}};
+    RangeType range = RangeType();
+    range.Add(20, 26);
+    range.Add(44, 50);
+    range.Add(70, 80);
+    RangeType expected = RangeType();
+    expected.Add(20, 26);
+    expected.Add(44, 50);
+    expected.Add(70, 80);
+    for (auto&& elem : batch){
+        expected.Add(elem.first, elem.second);
+    }
+    range.AddBatch(batch);
+    verifyAnswer(range, expected.toVec(), __FUNCTION__);
+}
 
-    getMultipleIntervalsLeftPartial();
-    getMultipleIntervalsRightPartial();
-    getMultipleIntervalsOver();
-    getMultipleIntervalsBoundary();
-    getMultipleIntervalsBothPartial();
+// tests removing an unsorted batch of overlapping ranges, some of which
+// split existing ranges and some of which span several of them
+// should match removing the same ranges one at a time
+template <typename RangeType>
+void deleteBatchUnsorted(){
+    std::vector<std::pair<int, int>> batch = {{55, 75}, {2, 4}, {3, 6}, {8, 8}, {-5, 1}, {38, 42}, {90, 95}};
+    RangeType range = RangeType();
+    range.Add(0, 10);
+    range.Add(20, 30);
+    range.Add(40, 50);
+    range.Add(60, 70);
+    range.DeleteBatch(batch);
+    std::vector<int> ans = {50, 42, 30, 20, 10, 6, 2, 1};
+    verifyAnswer(range, ans, __FUNCTION__);
+}
 
-    getLeftMostInterval();
-    getMiddleInterval();
-    getRightMostInterval();
+// tests getting an unsorted batch of overlapping selections, through a const
+// reference, since getting doesn't modify the set
+// should return the result of each Get in the order the selections were given
+template <typename RangeType>
+void getBatchUnsorted(){
+    RangeType range = RangeType();
+    range.Add(0, 10);
+    range.Add(20, 30);
+    range.Add(40, 50);
+    const RangeType& reader = range;
+    auto res = reader.GetBatch({{25, 45}, {-5, 5}, {5, 5}, {0, 50}, {12, 18}});
+    std::vector<std::vector<std::pair<int, int>>> ans = {
+        {{25, 30}, {40, 45}}, {{0, 5}}, {}, {{0, 10}, {20, 30}, {40, 50}}, {}
+    };
+    verifyAnswer(res, ans, __FUNCTION__);
 }
 
 /*
-    Runs all of the test cases
+    Runs all of the test cases pertaining to the batch functions
+*/
+template <typename RangeType>
+void batchTests()
+{
+    addBatchUnsorted<RangeType>();
+    deleteBatchUnsorted<RangeType>();
+    getBatchUnsorted<RangeType>();
+}
+
+// tests getting through a callback instead of a returned list
+// should visit the same clipped ranges as Get, in the same order
+void getForEach(){
+    Range range = Range();
+    range.Add(0, 10);
+    range.Add(20, 30);
+    range.Add(40, 50);
+    std::vector<std::pair<int, int>> res;
+    range.ForEach(5, 45, [&](int start, int end){
+        res.push_back(std::make_pair(start, end));
+    });
+    verifyAnswer(res, range.Get(5, 45), __FUNCTION__);
+}
+
+// tests getting into a caller supplied buffer that is too small
+// should fill the buffer and report how many ranges there were in total
+void getIntoBuffer(){
+    Range range = Range();
+    range.Add(0, 10);
+    range.Add(20, 30);
+    range.Add(40, 50);
+    std::pair<int, int> buffer[2];
+    std::size_t count = range.Get(5, 45, buffer, 2);
+    std::vector<std::pair<int, int>> res(buffer, buffer + 2);
+    res.push_back(std::make_pair(static_cast<int>(count), 0));
+    std::vector<std::pair<int, int>> ans = {{5, 10}, {20, 30}, {3, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests getting through an output iterator
+// should write the same clipped ranges as Get and return the iterator past them
+void getIntoOutputIterator(){
+    Range range = Range();
+    range.Add(0, 10);
+    range.Add(20, 30);
+    std::vector<std::pair<int, int>> res(3, std::make_pair(-1, -1));
+    auto last = range.Get(-5, 25, res.begin());
+    res.resize(last - res.begin());
+    std::vector<std::pair<int, int>> ans = {{0, 10}, {20, 25}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests iterating a view over a selection, including an empty selection
+// and a selection ending exactly where a range begins
+// should yield the same clipped ranges as Get
+void getView(){
+    Range range = Range();
+    range.Add(0, 10);
+    range.Add(20, 30);
+    range.Add(40, 50);
+    std::vector<std::pair<int, int>> res;
+    for (auto&& elem : range.GetView(5, 40)){
+        res.push_back(elem);
+    }
+    if (!range.GetView(12, 18).empty() || !range.GetView(25, 25).empty()){
+        res.clear();
+    }
+    std::vector<std::pair<int, int>> ans = {{5, 10}, {20, 30}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the test cases pertaining to the non-allocating Get functions
+*/
+void getNoAllocTests()
+{
+    getForEach();
+    getIntoBuffer();
+    getIntoOutputIterator();
+    getView();
+}
+
+// tests looking up single points on and around the boundaries of the ranges
+// should find the starts of the ranges covered and their ends uncovered
+template <typename RangeType>
+void containsPoints(){
+    RangeType range = RangeType();
+    range.Add(0, 10);
+    range.Add(20, 30);
+    std::vector<std::pair<int, int>> res;
+    for (int point : {-1, 0, 9, 10, 15, 19, 20, 29, 30}){
+        res.push_back(std::make_pair(point, range.Contains(point) ? 1 : 0));
+    }
+    std::vector<std::pair<int, int>> ans = {{-1, 0}, {0, 1}, {9, 1}, {10, 0}, {15, 0}, {19, 0}, {20, 1}, {29, 1}, {30, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests looking up many random points at once with every instruction set
+// the processor supports, including the extremes of int and a count that
+// doesn't fill the last word of the bitmap, and an empty set
+// should agree with Contains on every point
+void containsManyMatchesContains(){
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> dist(0, 100000);
+    FlatRange range = FlatRange();
+    for (int i = 0; i < 1000; i++){
+        int start = dist(gen);
+        range.Add(start, start + 1 + dist(gen) % 50);
+    }
+    std::vector<int> points(1003);
+    for (auto& point : points){
+        point = dist(gen);
+    }
+    points[0] = std::numeric_limits<int>::lowest();
+    points[1] = std::numeric_limits<int>::max();
+    FlatRange empty = FlatRange();
+    std::vector<std::pair<int, int>> res;
+    std::vector<std::pair<int, int>> ans;
+    for (FlatRange::Simd simd : {FlatRange::Simd::Scalar, FlatRange::Simd::SSE2, FlatRange::Simd::AVX2}){
+        if (simd > FlatRange::BestSimd()){
+            continue;
+        }
+        std::vector<std::uint64_t> bits((points.size() + 63) / 64, ~std::uint64_t(0));
+        std::vector<std::uint64_t> none((points.size() + 63) / 64, ~std::uint64_t(0));
+        range.ContainsMany(points.data(), points.size(), bits.data(), simd);
+        empty.ContainsMany(points.data(), points.size(), none.data(), simd);
+        int mismatches = 0;
+        for (std::size_t i = 0; i < points.size(); i++){
+            bool covered = (bits[i / 64] >> (i % 64)) & 1;
+            bool uncovered = !((none[i / 64] >> (i % 64)) & 1);
+            mismatches += (covered != range.Contains(points[i])) + !uncovered;
+        }
+        res.push_back(std::make_pair(static_cast<int>(simd), mismatches));
+        ans.push_back(std::make_pair(static_cast<int>(simd), 0));
+    }
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the test cases pertaining to looking up points
+*/
+void containsTests()
+{
+    containsPoints<Range>();
+    containsPoints<FlatRange>();
+    containsPoints<HybridRange>();
+    containsManyMatchesContains();
+}
+
+// tests the aggregate queries on selections covering several ranges, none,
+// part of one, and points inside, between, on the boundaries of and after the ranges
+// should match what adding up the results of Get gives, with -1 standing for no point
+template <typename RangeType>
+void aggregateQueries(){
+    RangeType range = RangeType();
+    range.Add(0, 10);
+    range.Add(20, 30);
+    range.Add(40, 50);
+    std::vector<std::pair<int, int>> res = {
+        {static_cast<int>(range.CoveredLength(5, 45)), static_cast<int>(range.CountIntervals(5, 45))},
+        {static_cast<int>(range.CoveredLength(10, 20)), static_cast<int>(range.CountIntervals(10, 20))},
+        {static_cast<int>(range.CoveredLength(25, 26)), static_cast<int>(range.CountIntervals(25, 26))},
+        {static_cast<int>(range.CoveredLength(-100, 100)), static_cast<int>(range.CountIntervals(-100, 100))},
+        {static_cast<int>(range.CoveredLength(30, 20)), static_cast<int>(range.CountIntervals(30, 20))},
+        {range.NextGap(5), range.NextGap(10)},
+        {range.NextGap(-5), range.NextGap(49)},
+        {range.FirstCovered(5).value_or(-1), range.FirstCovered(10).value_or(-1)},
+        {range.FirstCovered(-5).value_or(-1), range.FirstCovered(50).value_or(-1)}
+    };
+    std::vector<std::pair<int, int>> ans = {
+        {20, 3}, {0, 0}, {1, 1}, {30, 3}, {0, 0}, {10, 10}, {-5, 50}, {5, 20}, {0, -1}
+    };
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests the aggregate queries on random selections of a set built from
+// random additions and deletions, enough to split and merge B-tree nodes
+// should agree with adding up the results of Get, and with stepping
+// through the points one at a time
+template <typename RangeType>
+void aggregatesMatchGet(){
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> dist(0, 5000);
+    RangeType range = RangeType();
+    int mismatches = 0;
+    for (int round = 0; round < 2000; round++){
+        int start = dist(gen);
+        int end = start + dist(gen) % 40;
+        if (dist(gen) % 3 != 0){
+            range.Add(start, end);
+        } else {
+            range.Delete(start, end);
+        }
+        int from = dist(gen);
+        int to = from + dist(gen) % 500;
+        unsigned int length = 0;
+        std::vector<std::pair<int, int>> ranges = range.Get(from, to);
+        for (auto&& elem : ranges){
+            length += elem.second - elem.first;
+        }
+        mismatches += range.CoveredLength(from, to) != length;
+        mismatches += range.CountIntervals(from, to) != ranges.size();
+        int gap = from;
+        while (!range.Get(gap, gap + 1).empty()){
+            gap++;
+        }
+        mismatches += range.NextGap(from) != gap;
+        int covered = from;
+        while (covered <= 5100 && range.Get(covered, covered + 1).empty()){
+            covered++;
+        }
+        mismatches += range.FirstCovered(from).value_or(5101) != covered;
+    }
+    std::vector<std::pair<int, int>> res = {{0, mismatches}};
+    std::vector<std::pair<int, int>> ans = {{0, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests CoveredLength on a FlatRange after every kind of change that rewrites
+// its arrays, batches, bulk loading and swapping, and on a range spanning almost
+// every int, whose running total of lengths wraps around
+// should agree with Range, which adds up its ranges one by one
+void flatCoveredLengthAfterBulkChanges(){
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<int> dist(0, 5000);
+    auto randomRanges = [&](){
+        std::vector<std::pair<int, int>> ranges(8);
+        for (auto& range : ranges){
+            range.first = dist(gen);
+            range.second = range.first + dist(gen) % 60;
+        }
+        return ranges;
+    };
+    FlatRange flat = FlatRange();
+    Range range = Range();
+    int mismatches = 0;
+    for (int round = 0; round < 500; round++){
+        std::vector<std::pair<int, int>> ranges = randomRanges();
+        switch (round % 4){
+            case 0: flat.AddBatch(ranges); range.AddBatch(ranges); break;
+            case 1: flat.DeleteBatch(ranges); range.DeleteBatch(ranges); break;
+            case 2: {
+                // round trip through the bulk constructor and a swap
+                std::vector<std::pair<int, int>> all = flat.Get(0, 6000);
+                FlatRange rebuilt(SortedRanges, all.begin(), all.end());
+                flat.swap(rebuilt);
+                break;
+            }
+            default: flat.Add(ranges[0].first, ranges[0].second); range.Add(ranges[0].first, ranges[0].second); break;
+        }
+        int from = dist(gen);
+        int to = from + dist(gen) % 1000;
+        mismatches += flat.CoveredLength(from, to) != range.CoveredLength(from, to);
+        mismatches += flat.CoveredLength(-1, 6000) != range.CoveredLength(-1, 6000);
+    }
+    const int lowest = std::numeric_limits<int>::lowest();
+    const int highest = std::numeric_limits<int>::max();
+    FlatRange wide = FlatRange({{lowest, -10}, {0, highest}});
+    std::vector<std::pair<int, int>> res = {
+        {0, mismatches},
+        {1, wide.CoveredLength(lowest, highest) == 0xFFFFFFF5u},
+        {2, wide.CoveredLength(-5, 5) == 5u}
+    };
+    std::vector<std::pair<int, int>> ans = {{0, 0}, {1, 1}, {2, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs the aggregate query test cases against one backend
     Returns nothing, but prints to stdout
+
+    name: name of the backend, used to label the output
 */
-void runTests()
+template <typename RangeType>
+void aggregateTests(const char* name)
+{
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Aggregate Queries (" << name << "):" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    aggregateQueries<RangeType>();
+    aggregatesMatchGet<RangeType>();
+}
+
+// tests measuring a range spanning every coordinate but the largest
+// should give the largest Length without overflowing
+template <typename Key>
+void coveredLengthAtKeyLimits(){
+    const Key lowest = std::numeric_limits<Key>::lowest();
+    const Key highest = std::numeric_limits<Key>::max();
+    BasicRange<Key> range = BasicRange<Key>();
+    range.Add(lowest, highest);
+    typename BasicRange<Key>::Length length = range.CoveredLength(lowest, highest);
+    std::vector<std::pair<int, int>> res = {{length == std::numeric_limits<typename BasicRange<Key>::Length>::max(), range.NextGap(lowest) == highest}};
+    std::vector<std::pair<int, int>> ans = {{1, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests adding ranges that start at the lowest and end at the highest value
+// of the coordinate type, including merging two ranges touching at the top
+// should store the ranges without overflowing
+template <typename Key>
+void addAtKeyLimits(){
+    const Key lowest = std::numeric_limits<Key>::lowest();
+    const Key highest = std::numeric_limits<Key>::max();
+    BasicRange<Key> range = BasicRange<Key>();
+    range.Add(lowest, lowest + 10);
+    range.Add(highest - 10, highest);
+    range.Add(highest - 20, highest - 10);
+    std::vector<Key> ans = {highest, highest - 20, lowest + 10, lowest};
+    verifyAnswer(range, ans, __FUNCTION__);
+}
+
+// tests deleting and getting ranges at the lowest and highest value
+// of the coordinate type
+// should split the ranges and return them without overflowing
+template <typename Key>
+void deleteAndGetAtKeyLimits(){
+    const Key lowest = std::numeric_limits<Key>::lowest();
+    const Key highest = std::numeric_limits<Key>::max();
+    BasicRange<Key> range = BasicRange<Key>();
+    range.Add(lowest, lowest + 10);
+    range.Add(highest - 20, highest);
+    range.Delete(lowest, lowest + 5);
+    range.Delete(highest - 15, highest - 10);
+    range.Delete(highest - 5, highest);
+    auto res = range.Get(lowest, highest);
+    std::vector<std::pair<Key, Key>> ans = {
+        {lowest + 5, lowest + 10}, {highest - 20, highest - 15}, {highest - 10, highest - 5}
+    };
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the test cases pertaining to the limits of a coordinate type
+
+    name: name of the coordinate type, used to label the output
+*/
+template <typename Key>
+void keyLimitTests(const char* name)
+{
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Coordinate Limits (" << name << "):" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    addAtKeyLimits<Key>();
+    deleteAndGetAtKeyLimits<Key>();
+    coveredLengthAtKeyLimits<Key>();
+}
+
+// tests adding and then deleting enough ranges to split and merge nodes
+// several levels deep
+// should keep every remaining range and shrink the tree back down
+void btreeSplitAndMerge(){
+    BTreeRange<4> range = BTreeRange<4>();
+    for (int i = 0; i < 200; i++){
+        range.Add(i * 10, i * 10 + 5);
+    }
+    std::size_t fullDepth = range.Depth();
+    for (int i = 0; i < 200; i++){
+        if (i % 50 != 0){
+            range.Delete(i * 10, i * 10 + 5);
+        }
+    }
+    // Get only reads the tree, so it works through a const reference
+    const BTreeRange<4>& view = range;
+    auto res = view.Get(-10, 2000);
+    std::vector<std::pair<int, int>> ans = {{0, 5}, {500, 505}, {1000, 1005}, {1500, 1505}};
+    // a tree of 200 ranges must be several levels deep,
+    // and must lose levels again once most of them are gone
+    if (fullDepth < 3 || range.Depth() > 2){
+        ans.clear();
+    }
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests adding and deleting from several writer threads while several
+// reader threads keep getting ranges
+// every writer works on its own region, so the final result is known in advance
+// should never hand readers a malformed list, and should end up with
+// the same ranges as a Range given the same modifications
+void concurrentReadersAndWriters(){
+    const int writers = 4;
+    const int readers = 4;
+    const int rounds = 200;
+    ConcurrentRange range = ConcurrentRange();
+    Range expected = Range();
+    // each writer repeatedly covers its region, then punches holes of varying widths into it
+    auto writeRegion = [&](auto& target, int writer){
+        int base = writer * 1000;
+        for (int round = 0; round < rounds; round++){
+            int hole = base + (round * 37) % 900;
+            if (round % 3 == 0){
+                target.Add(base, base + 1000);
+            }
+            target.Delete(hole, hole + round % 50 + 1);
+        }
+    };
+    for (int writer = 0; writer < writers; writer++){
+        writeRegion(expected, writer);
+    }
+
+    std::atomic<bool> done(false);
+    std::atomic<int> malformed(0);
+    std::vector<std::thread> threads;
+    for (int reader = 0; reader < readers; reader++){
+        threads.emplace_back([&, reader](){
+            int start = reader * 700;
+            while (!done.load()){
+                auto res = range.Get(start, start + 1500);
+                // the ranges must be non-empty, disjoint, in order and inside the selection
+                int last = start - 1;
+                for (auto&& elem : res){
+                    if (elem.first <= last || elem.first >= elem.second || elem.second > start + 1500){
+                        malformed++;
+                    }
+                    last = elem.second;
+                }
+                start = (start + 131) % (writers * 1000);
+            }
+        });
+    }
+    std::vector<std::thread> writerThreads;
+    for (int writer = 0; writer < writers; writer++){
+        writerThreads.emplace_back([&, writer](){
+            writeRegion(range, writer);
+        });
+    }
+    for (auto&& thread : writerThreads){
+        thread.join();
+    }
+    done.store(true);
+    for (auto&& thread : threads){
+        thread.join();
+    }
+    std::vector<int> ans = expected.toVec();
+    if (malformed.load() != 0){
+        ans.clear();
+    }
+    verifyAnswer(range, ans, __FUNCTION__);
+}
+
+// ShardedRange with boundaries placed so that the ranges used by the backend
+// test cases start, end and span across shards in every possible way
+struct TestShardedRange : ShardedRange
 {
+    TestShardedRange() : ShardedRange(std::vector<int>{-3, 10, 25, 45}) {}
+};
+
+// tests splitting the coordinates into shards of equal width, across every int
+// and across a width too small to give each shard a point, and with bounds
+// that are equal or the wrong way around
+// should store ranges across the shards like a Range, and refuse the bad bounds
+void shardedEvenSplit(){
+    const int lowest = std::numeric_limits<int>::lowest();
+    const int highest = std::numeric_limits<int>::max();
+    ShardedRange wide = ShardedRange(16, lowest, highest);
+    wide.Add(lowest, -5);
+    wide.Add(-10, highest);
+    wide.Delete(0, 1);
+    ShardedRange narrow = ShardedRange(16, 0, 4);
+    narrow.Add(-5, 2);
+    narrow.Add(3, 10);
+    int rejected = 0;
+    for (auto bounds : {std::make_pair(10, 10), std::make_pair(10, -10), std::make_pair(highest, lowest)}){
+        try {
+            ShardedRange range = ShardedRange(4, bounds.first, bounds.second);
+        } catch (const std::invalid_argument&){
+            rejected++;
+        }
+    }
+    std::vector<int> ans = {highest, 1, 0, lowest};
+    verifyAnswer(wide, ans, __FUNCTION__);
+    ans = {10, 3, 2, -5};
+    verifyAnswer(narrow, ans, __FUNCTION__);
+    std::vector<std::pair<int, int>> res = {{0, rejected}};
+    std::vector<std::pair<int, int>> expected = {{0, 3}};
+    verifyAnswer(res, expected, __FUNCTION__);
+}
+
+// tests creating ShardedRanges from boundaries in and out of order
+// should reject any list that doesn't strictly increase, and split the ranges
+// of an accepted one at its boundaries without changing them
+void shardedBoundaries(){
+    int rejected = 0;
+    std::vector<std::vector<int>> invalid = {{100, 10}, {10, 10}, {0, 50, 20, 70}};
+    for (auto&& boundaries : invalid){
+        try {
+            ShardedRange range = ShardedRange(boundaries);
+        } catch (const std::invalid_argument&){
+            rejected++;
+        }
+    }
+    ShardedRange range = ShardedRange(std::vector<int>{10, 100});
+    range.Add(5, 150);
+    range.Delete(50, 60);
+    std::vector<std::pair<int, int>> res = range.Get(0, 200);
+    res.push_back(std::make_pair(0, rejected));
+    std::vector<std::pair<int, int>> ans = {{5, 50}, {60, 150}, {0, 3}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests adding and deleting from several threads at once, where each thread
+// works on its own region, and every region spans a shard boundary
+// should end up with the same ranges as a Range given the same modifications
+void shardedParallelWriters(){
+    const int writers = 4;
+    ShardedRange range = ShardedRange(std::vector<int>{1000, 2000, 3000});
+    Range expected = Range();
+    auto writeRegion = [&](auto& target, int writer){
+        int base = writer * 1000 + 500;
+        for (int round = 0; round < 500; round++){
+            int hole = base + (round * 37) % 900;
+            if (round % 3 == 0){
+                target.Add(base, base + 1000);
+            }
+            target.Delete(hole, hole + round % 50 + 1);
+            target.Add(hole + 10, hole + 20);
+        }
+    };
+    for (int writer = 0; writer < writers; writer++){
+        writeRegion(expected, writer);
+    }
+    std::vector<std::thread> threads;
+    for (int writer = 0; writer < writers; writer++){
+        threads.emplace_back([&, writer](){
+            writeRegion(range, writer);
+        });
+    }
+    for (auto&& thread : threads){
+        thread.join();
+    }
+    verifyAnswer(range, expected.toVec(), __FUNCTION__);
+}
+
+// tests saving a set of ranges to a snapshot and loading it back
+// should load exactly the ranges that were saved
+void snapshotRoundTrip(){
+    const char* path = "snapshotRoundTrip.snap";
+    Range range = Range();
+    for (int i = 0; i < 5000; i++){
+        range.Add(i * 20, i * 20 + 10 + i % 7);
+    }
+    range.Delete(1005, 2003);
+    SaveSnapshot(range, path);
+    Range loaded = LoadSnapshot<int>(path);
+    std::remove(path);
+    verifyAnswer(loaded, range.toVec(), __FUNCTION__);
+}
+
+// tests getting ranges straight out of a memory mapped snapshot
+// should return the same ranges as the Range that was saved
+void snapshotMappedGet(){
+    const char* path = "snapshotMappedGet.snap";
+    Range range = Range();
+    range.Add(-50, -20);
+    range.Add(10, 20);
+    range.Add(30, 40);
+    range.Add(100, 200);
+    SaveSnapshot(range, path);
+    MappedRange mapped = MappedRange(path);
+    std::remove(path);
+    std::vector<std::pair<int, int>> res;
+    std::vector<std::pair<int, int>> ans;
+    // selections starting and ending inside, between and on the edges of ranges
+    for (int start = -60; start < 210; start += 5){
+        for (int end = start - 5; end < 215; end += 15){
+            auto part = mapped.Get(start, end);
+            auto expected = range.Get(start, end);
+            res.insert(res.end(), part.begin(), part.end());
+            ans.insert(ans.end(), expected.begin(), expected.end());
+        }
+    }
+    if (mapped.toVec() != range.toVec() || mapped.Size() != range.Size()){
+        ans.clear();
+    }
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests saving and mapping a snapshot with no ranges in it
+// should map an empty set
+void snapshotEmpty(){
+    const char* path = "snapshotEmpty.snap";
+    SaveSnapshot(Range(), path);
+    MappedRange mapped = MappedRange(path);
+    std::remove(path);
+    std::vector<int> ans = {};
+    verifyAnswer(mapped, ans, __FUNCTION__);
+}
+
+// tests opening snapshots that were damaged, truncated or
+// written with a different coordinate type
+// should refuse to open every one of them
+void snapshotRejectsBadFiles(){
+    const char* path = "snapshotRejectsBadFiles.snap";
+    Range range = Range();
+    range.Add(10, 20);
+    range.Add(30, 40);
+    // counts how many of the damaged files were refused
+    int rejected = 0;
+    auto tryOpen = [&](){
+        try {
+            MappedRange mapped = MappedRange(path);
+        } catch (const std::runtime_error&){
+            rejected++;
+        }
+    };
+    // flip a byte in the last coordinate, which only the checksum catches
+    SaveSnapshot(range, path);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        file.put(0x7f);
+    }
+    tryOpen();
+    // cut off the last coordinate
+    SaveSnapshot(range, path);
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), contents.size() - sizeof(int));
+    }
+    tryOpen();
+    // a snapshot of 64 bit coordinates
+    BasicRange<std::int64_t> wide = BasicRange<std::int64_t>();
+    wide.Add(10, 20);
+    SaveSnapshot(wide, path);
+    tryOpen();
+    // not a snapshot at all, and no file at all
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "this is not a snapshot, but it is long enough to hold a header";
+    }
+    tryOpen();
+    std::remove(path);
+    tryOpen();
+    std::vector<std::pair<int, int>> res = {{0, rejected}};
+    std::vector<std::pair<int, int>> ans = {{0, 5}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests loading a snapshot whose ranges are out of order, but whose
+// checksum was made to match, so that only loading it can notice
+// should refuse to load it
+void snapshotRejectsUnsorted(){
+    const char* path = "snapshotRejectsUnsorted.snap";
+    Range range = Range();
+    range.Add(10, 20);
+    range.Add(30, 40);
+    SaveSnapshot(range, path);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        SnapshotHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        int keys[4] = {30, 10, 40, 20};
+        std::uint64_t hash = snapshotChecksum(snapshotChecksumSeed, keys, 2);
+        header.checksum = snapshotChecksum(hash, keys + 2, 2);
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(keys), sizeof(keys));
+    }
+    bool threw = false;
+    try {
+        LoadSnapshot<int>(path);
+    } catch (const std::runtime_error&){
+        threw = true;
+    }
+    std::remove(path);
+    std::vector<std::pair<int, int>> res = {{0, threw}};
+    std::vector<std::pair<int, int>> ans = {{0, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the snapshot test cases
+    Returns nothing, but prints to stdout
+*/
+void snapshotTests()
+{
+    snapshotRoundTrip();
+    snapshotMappedGet();
+    snapshotEmpty();
+    snapshotRejectsBadFiles();
+    snapshotRejectsUnsorted();
+}
+
+/*
+    Removes the snapshot and log files of the DurableRange at "path"
+    Returns "path"
+*/
+std::string removeDurableFiles(const std::string& path){
+    std::remove((path + ".snap").c_str());
+    std::remove((path + ".snap.tmp").c_str());
+    std::remove((path + ".log").c_str());
+    return path;
+}
+
+// DurableRange starting from an empty set every time,
+// and cleaning up its files afterwards
+struct TestDurableRange : DurableRange
+{
+    TestDurableRange() : DurableRange(removeDurableFiles("testDurableRange")) {}
+    ~TestDurableRange() { removeDurableFiles("testDurableRange"); }
+};
+
+/*
+    Applies the same modifications to "target", deleting
+    holes of varying widths from a few covered regions
+*/
+template <typename RangeType>
+void durableWorkload(RangeType& target, int base, int rounds){
+    for (int round = 0; round < rounds; round++){
+        int hole = base + (round * 37) % 900;
+        if (round % 7 == 0){
+            target.Add(base, base + 1000);
+        }
+        target.Delete(hole, hole + round % 50 + 1);
+        target.Add(hole + 10, hole + 20);
+    }
+}
+
+// tests reopening a DurableRange that only ever wrote to its log
+// should replay every modification
+void durableReplay(){
+    std::string path = removeDurableFiles("durableReplay");
+    Range expected = Range();
+    durableWorkload(expected, 0, 300);
+    {
+        DurableRange range = DurableRange(path);
+        durableWorkload(range, 0, 300);
+    }
+    DurableRange reopened = DurableRange(path);
+    std::vector<int> ans = expected.toVec();
+    verifyAnswer(reopened, ans, __FUNCTION__);
+    removeDurableFiles(path);
+}
+
+// tests reopening a DurableRange that compacted its log into a snapshot
+// several times, with more modifications logged after the last compaction
+// should load the snapshot, replay the rest, and keep the log short
+void durableCompaction(){
+    std::string path = removeDurableFiles("durableCompaction");
+    Range expected = Range();
+    durableWorkload(expected, 0, 300);
+    DurableOptions options;
+    options.syncEvery = 16;
+    options.compactEvery = 100;
+    {
+        DurableRange range = DurableRange(path, options);
+        durableWorkload(range, 0, 300);
+    }
+    DurableRange reopened = DurableRange(path, options);
+    std::vector<int> ans = expected.toVec();
+    if (reopened.LogSize() >= 100){
+        ans.clear();
+    }
+    verifyAnswer(reopened, ans, __FUNCTION__);
+    removeDurableFiles(path);
+}
+
+// tests reopening a log that ends in a partially written record, as left
+// behind by a crash in the middle of a write, and then modifying it further
+// should drop the partial record and keep everything after it
+void durableTornRecord(){
+    std::string path = removeDurableFiles("durableTornRecord");
+    {
+        DurableRange range = DurableRange(path);
+        range.Add(0, 100);
+        range.Delete(40, 60);
+    }
+    {
+        std::ofstream log(path + ".log", std::ios::binary | std::ios::app);
+        log.write("torn", 4);
+    }
+    {
+        DurableRange range = DurableRange(path);
+        range.Add(200, 300);
+    }
+    DurableRange reopened = DurableRange(path);
+    std::vector<int> ans = {300, 200, 100, 60, 40, 0};
+    verifyAnswer(reopened, ans, __FUNCTION__);
+    removeDurableFiles(path);
+}
+
+// tests a write to the log failing partway through a record, by lowering the
+// limit on the size of files the process may write just past the last record
+// should cut the partial record back off, fail every later modification and
+// sync, and reopen with everything logged before the failure
+void durableWriteFailure(){
+    std::string path = removeDurableFiles("durableWriteFailure");
+    // past the limit, writes fail with EFBIG rather than the signal ending the process
+    void (*handler)(int) = std::signal(SIGXFSZ, SIG_IGN);
+    struct rlimit limit;
+    getrlimit(RLIMIT_FSIZE, &limit);
+    struct rlimit lowered = limit;
+    int failures = 0;
+    off_t logSize = 0;
+    {
+        DurableRange range = DurableRange(path);
+        range.Add(0, 100);
+        range.Delete(40, 60);
+        struct stat info;
+        stat((path + ".log").c_str(), &info);
+        // room for half of the next record
+        lowered.rlim_cur = info.st_size + 8;
+        setrlimit(RLIMIT_FSIZE, &lowered);
+        auto attempt = [&](auto&& operation){
+            try {
+                operation();
+            } catch (const std::runtime_error&){
+                failures++;
+            }
+        };
+        attempt([&](){ range.Add(200, 300); });
+        attempt([&](){ range.Delete(0, 10); });
+        attempt([&](){ range.Sync(); });
+        attempt([&](){ range.Compact(); });
+        setrlimit(RLIMIT_FSIZE, &limit);
+        logSize = info.st_size;
+        stat((path + ".log").c_str(), &info);
+        logSize = info.st_size - logSize;
+    }
+    std::signal(SIGXFSZ, handler);
+    DurableRange reopened = DurableRange(path);
+    std::vector<std::pair<int, int>> res = {{failures, static_cast<int>(logSize)}};
+    std::vector<std::pair<int, int>> ans = {{4, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    std::vector<int> contents = {100, 60, 40, 0};
+    verifyAnswer(reopened, contents, __FUNCTION__);
+    removeDurableFiles(path);
+}
+
+// tests modifying a DurableRange from several threads at once, syncing every
+// modification, so that the threads share syncs through group commit
+// should end up with the same ranges as a Range given the same modifications,
+// both before and after reopening
+void durableGroupCommit(){
+    const int writers = 4;
+    std::string path = removeDurableFiles("durableGroupCommit");
+    Range expected = Range();
+    for (int writer = 0; writer < writers; writer++){
+        durableWorkload(expected, writer * 1000, 100);
+    }
+    std::vector<int> before;
+    {
+        DurableRange range = DurableRange(path);
+        std::vector<std::thread> threads;
+        for (int writer = 0; writer < writers; writer++){
+            threads.emplace_back([&, writer](){
+                durableWorkload(range, writer * 1000, 100);
+            });
+        }
+        for (auto&& thread : threads){
+            thread.join();
+        }
+        before = range.toVec();
+    }
+    DurableRange reopened = DurableRange(path);
+    std::vector<int> ans = expected.toVec();
+    if (before != ans){
+        ans.clear();
+    }
+    verifyAnswer(reopened, ans, __FUNCTION__);
+    removeDurableFiles(path);
+}
+
+/*
+    Runs all of the durability test cases
+    Returns nothing, but prints to stdout
+*/
+void durableTests()
+{
+    durableReplay();
+    durableCompaction();
+    durableTornRecord();
+    durableWriteFailure();
+    durableGroupCommit();
+}
+
+// tests deleting and adding back the same ranges over and over
+// should recycle the nodes of deleted ranges rather than take more memory from the heap
+void poolRecyclesNodes(){
+    PooledRange range = PooledRange();
+    Range expected = Range();
+    for (int i = 0; i < 1000; i++){
+        range.Add(i * 20, i * 20 + 10);
+        expected.Add(i * 20, i * 20 + 10);
+    }
+    std::size_t capacity = range.GetAllocator().Capacity();
+    for (int round = 0; round < 50; round++){
+        for (int i = 0; i < 1000; i += 7){
+            range.Delete(i * 20 + 2, i * 20 + 8);
+            range.Add(i * 20 + 2, i * 20 + 8);
+        }
+    }
+    std::vector<int> ans = expected.toVec();
+    if (range.GetAllocator().Capacity() != capacity){
+        ans.clear();
+    }
+    verifyAnswer(range, ans, __FUNCTION__);
+}
+
+// tests copying a PooledRange, then modifying the original and the copy separately
+// should give the copy a pool of its own, and keep both sets independent
+void pooledRangeCopy(){
+    PooledRange range = PooledRange();
+    range.Add(10, 20);
+    range.Add(30, 40);
+    PooledRange copy = range;
+    range.Delete(10, 40);
+    copy.Add(20, 30);
+    std::vector<int> ans = {40, 10};
+    if (!range.toVec().empty() || copy.GetAllocator() == range.GetAllocator()){
+        ans.clear();
+    }
+    verifyAnswer(copy, ans, __FUNCTION__);
+}
+
+// tests moving a PooledRange, and move assigning it, then modifying every set involved
+// should leave each moved from set with a pool of its own, apart from the one its nodes went to
+void pooledRangeMove(){
+    PooledRange range = PooledRange();
+    range.Add(10, 20);
+    PooledRange moved = std::move(range);
+    PooledRange assigned = PooledRange();
+    assigned.Add(50, 60);
+    assigned = std::move(moved);
+    range.Add(30, 40);
+    moved.Add(40, 50);
+    assigned.Add(20, 25);
+    std::vector<int> ans = {25, 10};
+    if (range.GetAllocator() == assigned.GetAllocator() || moved.GetAllocator() == assigned.GetAllocator()
+        || range.GetAllocator() == moved.GetAllocator() || range.toVec() != std::vector<int>{40, 30}
+        || moved.toVec() != std::vector<int>{50, 40}){
+        ans.clear();
+    }
+    verifyAnswer(assigned, ans, __FUNCTION__);
+}
+
+/*
+    Returns a set holding the given ranges
+*/
+template <typename RangeType>
+RangeType rangeOf(const std::vector<std::pair<int, int>>& ranges){
+    RangeType range = RangeType();
+    for (auto&& elem : ranges){
+        range.Add(elem.first, elem.second);
+    }
+    return range;
+}
+
+// operands shared by the set algebra test cases: ranges overlapping, touching,
+// containing and lying apart from each other
+const std::vector<std::pair<int, int>> algebraFirst = {{0, 10}, {20, 30}, {40, 50}, {60, 70}};
+const std::vector<std::pair<int, int>> algebraSecond = {{5, 25}, {30, 35}, {42, 45}, {80, 90}};
+
+// tests the union of two sets, both returned and in place
+// should merge ranges that overlap or touch across the two sets
+template <typename RangeType>
+void unionOfSets(){
+    auto first = rangeOf<RangeType>(algebraFirst);
+    auto second = rangeOf<RangeType>(algebraSecond);
+    std::vector<int> ans = {90, 80, 70, 60, 50, 40, 35, 0};
+    auto result = first.Union(second);
+    first.UnionWith(second);
+    if (result.toVec() != ans){
+        ans.clear();
+    }
+    verifyAnswer(first, ans, __FUNCTION__);
+}
+
+// tests the intersection of two sets, both returned and in place
+// should keep only the overlaps, and nothing where ranges merely touch
+template <typename RangeType>
+void intersectionOfSets(){
+    auto first = rangeOf<RangeType>(algebraFirst);
+    auto second = rangeOf<RangeType>(algebraSecond);
+    std::vector<int> ans = {45, 42, 25, 20, 10, 5};
+    auto result = first.Intersect(second);
+    first.IntersectWith(second);
+    if (result.toVec() != ans){
+        ans.clear();
+    }
+    verifyAnswer(first, ans, __FUNCTION__);
+}
+
+// tests the difference of two sets, both returned and in place
+// should cut the ranges of the second set out of the first
+template <typename RangeType>
+void differenceOfSets(){
+    auto first = rangeOf<RangeType>(algebraFirst);
+    auto second = rangeOf<RangeType>(algebraSecond);
+    std::vector<int> ans = {70, 60, 50, 45, 42, 40, 30, 25, 5, 0};
+    auto result = first.Difference(second);
+    first.DifferenceWith(second);
+    if (result.toVec() != ans){
+        ans.clear();
+    }
+    verifyAnswer(first, ans, __FUNCTION__);
+}
+
+// tests the symmetric difference of two sets, both returned and in place
+// should keep the points in exactly one set, merging pieces that touch
+template <typename RangeType>
+void symmetricDifferenceOfSets(){
+    auto first = rangeOf<RangeType>(algebraFirst);
+    auto second = rangeOf<RangeType>(algebraSecond);
+    std::vector<int> ans = {90, 80, 70, 60, 50, 45, 42, 40, 35, 25, 20, 10, 5, 0};
+    auto result = first.SymmetricDifference(second);
+    first.SymmetricDifferenceWith(second);
+    if (result.toVec() != ans){
+        ans.clear();
+    }
+    verifyAnswer(first, ans, __FUNCTION__);
+}
+
+// tests the complement of a set within bounds that cut through ranges,
+// both returned and in place
+// should cover the gaps within the bounds, and nothing outside of them
+template <typename RangeType>
+void complementOfSet(){
+    auto first = rangeOf<RangeType>(algebraFirst);
+    std::vector<int> ans = {60, 50, 40, 30, 20, 10};
+    auto result = first.Complement(5, 65);
+    first.ComplementWithin(5, 65);
+    if (result.toVec() != ans){
+        ans.clear();
+    }
+    verifyAnswer(first, ans, __FUNCTION__);
+}
+
+// tests combining a set with itself, and with an empty set
+// should give the set itself or an empty set, as the operation calls for
+template <typename RangeType>
+void algebraWithSelfAndEmpty(){
+    auto first = rangeOf<RangeType>(algebraFirst);
+    auto empty = RangeType();
+    std::vector<int> ans = first.toVec();
+    bool matches = first.Union(first).toVec() == ans
+        && first.Intersect(first).toVec() == ans
+        && first.Difference(first).toVec().empty()
+        && first.SymmetricDifference(first).toVec().empty()
+        && first.Union(empty).toVec() == ans
+        && first.Intersect(empty).toVec().empty()
+        && empty.Difference(first).toVec().empty()
+        && first.Complement(10, 10).toVec().empty();
+    first.UnionWith(first);
+    first.IntersectWith(first);
+    first.DifferenceWith(empty);
+    auto copy = first;
+    copy.SymmetricDifferenceWith(copy);
+    if (!matches || !copy.toVec().empty()){
+        ans.clear();
+    }
+    verifyAnswer(first, ans, __FUNCTION__);
+}
+
+// tests every operation on random sets against a bitmap of the points in each set
+// should agree with the bitmaps on every point
+template <typename RangeType>
+void algebraMatchesBitmap(){
+    const int width = 300;
+    std::uint32_t seed = 12345;
+    auto random = [&](int bound){
+        seed = seed * 1664525 + 1013904223;
+        return static_cast<int>((seed >> 8) % bound);
+    };
+    // returns the set of the points in "bits", as toVec would list them
+    auto toVec = [&](const std::vector<bool>& bits){
+        std::vector<int> vec;
+        for (int x = width - 1; x >= 0; x--){
+            if (bits[x] && (x == width - 1 || !bits[x + 1])){
+                vec.push_back(x + 1);
+            }
+            if (bits[x] && (x == 0 || !bits[x - 1])){
+                vec.push_back(x);
+            }
+        }
+        return vec;
+    };
+    int mismatches = 0;
+    for (int round = 0; round < 50; round++){
+        RangeType sets[2] = {RangeType(), RangeType()};
+        std::vector<bool> bits[2] = {std::vector<bool>(width), std::vector<bool>(width)};
+        for (int i = 0; i < 2; i++){
+            for (int op = 0; op < 12; op++){
+                int start = random(width);
+                int end = std::min(width, start + random(40));
+                bool add = random(3) != 0;
+                if (add){
+                    sets[i].Add(start, end);
+                } else {
+                    sets[i].Delete(start, end);
+                }
+                for (int x = start; x < end; x++){
+                    bits[i][x] = add;
+                }
+            }
+        }
+        std::vector<bool> expected[5] = {bits[0], bits[0], bits[0], bits[0], bits[0]};
+        int low = random(width);
+        int high = low + random(width - low);
+        for (int x = 0; x < width; x++){
+            expected[0][x] = bits[0][x] || bits[1][x];
+            expected[1][x] = bits[0][x] && bits[1][x];
+            expected[2][x] = bits[0][x] && !bits[1][x];
+            expected[3][x] = bits[0][x] != bits[1][x];
+            expected[4][x] = x >= low && x < high && !bits[0][x];
+        }
+        RangeType results[5] = {
+            sets[0].Union(sets[1]), sets[0].Intersect(sets[1]), sets[0].Difference(sets[1]),
+            sets[0].SymmetricDifference(sets[1]), sets[0].Complement(low, high)
+        };
+        RangeType inPlace[5] = {sets[0], sets[0], sets[0], sets[0], sets[0]};
+        inPlace[0].UnionWith(sets[1]);
+        inPlace[1].IntersectWith(sets[1]);
+        inPlace[2].DifferenceWith(sets[1]);
+        inPlace[3].SymmetricDifferenceWith(sets[1]);
+        inPlace[4].ComplementWithin(low, high);
+        for (int i = 0; i < 5; i++){
+            if (results[i].toVec() != toVec(expected[i]) || inPlace[i].toVec() != toVec(expected[i])){
+                mismatches++;
+            }
+        }
+    }
+    std::vector<std::pair<int, int>> res = {{0, mismatches}};
+    std::vector<std::pair<int, int>> ans = {{0, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the set algebra test cases against one backend
+    Returns nothing, but prints to stdout
+
+    name: name of the backend, used to label the output
+*/
+template <typename RangeType>
+void algebraTests(const char* name)
+{
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Set Algebra (" << name << "):" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    unionOfSets<RangeType>();
+    intersectionOfSets<RangeType>();
+    differenceOfSets<RangeType>();
+    symmetricDifferenceOfSets<RangeType>();
+    complementOfSet<RangeType>();
+    algebraWithSelfAndEmpty<RangeType>();
+    algebraMatchesBitmap<RangeType>();
+}
+
+/*
+    Modifying a PersistentRange after taking a snapshot leaves the snapshot as it was
+*/
+void persistentSnapshotIsolation(){
+    PersistentRange range;
+    range.Add(10, 20);
+    range.Add(30, 40);
+    range.Add(50, 60);
+    PersistentRange before = range.Snapshot();
+    range.Add(15, 35);
+    range.Delete(55, 58);
+    range.Add(100, 110);
+    PersistentRange after = range.Snapshot();
+    range.Delete(0, 200);
+    std::vector<std::pair<int, int>> res = before.Get(0, 200);
+    std::vector<std::pair<int, int>> ans = {{10, 20}, {30, 40}, {50, 60}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    res = after.Get(0, 200);
+    ans = {{10, 40}, {50, 55}, {58, 60}, {100, 110}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    res = range.Get(0, 200);
+    ans = {};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Old versions stay readable after the versions derived from them are gone, and the other way around
+*/
+void persistentVersionLifetimes(){
+    std::vector<PersistentRange> versions;
+    {
+        PersistentRange range;
+        for (int i = 0; i < 100; i++){
+            range.Add(10 * i, 10 * i + 5);
+            versions.push_back(range.Snapshot());
+        }
+        range.Delete(0, 1000);
+    }
+    // drop the newer half, which shares its nodes with the older half
+    versions.resize(50);
+    PersistentRange derived = versions[10];
+    derived.Add(0, 1000);
+    versions.erase(versions.begin(), versions.begin() + 40);
+    std::vector<std::pair<int, int>> res = {
+        {0, static_cast<int>(versions[0].Size())}, {1, static_cast<int>(versions[9].Size())},
+        {2, static_cast<int>(derived.Size())}
+    };
+    std::vector<std::pair<int, int>> ans = {{0, 41}, {1, 50}, {2, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    res = versions[9].Get(480, 1000);
+    ans = {{480, 485}, {490, 495}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Diff reports the points added and removed between two versions, whole ranges or parts of them
+*/
+void persistentDiff(){
+    PersistentRange range;
+    range.Add(10, 20);
+    range.Add(30, 40);
+    range.Add(50, 60);
+    PersistentRange older = range.Snapshot();
+    range.Add(15, 35);
+    range.Delete(55, 58);
+    range.Add(100, 110);
+    range.Delete(0, 1);
+    RangeDiff<int> diff = range.Diff(older);
+    std::vector<std::pair<int, int>> res = diff.added;
+    std::vector<std::pair<int, int>> ans = {{20, 30}, {100, 110}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    res = diff.removed;
+    ans = {{55, 58}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    // the other way around, the changes swap over
+    diff = older.Diff(range);
+    res = diff.removed;
+    ans = {{20, 30}, {100, 110}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    // merging ranges back together only to split them again isn't a change
+    PersistentRange same = older.Snapshot();
+    same.Add(20, 30);
+    same.Delete(20, 30);
+    diff = same.Diff(older);
+    res = diff.added;
+    res.insert(res.end(), diff.removed.begin(), diff.removed.end());
+    ans = {};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Diff between random versions of a PersistentRange matches comparing bitmaps point by point,
+    and every version matches its own bitmap
+*/
+void persistentDiffMatchesBitmap(){
+    const int width = 300;
+    std::uint32_t seed = 54321;
+    auto random = [&](int bound){
+        seed = seed * 1664525 + 1013904223;
+        return static_cast<int>((seed >> 8) % bound);
+    };
+    // returns the ranges of points set in "bits" and not in "minus"
+    auto ranges = [&](const std::vector<bool>& bits, const std::vector<bool>& minus){
+        std::vector<std::pair<int, int>> ret;
+        for (int x = 0; x < width; x++){
+            if (bits[x] && !minus[x]){
+                if (!ret.empty() && ret.back().second == x){
+                    ret.back().second = x + 1;
+                } else {
+                    ret.push_back(std::make_pair(x, x + 1));
+                }
+            }
+        }
+        return ret;
+    };
+    const std::vector<bool> none(width);
+    int mismatches = 0;
+    for (int round = 0; round < 20; round++){
+        std::vector<PersistentRange> versions = {PersistentRange()};
+        std::vector<std::vector<bool>> bits = {none};
+        for (int op = 0; op < 40; op++){
+            // mostly build on the latest version, but branch off an earlier one now and then
+            std::size_t base = op % 5 == 0 ? random(versions.size()) : versions.size() - 1;
+            PersistentRange range = versions[base].Snapshot();
+            std::vector<bool> next = bits[base];
+            int start = random(width);
+            int end = std::min(width, start + random(40));
+            bool add = random(3) != 0;
+            if (add){
+                range.Add(start, end);
+            } else {
+                range.Delete(start, end);
+            }
+            for (int x = start; x < end; x++){
+                next[x] = add;
+            }
+            versions.push_back(range);
+            bits.push_back(next);
+        }
+        for (std::size_t i = 0; i < versions.size(); i++){
+            if (versions[i].Get(0, width) != ranges(bits[i], none)){
+                mismatches++;
+            }
+        }
+        for (int pair = 0; pair < 30; pair++){
+            std::size_t older = random(versions.size());
+            std::size_t newer = random(versions.size());
+            RangeDiff<int> diff = versions[newer].Diff(versions[older]);
+            if (diff.added != ranges(bits[newer], bits[older]) || diff.removed != ranges(bits[older], bits[newer])){
+                mismatches++;
+            }
+        }
+    }
+    std::vector<std::pair<int, int>> res = {{0, mismatches}};
+    std::vector<std::pair<int, int>> ans = {{0, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the PersistentRange version test cases
+    Returns nothing, but prints to stdout
+*/
+void persistentTests()
+{
+    persistentSnapshotIsolation();
+    persistentVersionLifetimes();
+    persistentDiff();
+    persistentDiffMatchesBitmap();
+}
+
+/*
+    A subscriber is told exactly which points each Add and Delete covered or uncovered
+*/
+void feedReportsChanges(){
+    Range range;
+    std::vector<std::pair<int, int>> covered;
+    std::vector<std::pair<int, int>> uncovered;
+    range.Subscribe([&](Range::Change change, int start, int end){
+        (change == Range::Change::Covered ? covered : uncovered).push_back(std::make_pair(start, end));
+    });
+    range.Add(10, 20);
+    range.Add(30, 40);
+    range.Add(50, 60);
+    // merges all three, only the gaps between them are new
+    range.Add(15, 55);
+    // already covered, nothing changes
+    range.Add(12, 58);
+    // touching the end extends it
+    range.Add(60, 65);
+    std::vector<std::pair<int, int>> res = covered;
+    std::vector<std::pair<int, int>> ans = {{10, 20}, {30, 40}, {50, 60}, {20, 30}, {40, 50}, {60, 65}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    range.Add(100, 110);
+    covered.clear();
+    range.Delete(5, 8);
+    range.Delete(30, 35);
+    range.Delete(60, 105);
+    res = uncovered;
+    ans = {{30, 35}, {60, 65}, {100, 105}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    res = covered;
+    ans = {};
+    verifyAnswer(res, ans, __FUNCTION__);
+    // a detached subscriber hears nothing more
+    range.Subscribe(Range::Subscriber());
+    range.Add(0, 200);
+    res = covered;
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Flipping a range reports the gaps it covers and the pieces it uncovers in one increasing sequence
+*/
+void feedReportsToggleInOrder(){
+    Range range;
+    range.Add(3, 5);
+    std::vector<std::pair<int, int>> res;
+    range.Subscribe([&](Range::Change change, int start, int end){
+        res.push_back(std::make_pair(change == Range::Change::Covered ? start : -start, end));
+    });
+    Range other;
+    other.Add(0, 10);
+    range.SymmetricDifferenceWith(other);
+    // uncovered changes are marked by a negated start
+    std::vector<std::pair<int, int>> ans = {{0, 3}, {-3, 5}, {5, 10}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Copies of a set don't report to the original's subscriber
+*/
+void feedNotCopied(){
+    Range range;
+    int changes = 0;
+    range.Subscribe([&](Range::Change, int, int){
+        changes++;
+    });
+    range.Add(10, 20);
+    Range copy = range;
+    copy.Add(30, 40);
+    copy.Delete(10, 20);
+    Range assigned;
+    assigned = range;
+    assigned.Add(50, 60);
+    range.Add(70, 80);
+    std::vector<std::pair<int, int>> res = {{0, changes}};
+    std::vector<std::pair<int, int>> ans = {{0, 2}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Under random modifications of every kind, each reported change flips exactly the points
+    it names, in increasing order within each modification, and applying the changes
+    to a mirror keeps it identical to the set
+*/
+void feedMirrorsRandomModifications(){
+    const int width = 300;
+    std::uint32_t seed = 2468;
+    auto random = [&](int bound){
+        seed = seed * 1664525 + 1013904223;
+        return static_cast<int>((seed >> 8) % bound);
+    };
+    auto randomRange = [&](){
+        int start = random(width);
+        return std::make_pair(start, std::min(width, start + random(40)));
+    };
+    int mismatches = 0;
+    for (int round = 0; round < 20; round++){
+        Range range;
+        Range mirror;
+        std::vector<bool> bits(width);
+        // the end of the last change reported by the current modification
+        int reported = std::numeric_limits<int>::lowest();
+        range.Subscribe([&](Range::Change change, int start, int end){
+            bool covering = change == Range::Change::Covered;
+            if (start >= end || start < reported){
+                mismatches++;
+            }
+            reported = end;
+            for (int x = start; x < end; x++){
+                if (bits[x] == covering){
+                    mismatches++;
+                }
+                bits[x] = covering;
+            }
+            if (covering){
+                mirror.Add(start, end);
+            } else {
+                mirror.Delete(start, end);
+            }
+        });
+        for (int op = 0; op < 60; op++){
+            Range other;
+            for (int i = 0; i < 4; i++){
+                auto pair = randomRange();
+                other.Add(pair.first, pair.second);
+            }
+            auto pair = randomRange();
+            reported = std::numeric_limits<int>::lowest();
+            switch (random(10)){
+                case 0: range.AddBatch({randomRange(), randomRange(), randomRange()}); break;
+                case 1: range.DeleteBatch({randomRange(), randomRange(), randomRange()}); break;
+                case 2: range.UnionWith(other); break;
+                case 3: range.IntersectWith(other); break;
+                case 4: range.DifferenceWith(other); break;
+                case 5: range.SymmetricDifferenceWith(other); break;
+                case 6: range.ComplementWithin(pair.first, pair.second); break;
+                case 7: range.Delete(pair.first, pair.second); break;
+                default: range.Add(pair.first, pair.second); break;
+            }
+            if (mirror.toVec() != range.toVec()){
+                mismatches++;
+            }
+        }
+        reported = std::numeric_limits<int>::lowest();
+        range.SymmetricDifferenceWith(range);
+        if (!mirror.toVec().empty()){
+            mismatches++;
+        }
+    }
+    std::vector<std::pair<int, int>> res = {{0, mismatches}};
+    std::vector<std::pair<int, int>> ans = {{0, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the change feed test cases
+    Returns nothing, but prints to stdout
+*/
+void feedTests()
+{
+    feedReportsChanges();
+    feedReportsToggleInOrder();
+    feedNotCopied();
+    feedMirrorsRandomModifications();
+}
+
+/*
+    Flattens the segments of a RangeMap into triples of start, end and payload,
+    so that they can be checked with verifyAnswer
+*/
+template <typename Segments>
+std::vector<std::pair<int, int>> flattenSegments(const Segments& segments){
+    std::vector<std::pair<int, int>> ret;
+    for (auto&& segment : segments){
+        ret.push_back(std::make_pair(segment.start, segment.end));
+        ret.push_back(std::make_pair(segment.value, segment.value));
+    }
+    return ret;
+}
+
+/*
+    Adding over covered points overwrites their payload by default, splitting the ranges at the
+    selection's edges, and neighbours only join when their payloads are equal
+*/
+void rangeMapOverwrite(){
+    RangeMap<int> map;
+    map.Add(10, 30, 1);
+    map.Add(20, 40, 2);
+    map.Add(50, 60, 1);
+    // fills the gap with the same payload as both neighbours, joining all three
+    map.Add(40, 50, 2);
+    map.Add(45, 55, 2);
+    std::vector<std::pair<int, int>> res = flattenSegments(map.Get(0, 100));
+    std::vector<std::pair<int, int>> ans = {{10, 20}, {1, 1}, {20, 55}, {2, 2}, {55, 60}, {1, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    // putting the original payload back joins the ranges again
+    map.Add(20, 55, 1);
+    res = flattenSegments(map.Get(0, 100));
+    ans = {{10, 60}, {1, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    // Get clips the ranges to the selection
+    map.Add(30, 35, 3);
+    res = flattenSegments(map.Get(25, 33));
+    ans = {{25, 30}, {1, 1}, {30, 33}, {3, 3}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Delete cuts the ranges on either edge down, keeping their payloads
+*/
+void rangeMapDelete(){
+    RangeMap<int> map;
+    map.Add(10, 20, 1);
+    map.Add(20, 30, 2);
+    map.Add(30, 40, 3);
+    map.Delete(15, 35);
+    std::vector<std::pair<int, int>> res = flattenSegments(map.Get(0, 100));
+    std::vector<std::pair<int, int>> ans = {{10, 15}, {1, 1}, {35, 40}, {3, 3}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    map.Delete(0, 12);
+    map.Delete(38, 39);
+    map.Delete(50, 40);
+    res = flattenSegments(map.Get(0, 100));
+    ans = {{12, 15}, {1, 1}, {35, 38}, {3, 3}, {39, 40}, {3, 3}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    res = {{0, map.At(13).value_or(-1)}, {1, map.At(15).value_or(-1)}, {2, map.At(39).value_or(-1)}};
+    ans = {{0, 1}, {1, -1}, {2, 3}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    The merge rule decides the payload of points that are added again
+*/
+void rangeMapMergeRules(){
+    RangeMap<int, MaxMerge> expiry;
+    expiry.Add(0, 100, 50);
+    expiry.Add(20, 40, 70);
+    expiry.Add(30, 60, 60);
+    std::vector<std::pair<int, int>> res = flattenSegments(expiry.Get(0, 100));
+    std::vector<std::pair<int, int>> ans = {{0, 20}, {50, 50}, {20, 40}, {70, 70}, {40, 60}, {60, 60}, {60, 100}, {50, 50}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    RangeMap<int, KeepMerge> owners;
+    owners.Add(10, 20, 1);
+    owners.Add(0, 30, 2);
+    res = flattenSegments(owners.Get(0, 100));
+    ans = {{0, 10}, {2, 2}, {10, 20}, {1, 1}, {20, 30}, {2, 2}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    // any callable taking two payloads works, such as a lambda
+    auto sum = [](int existing, int incoming){ return existing + incoming; };
+    BasicRangeMap<int, int, decltype(sum)> counts(sum);
+    counts.Add(0, 10, 1);
+    counts.Add(5, 15, 1);
+    counts.Add(0, 5, 1);
+    res = flattenSegments(counts.Get(0, 100));
+    ans = {{0, 10}, {2, 2}, {10, 15}, {1, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Random Adds and Deletes with a merge rule match a per point array of payloads,
+    and no two touching ranges ever have the same payload
+*/
+void rangeMapMatchesArray(){
+    const int width = 300;
+    std::uint32_t seed = 97531;
+    auto random = [&](int bound){
+        seed = seed * 1664525 + 1013904223;
+        return static_cast<int>((seed >> 8) % bound);
+    };
+    int mismatches = 0;
+    for (int round = 0; round < 30; round++){
+        RangeMap<int, MaxMerge> map;
+        std::vector<int> payloads(width, -1);
+        for (int op = 0; op < 50; op++){
+            int start = random(width);
+            int end = std::min(width, start + random(60));
+            int value = random(4);
+            if (random(4) != 0){
+                map.Add(start, end, value);
+                for (int x = start; x < end; x++){
+                    payloads[x] = std::max(payloads[x], value);
+                }
+            } else {
+                map.Delete(start, end);
+                for (int x = start; x < end; x++){
+                    payloads[x] = -1;
+                }
+            }
+            std::vector<int> seen(width, -1);
+            auto segments = map.Get(0, width);
+            for (std::size_t i = 0; i < segments.size(); i++){
+                for (int x = segments[i].start; x < segments[i].end; x++){
+                    seen[x] = segments[i].value;
+                }
+                if (i > 0 && segments[i - 1].end == segments[i].start && segments[i - 1].value == segments[i].value){
+                    mismatches++;
+                }
+            }
+            int point = random(width);
+            if (seen != payloads || map.At(point).value_or(-1) != payloads[point]){
+                mismatches++;
+            }
+        }
+    }
+    std::vector<std::pair<int, int>> res = {{0, mismatches}};
+    std::vector<std::pair<int, int>> ans = {{0, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the RangeMap test cases
+    Returns nothing, but prints to stdout
+*/
+void rangeMapTests()
+{
+    rangeMapOverwrite();
+    rangeMapDelete();
+    rangeMapMergeRules();
+    rangeMapMatchesArray();
+}
+
+/*
+    A CompressedRange answers Get and Contains exactly like the Range it was built from,
+    across block boundaries, and decodes back into the same Range
+*/
+void compressedMatchesRange(){
+    std::uint32_t seed = 8642;
+    auto random = [&](int bound){
+        seed = seed * 1664525 + 1013904223;
+        return static_cast<int>((seed >> 8) % bound);
+    };
+    int mismatches = 0;
+    for (int round = 0; round < 10; round++){
+        Range range;
+        // a few hundred ranges with gaps and lengths from tiny to ones needing several bytes
+        int scale = round % 2 == 0 ? 10 : 100000;
+        for (int i = 0; i < 500; i++){
+            int start = random(scale * 1000);
+            range.Add(start, start + 1 + random(scale));
+        }
+        CompressedRange compressed(range);
+        if (compressed.toVec() != range.toVec() || compressed.Size() != range.Size()
+            || compressed.ToRange().toVec() != range.toVec()){
+            mismatches++;
+        }
+        for (int query = 0; query < 500; query++){
+            int start = random(scale * 1000 + scale);
+            int end = start + random(scale * 20);
+            if (compressed.Get(start, end) != range.Get(start, end) || compressed.Contains(start) != range.Contains(start)){
+                mismatches++;
+            }
+        }
+    }
+    std::vector<std::pair<int, int>> res = {{0, mismatches}};
+    std::vector<std::pair<int, int>> ans = {{0, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Empty sets, and ranges right at the limits of int, whose lengths and gaps don't fit in an int
+*/
+void compressedLimits(){
+    const int lowest = std::numeric_limits<int>::lowest();
+    const int highest = std::numeric_limits<int>::max();
+    CompressedRange empty((Range()));
+    std::vector<std::pair<int, int>> res = empty.Get(lowest, highest);
+    std::vector<std::pair<int, int>> ans = {};
+    verifyAnswer(res, ans, __FUNCTION__);
+    res = {{0, empty.Contains(0)}, {1, static_cast<int>(empty.Size())}};
+    ans = {{0, 0}, {1, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    Range range;
+    range.Add(lowest, lowest + 1);
+    range.Add(-5, 5);
+    range.Add(highest - 1, highest);
+    CompressedRange compressed(range);
+    res = compressed.Get(lowest, highest);
+    ans = {{lowest, lowest + 1}, {-5, 5}, {highest - 1, highest}};
+    verifyAnswer(res, ans, __FUNCTION__);
+    Range whole;
+    whole.Add(lowest, highest);
+    CompressedRange all(whole);
+    res = {{0, all.Contains(lowest)}, {1, all.Contains(highest - 1)}, {2, all.Contains(highest)}};
+    ans = {{0, 1}, {1, 1}, {2, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Dense sets of short ranges take a few bytes per range,
+    and the encoding takes no more memory than it needs
+*/
+void compressedSize(){
+    const std::size_t count = 100000;
+    Range range;
+    for (std::size_t i = 0; i < count; i++){
+        range.Add(20 * i, 20 * i + 10);
+    }
+    CompressedRange compressed(range);
+    // one byte for every length and every gap, except before the first range of each
+    // block, plus the start and offset of each block in the index
+    std::size_t blocks = (count + CompressedRange::BlockSize - 1) / CompressedRange::BlockSize;
+    std::size_t exact = 2 * count - blocks + blocks * (sizeof(int) + sizeof(std::size_t));
+    std::vector<std::pair<int, int>> res = {
+        {0, compressed.MemoryUsage() <= 3 * range.Size()}, {1, compressed.MemoryUsage() == exact}
+    };
+    std::vector<std::pair<int, int>> ans = {{0, 1}, {1, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the CompressedRange test cases
+    Returns nothing, but prints to stdout
+*/
+void compressedTests()
+{
+    compressedMatchesRange();
+    compressedLimits();
+    compressedSize();
+}
+
+/*
+    Latencies land in buckets of powers of two nanoseconds, and percentiles round up to the bucket's end
+*/
+void latencyHistogram(){
+    LatencyHistogram histogram;
+    histogram.Record(0);
+    histogram.Record(1);
+    histogram.Record(3);
+    histogram.Record(1000);
+    std::vector<std::pair<int, int>> res = {
+        {0, static_cast<int>(histogram.buckets[0])}, {1, static_cast<int>(histogram.buckets[1])},
+        {9, static_cast<int>(histogram.buckets[9])}, {4, static_cast<int>(histogram.Count())},
+        {50, static_cast<int>(histogram.Percentile(0.5))}, {75, static_cast<int>(histogram.Percentile(0.75))},
+        {100, static_cast<int>(histogram.Percentile(1))}, {-1, static_cast<int>(LatencyHistogram().Percentile(1))}
+    };
+    std::vector<std::pair<int, int>> ans = {{0, 2}, {1, 1}, {9, 1}, {4, 4}, {50, 2}, {75, 4}, {100, 1024}, {-1, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    With RANGE_STATS defined, Add, Delete and Get count their calls and the ranges they merge,
+    cut and return; without it, the stats stay empty
+*/
+void statsCounters(){
+    Range range;
+    range.Add(10, 20);
+    range.Add(30, 40);
+    range.Add(50, 60);
+    // merges all three
+    range.Add(15, 55);
+    // lies within one range, so merges with it
+    range.Add(12, 14);
+    range.Add(70, 80);
+    range.Add(90, 100);
+    // splits [10, 60) in two
+    range.Delete(20, 30);
+    // trims [10, 20) and [70, 80), erases [30, 60)
+    range.Delete(15, 75);
+    // erases [90, 100)
+    range.Delete(85, 200);
+    range.Delete(5, 1);
+    range.Get(0, 100);
+    range.Get(11, 12);
+    RangeStats stats = range.Stats();
+    std::vector<std::pair<int, int>> res = {
+        {0, stats.enabled}, {1, static_cast<int>(stats.adds)}, {2, static_cast<int>(stats.merged)},
+        {3, static_cast<int>(stats.maxMerged)}, {4, static_cast<int>(stats.deletes)}, {5, static_cast<int>(stats.split)},
+        {6, static_cast<int>(stats.trimmed)}, {7, static_cast<int>(stats.erased)}, {8, static_cast<int>(stats.maxErased)},
+        {9, static_cast<int>(stats.gets)}, {10, static_cast<int>(stats.returned)}, {11, static_cast<int>(stats.maxReturned)},
+        {12, static_cast<int>(stats.size)}, {13, static_cast<int>(stats.depth)},
+        {14, static_cast<int>(stats.addLatency.Count())}, {15, static_cast<int>(stats.deleteLatency.Count())},
+        {16, static_cast<int>(stats.getLatency.Count())}
+    };
+#ifdef RANGE_STATS
+    std::vector<std::pair<int, int>> ans = {
+        {0, 1}, {1, 7}, {2, 4}, {3, 3}, {4, 4}, {5, 1}, {6, 2}, {7, 2}, {8, 1}, {9, 2}, {10, 3}, {11, 2},
+        {12, 2}, {13, 2}, {14, 7}, {15, 4}, {16, 2}
+    };
+#else
+    std::vector<std::pair<int, int>> ans = {
+        {0, 0}, {1, 0}, {2, 0}, {3, 0}, {4, 0}, {5, 0}, {6, 0}, {7, 0}, {8, 0}, {9, 0}, {10, 0}, {11, 0},
+        {12, 0}, {13, 0}, {14, 0}, {15, 0}, {16, 0}
+    };
+#endif
+    verifyAnswer(res, ans, __FUNCTION__);
+    range.ResetStats();
+    stats = range.Stats();
+    res = {{0, static_cast<int>(stats.adds + stats.merged + stats.getLatency.Count())}, {1, static_cast<int>(stats.size)}};
+#ifdef RANGE_STATS
+    ans = {{0, 0}, {1, 2}};
+#else
+    ans = {{0, 0}, {1, 0}};
+#endif
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests calling Get on the same Range from several threads at once
+// should count every call, without the threads racing on the counters
+void statsConcurrentGets(){
+    const int readers = 4;
+    const int calls = 10000;
+    Range range = Range();
+    range.Add(0, 10);
+    range.Add(20, 30);
+    std::vector<std::thread> threads;
+    for (int reader = 0; reader < readers; reader++){
+        threads.emplace_back([&](){
+            for (int call = 0; call < calls; call++){
+                range.Get(0, 30);
+            }
+        });
+    }
+    for (auto&& thread : threads){
+        thread.join();
+    }
+    RangeStats stats = range.Stats();
+    std::vector<std::pair<int, int>> res = {
+        {0, static_cast<int>(stats.gets)}, {1, static_cast<int>(stats.returned)},
+        {2, static_cast<int>(stats.maxReturned)}, {3, static_cast<int>(stats.getLatency.Count())}
+    };
+#ifdef RANGE_STATS
+    std::vector<std::pair<int, int>> ans = {
+        {0, readers * calls}, {1, 2 * readers * calls}, {2, 2}, {3, readers * calls}
+    };
+#else
+    std::vector<std::pair<int, int>> ans = {{0, 0}, {1, 0}, {2, 0}, {3, 0}};
+#endif
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the instrumentation test cases
+    Returns nothing, but prints to stdout
+*/
+void statsTests()
+{
+    latencyHistogram();
+    statsCounters();
+    statsConcurrentGets();
+}
+
+/*
+    Building a set from random ranges in any order, including empty and reversed ones,
+    gives the same set as adding them one by one, and so does building it from the
+    same ranges sorted by start point
+*/
+template <typename RangeType>
+void bulkLoadMatchesAdd(){
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<int> dist(0, 20000);
+    std::vector<std::pair<int, int>> ranges;
+    RangeType added;
+    for (int i = 0; i < 2000; i++){
+        int start = dist(gen);
+        int end = start + dist(gen) % 40 - 5;
+        ranges.emplace_back(start, end);
+        added.Add(start, end);
+    }
+    RangeType unsorted(ranges);
+    std::sort(ranges.begin(), ranges.end());
+    RangeType sorted(SortedRanges, ranges.begin(), ranges.end());
+    std::vector<std::pair<int, int>> res = {
+        {0, unsorted.toVec() == added.toVec()}, {1, sorted.toVec() == added.toVec()}
+    };
+    std::vector<std::pair<int, int>> ans = {{0, 1}, {1, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    The sorted constructor reads its input once, so any input iterator will do,
+    and merges the ranges that overlap or touch as it goes
+*/
+template <typename RangeType>
+void bulkLoadSortedStream(){
+    std::istringstream input("1 5 3 8 8 10 12 12 15 20 15 18 30 31");
+    std::vector<std::pair<int, int>> ranges;
+    std::istream_iterator<int> iter(input);
+    for (std::istream_iterator<int> last; iter != last; ){
+        int start = *iter++;
+        ranges.emplace_back(start, *iter++);
+    }
+    RangeType range(SortedRanges, ranges.begin(), ranges.end());
+    std::vector<int> ans = {31, 30, 20, 15, 10, 1};
+    verifyAnswer(range, ans, __FUNCTION__);
+}
+
+/*
+    The sorted constructor rejects a range starting before the ones it would be merged with
+*/
+template <typename RangeType>
+void bulkLoadRejectsUnsorted(){
+    std::vector<std::pair<int, int>> ranges = {{10, 20}, {30, 40}, {5, 8}};
+    bool threw = false;
+    try {
+        RangeType range(SortedRanges, ranges.begin(), ranges.end());
+    } catch (const std::invalid_argument&){
+        threw = true;
+    }
+    std::vector<std::pair<int, int>> res = {{0, threw}};
+    std::vector<std::pair<int, int>> ans = {{0, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Building from no ranges, or only empty ones, gives an empty set
+*/
+template <typename RangeType>
+void bulkLoadEmpty(){
+    std::vector<std::pair<int, int>> none;
+    std::vector<std::pair<int, int>> empty = {{5, 5}, {9, 3}};
+    RangeType ranges[4] = {
+        RangeType(none), RangeType(empty),
+        RangeType(SortedRanges, none.begin(), none.end()), RangeType(SortedRanges, empty.begin(), empty.end())
+    };
+    std::vector<std::pair<int, int>> res;
+    for (int i = 0; i < 4; i++){
+        res.emplace_back(i, static_cast<int>(ranges[i].toVec().size()));
+    }
+    std::vector<std::pair<int, int>> ans = {{0, 0}, {1, 0}, {2, 0}, {3, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the bulk loading test cases against one backend
+    Returns nothing, but prints to stdout
+
+    name: name of the backend, used to label the output
+*/
+template <typename RangeType>
+void bulkLoadTests(const char* name)
+{
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Bulk Loading (" << name << "):" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    bulkLoadMatchesAdd<RangeType>();
+    bulkLoadSortedStream<RangeType>();
+    bulkLoadRejectsUnsorted<RangeType>();
+    bulkLoadEmpty<RangeType>();
+}
+
+/*
+    Get gives the same ranges in parallel as it does on one thread, whatever the
+    threshold and number of threads, for selections of any width, including ones
+    that start or end inside of a range
+*/
+void parallelGetMatchesSerial(){
+    std::mt19937 gen(23);
+    std::uniform_int_distribution<int> dist(0, 100000);
+    Range range;
+    for (int i = 0; i < 5000; i++){
+        int start = dist(gen);
+        range.Add(start, start + 1 + dist(gen) % 30);
+    }
+    int mismatches = 0;
+    for (std::size_t threshold : {0, 1, 7, 1000}){
+        for (std::size_t threads : {2, 3, 8}){
+            Range parallel = range;
+            parallel.SetParallelGet(threshold, threads);
+            for (int i = 0; i < 50; i++){
+                int start = dist(gen) - 1000;
+                int end = start + dist(gen) * (i % 5) / 4;
+                std::vector<std::pair<int, int>> expected;
+                range.Get(start, end, std::back_inserter(expected));
+                if (parallel.Get(start, end) != expected){
+                    mismatches++;
+                }
+            }
+        }
+    }
+    std::vector<std::pair<int, int>> res = {{0, mismatches}};
+    std::vector<std::pair<int, int>> ans = {{0, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Cutting a selection into chunks doesn't overflow when it spans every coordinate
+*/
+template <typename Key>
+void parallelGetKeyLimits(){
+    Key lowest = std::numeric_limits<Key>::lowest();
+    Key highest = std::numeric_limits<Key>::max();
+    Key middle = lowest / 2 + highest / 2;
+    BasicRange<Key> range;
+    range.Add(lowest, lowest + 5);
+    range.Add(lowest + 10, lowest + 20);
+    range.Add(middle, middle + 3);
+    range.Add(highest - 20, highest - 10);
+    range.Add(highest - 5, highest);
+    range.SetParallelGet(1, 4);
+    std::vector<std::pair<Key, Key>> expected;
+    BasicRange<Key>(range).Get(lowest, highest, std::back_inserter(expected));
+    std::vector<std::pair<int, int>> res = {
+        {0, range.Get(lowest, highest) == expected}, {1, static_cast<int>(expected.size())},
+        {2, range.Get(lowest + 2, highest - 2) == std::vector<std::pair<Key, Key>>{{lowest + 2, lowest + 5},
+            {lowest + 10, lowest + 20}, {middle, middle + 3}, {highest - 20, highest - 10}, {highest - 5, highest - 2}}}
+    };
+    std::vector<std::pair<int, int>> ans = {{0, 1}, {1, 5}, {2, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the parallel Get test cases
+    Returns nothing, but prints to stdout
+*/
+void parallelGetTests()
+{
+    parallelGetMatchesSerial();
+    parallelGetKeyLimits<std::int32_t>();
+    parallelGetKeyLimits<std::int64_t>();
+    parallelGetKeyLimits<std::uint64_t>();
+}
+
+/*
+    Random runs of Adds and Deletes, with many repeated and adjacent ranges, give
+    the same set through the ingest buffer as on a Range, with a buffer small
+    enough that the producer keeps blocking on it
+*/
+void ingestMatchesRange(){
+    std::mt19937 gen(29);
+    std::uniform_int_distribution<int> dist(0, 5000);
+    IngestOptions options;
+    options.capacity = 64;
+    options.batchSize = 16;
+    IngestRange ingest(options);
+    Range range;
+    for (int i = 0; i < 20000; i++){
+        int start = dist(gen);
+        int end = start + dist(gen) % 20 - 2;
+        // mostly adds, in runs of varying length
+        if (i / 50 % 3 == 2 && dist(gen) % 2 == 0){
+            ingest.Delete(start, end);
+            range.Delete(start, end);
+        } else {
+            ingest.Add(start, end);
+            range.Add(start, end);
+        }
+    }
+    ingest.Flush();
+    std::vector<std::pair<int, int>> res = {
+        {0, ingest.toVec() == range.toVec()}, {1, static_cast<int>(ingest.Backlog())},
+        {2, ingest.Get(100, 4000) == range.Get(100, 4000)}
+    };
+    std::vector<std::pair<int, int>> ans = {{0, 1}, {1, 0}, {2, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Flush makes every earlier modification visible to Get, without waiting for the delay
+*/
+void ingestFlushReadYourWrites(){
+    IngestOptions options;
+    options.maxDelay = std::chrono::hours(1);
+    IngestRange ingest(options);
+    ingest.Add(10, 20);
+    ingest.Add(20, 30);
+    ingest.Add(50, 60);
+    ingest.Flush();
+    ingest.Delete(15, 25);
+    ingest.Add(55, 70);
+    ingest.Add(40, 40);
+    ingest.Flush();
+    std::vector<int> ans = {70, 50, 30, 25, 15, 10};
+    verifyAnswer(ingest, ans, __FUNCTION__);
+}
+
+/*
+    No more than a buffer and a batch of modifications are ever waiting to be applied
+*/
+void ingestBoundedBacklog(){
+    IngestOptions options;
+    options.capacity = 8;
+    options.batchSize = 8;
+    IngestRange ingest(options);
+    std::size_t most = 0;
+    for (int i = 0; i < 5000; i++){
+        ingest.Add(i * 3, i * 3 + 2);
+        most = std::max(most, ingest.Backlog());
+    }
+    ingest.Flush();
+    std::vector<std::pair<int, int>> res = {
+        {0, most <= 2 * options.capacity}, {1, static_cast<int>(ingest.Get(0, 15000).size())}
+    };
+    std::vector<std::pair<int, int>> ans = {{0, 1}, {1, 5000}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Several producers adding at once lose nothing
+*/
+void ingestConcurrentProducers(){
+    IngestOptions options;
+    options.capacity = 256;
+    options.batchSize = 64;
+    IngestRange ingest(options);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; t++){
+        producers.emplace_back([&ingest, t](){
+            for (int i = 0; i < 5000; i++){
+                int start = (i * 4 + t) * 10;
+                ingest.Add(start, start + 5);
+                // a duplicate and an adjacent extension, which coalesce away
+                ingest.Add(start, start + 5);
+                ingest.Add(start + 5, start + 6);
+            }
+        });
+    }
+    for (auto&& producer : producers){
+        producer.join();
+    }
+    ingest.Flush();
+    std::vector<std::pair<int, int>> ranges = ingest.Get(0, 200000);
+    bool exact = ranges.size() == 20000;
+    for (std::size_t i = 0; exact && i < ranges.size(); i++){
+        exact = ranges[i] == std::make_pair(static_cast<int>(i) * 10, static_cast<int>(i) * 10 + 6);
+    }
+    std::vector<std::pair<int, int>> res = {{0, exact}};
+    std::vector<std::pair<int, int>> ans = {{0, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the streaming ingest test cases
+    Returns nothing, but prints to stdout
+*/
+void ingestTests()
+{
+    ingestMatchesRange();
+    ingestFlushReadYourWrites();
+    ingestBoundedBacklog();
+    ingestConcurrentProducers();
+}
+
+/*
+    Random traces of Add, Delete, Get and batches leave every backend agreeing with the bitmap
+*/
+void fuzzBackendsAgree(){
+    std::mt19937 gen(31);
+    int failures = 0;
+    for (int i = 0; i < 100; i++){
+        FuzzTrace trace = randomTrace(gen, 1 + gen() % 200);
+        if (std::optional<FuzzFailure> failure = runDifferential(trace)){
+            printFailure(std::cout, shrinkFailure(trace, *failure), *failure);
+            failures++;
+        }
+    }
+    std::vector<std::pair<int, int>> res = {{0, failures}};
+    std::vector<std::pair<int, int>> ans = {{0, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Traces moved against the lowest and the highest int, including selections starting
+    at the lowest point and ending at the highest, leave every backend agreeing with
+    the list of ranges, and so do random traces moved there
+*/
+void fuzzAtLimits(){
+    const int top = FuzzWidth + 128;
+    FuzzTrace edges = {
+        FuzzOp{FuzzOp::AddBatch, 0, 0, {{0, 28}, {600, top}}},
+        FuzzOp{FuzzOp::Get, 0, top, {}},
+        FuzzOp{FuzzOp::Add, 28, 600, {}},
+        FuzzOp{FuzzOp::Delete, 0, 1, {}},
+        FuzzOp{FuzzOp::Delete, top - 1, top, {}},
+        FuzzOp{FuzzOp::Get, -5, top, {}},
+        FuzzOp{FuzzOp::DeleteBatch, 0, 0, {{1, 128}, {500, top - 1}}},
+        FuzzOp{FuzzOp::Add, 0, 1, {}},
+        FuzzOp{FuzzOp::Get, 0, 2, {}}
+    };
+    std::mt19937 gen(43);
+    int failures = 0;
+    for (FuzzPlacement placement : {FuzzPlacement::Lowest, FuzzPlacement::Highest}){
+        failures += runDifferential(edges, placement).has_value();
+        for (int i = 0; i < 25; i++){
+            FuzzTrace trace = randomTrace(gen, 1 + gen() % 200);
+            if (std::optional<FuzzFailure> failure = runDifferential(trace, placement)){
+                printFailure(std::cout, shrinkFailure(trace, *failure), *failure);
+                failures++;
+            }
+        }
+    }
+    std::vector<std::pair<int, int>> res = {{0, failures}};
+    std::vector<std::pair<int, int>> ans = {{0, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Any bytes decode to a valid trace, reading a kind, a little endian start point
+    and a signed length per range, and zeros past the end of the input
+*/
+void fuzzDecodeTrace(){
+    std::vector<std::uint8_t> bytes = {5, 10, 0, 5, 4, 2, 1, 0, 3, 2, 0, 0xFF, 2, 0x01, 0x02};
+    FuzzTrace trace = decodeTrace(bytes.data(), bytes.size());
+    std::vector<std::pair<int, int>> res = {{-1, static_cast<int>(trace.size())}};
+    for (auto&& op : trace){
+        res.emplace_back(op.kind, static_cast<int>(op.batch.size()));
+        res.emplace_back(op.start, op.end);
+        for (auto&& range : op.batch){
+            res.push_back(range);
+        }
+    }
+    std::vector<std::pair<int, int>> ans = {
+        {-1, 3}, {FuzzOp::Add, 0}, {10, 15}, {FuzzOp::DeleteBatch, 2}, {0, 0}, {1, 4}, {2, 1},
+        {FuzzOp::Get, 0}, {513 % FuzzWidth, 513 % FuzzWidth}
+    };
+    verifyAnswer(res, ans, __FUNCTION__);
+    std::mt19937 gen(37);
+    int failures = 0;
+    for (int i = 0; i < 50; i++){
+        std::vector<std::uint8_t> input(gen() % 300);
+        for (auto& byte : input){
+            byte = static_cast<std::uint8_t>(gen());
+        }
+        FuzzTrace decoded = decodeTrace(input.data(), input.size());
+        failures += runDifferential(decoded).has_value();
+    }
+    res = {{0, failures}};
+    ans = {{0, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Shrinking keeps only the operations a failure needs, narrowed down as far as they go
+*/
+void fuzzShrinkTrace(){
+    std::mt19937 gen(41);
+    FuzzTrace trace = randomTrace(gen, 150);
+    trace.insert(trace.begin() + 40, FuzzOp{FuzzOp::Add, 250, 350, {}});
+    trace.push_back(FuzzOp{FuzzOp::Get, 0, FuzzWidth, {}});
+    // stands in for a bug that needs point 300 added and then read back
+    auto covers = [](const FuzzOp& op, FuzzOp::Kind kind){
+        return op.kind == kind && op.start <= 300 && 300 < op.end;
+    };
+    auto fails = [&](const FuzzTrace& candidate){
+        bool added = false;
+        for (auto&& op : candidate){
+            if (added && covers(op, FuzzOp::Get)){
+                return true;
+            }
+            added = added || covers(op, FuzzOp::Add);
+        }
+        return false;
+    };
+    FuzzTrace shrunk = shrinkTrace(trace, fails);
+    std::ostringstream printed;
+    printTrace(printed, shrunk);
+    FuzzTrace batches = {FuzzOp{FuzzOp::AddBatch, 0, 0, {{1, 2}, {5, 9}}}, FuzzOp{FuzzOp::Delete, 3, 4, {}}};
+    std::ostringstream printedBatches;
+    printTrace(printedBatches, batches);
+    std::vector<std::pair<int, int>> res = {
+        {0, printed.str() == "Add(300, 301)\nGet(300, 301)\n"},
+        {1, printedBatches.str() == "AddBatch({{1, 2}, {5, 9}})\nDelete(3, 4)\n"}
+    };
+    std::vector<std::pair<int, int>> ans = {{0, 1}, {1, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the differential fuzzing test cases
+    Returns nothing, but prints to stdout
+*/
+void fuzzTests()
+{
+    fuzzBackendsAgree();
+    fuzzAtLimits();
+    fuzzDecodeTrace();
+    fuzzShrinkTrace();
+}
+
+// tests filling a chunk with more short ranges than a list of runs holds,
+// then deleting most of them again
+// should switch the chunk to a bitmap and back, matching Range throughout
+void hybridSwitchesContainers(){
+    HybridRange hybrid = HybridRange();
+    Range range = Range();
+    std::vector<std::pair<int, int>> res;
+    for (int i = 0; i < 3000; i++){
+        hybrid.Add(4 * i, 4 * i + 1);
+        range.Add(4 * i, 4 * i + 1);
+    }
+    res.push_back(std::make_pair(static_cast<int>(hybrid.DenseChunks()), hybrid.toVec() == range.toVec()));
+    // joining pairs of runs halves their number, but not to SparseRuns yet
+    for (int i = 0; i < 3000; i += 2){
+        hybrid.Add(4 * i + 1, 4 * i + 4);
+        range.Add(4 * i + 1, 4 * i + 4);
+    }
+    res.push_back(std::make_pair(static_cast<int>(hybrid.DenseChunks()), hybrid.toVec() == range.toVec()));
+    hybrid.Delete(2000, 12000);
+    range.Delete(2000, 12000);
+    res.push_back(std::make_pair(static_cast<int>(hybrid.DenseChunks()), hybrid.toVec() == range.toVec()));
+    hybrid.Delete(0, 2000);
+    res.push_back(std::make_pair(static_cast<int>(hybrid.Chunks()), static_cast<int>(hybrid.toVec().size())));
+    std::vector<std::pair<int, int>> ans = {{1, 1}, {1, 1}, {0, 1}, {0, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests ranges crossing the boundaries between chunks, in both containers,
+// and cutting them apart again right at the boundary
+// should come back from Get as single ranges
+void hybridChunkBoundaries(){
+    HybridRange hybrid = HybridRange();
+    hybrid.Add(65530, 3 * 65536 + 10);
+    hybrid.Add(-10, 10);
+    // fill the chunk after the boundary with enough runs to make it a bitmap
+    for (int i = 0; i < 3000; i++){
+        hybrid.Add(4 * 65536 + 4 * i + 2, 4 * 65536 + 4 * i + 3);
+    }
+    hybrid.Add(4 * 65536 - 5, 4 * 65536 + 3);
+    hybrid.Delete(2 * 65536, 2 * 65536 + 1);
+    std::vector<std::pair<int, int>> res = hybrid.Get(-20, 4 * 65536 + 8);
+    res.push_back(std::make_pair(static_cast<int>(hybrid.CountIntervals(-20, 4 * 65536 + 8)), static_cast<int>(hybrid.DenseChunks())));
+    res.push_back(std::make_pair(hybrid.NextGap(65530), hybrid.FirstCovered(3 * 65536 + 10).value_or(-1)));
+    std::vector<std::pair<int, int>> ans = {
+        {-10, 10}, {65530, 2 * 65536}, {2 * 65536 + 1, 3 * 65536 + 10},
+        {4 * 65536 - 5, 4 * 65536 + 3}, {4 * 65536 + 6, 4 * 65536 + 7},
+        {5, 1}, {2 * 65536, 4 * 65536 - 5}
+    };
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests ranges at the extremes of int, and one covering every point but the largest
+// should neither overflow nor wrap around
+void hybridKeyLimits(){
+    const int lowest = std::numeric_limits<int>::lowest();
+    const int highest = std::numeric_limits<int>::max();
+    HybridRange hybrid = HybridRange();
+    hybrid.Add(lowest, lowest + 5);
+    hybrid.Add(highest - 3, highest);
+    std::vector<std::pair<int, int>> res = hybrid.Get(lowest, highest);
+    res.push_back(std::make_pair(hybrid.NextGap(highest - 3), hybrid.FirstCovered(0).value_or(0)));
+    res.push_back(std::make_pair(static_cast<int>(hybrid.CoveredLength(lowest, highest)), hybrid.Contains(highest)));
+    hybrid.Add(lowest, highest);
+    res.push_back(std::make_pair(hybrid.NextGap(lowest), static_cast<int>(hybrid.Chunks())));
+    res.push_back(std::make_pair(hybrid.CoveredLength(lowest, highest) == 0xFFFFFFFFu, static_cast<int>(hybrid.CountIntervals(lowest, highest))));
+    hybrid.Delete(lowest, highest);
+    res.push_back(std::make_pair(static_cast<int>(hybrid.Chunks()), hybrid.FirstCovered(lowest).has_value()));
+    std::vector<std::pair<int, int>> ans = {
+        {lowest, lowest + 5}, {highest - 3, highest},
+        {highest, highest - 3}, {8, 0}, {highest, 65536}, {1, 1}, {0, 0}
+    };
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests random additions and deletions of short ranges spread over a few chunks,
+// dense enough for some of them to switch between containers
+// should match Range after every one, and count the same coverage with every
+// instruction set the processor supports
+void hybridMatchesRange(){
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<int> dist(0, 3 * 65536);
+    HybridRange hybrid = HybridRange();
+    Range range = Range();
+    int mismatches = 0;
+    int dense = 0;
+    for (int round = 0; round < 40000; round++){
+        int start = dist(gen) - 65536;
+        int end = start + (round % 10000 == 5000 ? dist(gen) : dist(gen) % 4);
+        if (dist(gen) % 3 != 0){
+            hybrid.Add(start, end);
+            range.Add(start, end);
+        } else {
+            hybrid.Delete(start, end);
+            range.Delete(start, end);
+        }
+        if (round % 500 != 0){
+            continue;
+        }
+        dense += hybrid.DenseChunks() > 0;
+        mismatches += hybrid.toVec() != range.toVec();
+        int from = dist(gen) - 65536;
+        int to = from + dist(gen);
+        for (HybridRange::Simd simd : {HybridRange::Simd::Scalar, HybridRange::Simd::Popcnt, HybridRange::Simd::AVX2}){
+            mismatches += hybrid.CoveredLength(from, to, simd) != range.CoveredLength(from, to);
+        }
+        mismatches += hybrid.CountIntervals(from, to) != range.CountIntervals(from, to);
+        mismatches += hybrid.NextGap(from) != range.NextGap(from);
+        mismatches += hybrid.FirstCovered(from) != range.FirstCovered(from);
+        mismatches += hybrid.Contains(from) != range.Contains(from);
+    }
+    std::vector<std::pair<int, int>> res = {{mismatches, dense > 0}};
+    std::vector<std::pair<int, int>> ans = {{0, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests the memory taken by a chunk of many short ranges, like every other port
+// should stay at the size of one bitmap, a fraction of a tree node per range
+void hybridMemory(){
+    HybridRange hybrid = HybridRange();
+    for (int i = 0; i < 65536; i += 2){
+        hybrid.Add(i, i + 1);
+    }
+    std::size_t bitmap = HybridRange::BitmapWords * sizeof(std::uint64_t);
+    std::vector<std::pair<int, int>> res = {
+        {hybrid.MemoryUsage() >= bitmap, hybrid.MemoryUsage() < bitmap + 256},
+        {static_cast<int>(hybrid.CountIntervals(0, 65536)), static_cast<int>(hybrid.CoveredLength(0, 65536))}
+    };
+    std::vector<std::pair<int, int>> ans = {{1, 1}, {32768, 32768}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the HybridRange test cases
+    Returns nothing, but prints to stdout
+*/
+void hybridTests()
+{
+    hybridSwitchesContainers();
+    hybridChunkBoundaries();
+    hybridKeyLimits();
+    hybridMatchesRange();
+    hybridMemory();
+}
+
+// tests moving a set into a new one and then into one holding other ranges,
+// then reusing the sets moved from
+// should carry the ranges along, leaving the sets moved from empty but usable
+template <typename RangeType>
+void moveLeavesSourceEmpty(){
+    RangeType range = RangeType();
+    range.Add(10, 20);
+    range.Add(30, 40);
+    RangeType moved = std::move(range);
+    RangeType assigned = RangeType();
+    assigned.Add(0, 5);
+    assigned = std::move(moved);
+    range.Add(50, 60);
+    moved.Add(70, 80);
+    std::vector<std::pair<int, int>> res = assigned.Get(0, 100);
+    res.push_back(std::make_pair(static_cast<int>(range.Get(0, 100).size()), static_cast<int>(moved.Get(0, 100).size())));
+    std::vector<std::pair<int, int>> ans = {{10, 20}, {30, 40}, {1, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests moving, swapping and move assigning PooledRanges, then cloning one
+// should hand each pool over along with its nodes rather than copy them into
+// a new one, leave every set moved from with a pool apart from the one it handed over,
+// and give the clone the same ranges in a pool of its own
+void moveKeepsNodes(){
+    PooledRange range = PooledRange();
+    for (int i = 0; i < 100; i++){
+        range.Add(i * 20, i * 20 + 10);
+    }
+    std::vector<int> ranges = range.toVec();
+    auto pool = range.GetAllocator();
+    PooledRange moved = std::move(range);
+    PooledRange other = PooledRange();
+    other.Add(0, 1);
+    auto otherPool = other.GetAllocator();
+    swap(moved, other);
+    PooledRange assigned = PooledRange();
+    assigned = std::move(moved);
+    PooledRange clone = other.Clone();
+    std::vector<std::pair<int, int>> res = {
+        {other.GetAllocator() == pool, assigned.GetAllocator() == otherPool},
+        {range.GetAllocator() != pool, moved.GetAllocator() != otherPool},
+        {clone.GetAllocator() == pool, clone.toVec() == ranges},
+        {static_cast<int>(assigned.Size()), static_cast<int>(other.Size())}
+    };
+    std::vector<std::pair<int, int>> ans = {{1, 1}, {1, 1}, {0, 1}, {1, 100}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests modifying sets after moving, swapping, cloning and move assigning them
+// should report to the subscriber wherever its ranges went, and never from a clone
+void moveCarriesSubscriber(){
+    int first = 0;
+    int second = 0;
+    Range range = Range();
+    range.Subscribe([&](Range::Change, int, int){
+        first++;
+    });
+    Range moved = std::move(range);
+    moved.Add(0, 10);
+    range.Add(20, 30);
+    Range other = Range();
+    other.Subscribe([&](Range::Change, int, int){
+        second++;
+    });
+    swap(moved, other);
+    moved.Add(40, 50);
+    other.Add(60, 70);
+    Range clone = other.Clone();
+    clone.Add(80, 90);
+    Range assigned = Range();
+    assigned = std::move(other);
+    assigned.Add(100, 110);
+    other.Add(120, 130);
+    std::vector<std::pair<int, int>> res = {{first, second}};
+    std::vector<std::pair<int, int>> ans = {{3, 1}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests growing a vector of PooledRanges one at a time, reversing it and erasing its first set
+// should move the sets every time rather than copy them, so that each keeps its pool
+// without any two of them ending up sharing one, and keep every set's ranges
+void vectorOfSets(){
+    static_assert(std::is_nothrow_move_constructible<Range>::value, "Range must move without throwing");
+    static_assert(std::is_nothrow_move_constructible<PooledRange>::value, "PooledRange must move without throwing");
+    static_assert(std::is_nothrow_move_constructible<FlatRange>::value, "FlatRange must move without throwing");
+    static_assert(std::is_nothrow_move_constructible<HybridRange>::value, "HybridRange must move without throwing");
+    std::vector<PooledRange> sets;
+    std::vector<PoolAllocator<std::pair<const int, int>>> pools;
+    for (int i = 0; i < 100; i++){
+        sets.emplace_back();
+        sets.back().Add(i * 10, i * 10 + 5);
+        pools.push_back(sets.back().GetAllocator());
+    }
+    std::reverse(sets.begin(), sets.end());
+    sets.erase(sets.begin());
+    int mismatches = 0;
+    for (int i = 0; i < 99; i++){
+        int original = 98 - i;
+        std::vector<std::pair<int, int>> expected = {{original * 10, original * 10 + 5}};
+        mismatches += sets[i].GetAllocator() != pools[original];
+        mismatches += sets[i].Get(0, 1000) != expected;
+        for (int j = 0; j < i; j++){
+            mismatches += sets[i].GetAllocator() == sets[j].GetAllocator();
+        }
+    }
+    std::vector<std::pair<int, int>> res = {{static_cast<int>(sets.size()), mismatches}};
+    std::vector<std::pair<int, int>> ans = {{99, 0}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests moving, copy assigning and move assigning BTreeRanges deep enough to have inner nodes,
+// then querying and refilling the trees moved from
+// should leave each tree moved from without any node until it is added to again,
+// answer every query on it as an empty set, and keep the copy apart from the original
+void btreeMoveWithoutNodes(){
+    static_assert(std::is_nothrow_move_constructible<BTreeRange<4>>::value && std::is_nothrow_move_assignable<BTreeRange<4>>::value,
+        "BTreeRange must move without throwing");
+    BTreeRange<4> range = BTreeRange<4>();
+    for (int i = 0; i < 50; i++){
+        range.Add(i * 10, i * 10 + 5);
+    }
+    BTreeRange<4> moved = std::move(range);
+    BTreeRange<4> copied = BTreeRange<4>();
+    copied = moved;
+    BTreeRange<4> assigned = BTreeRange<4>();
+    assigned.Add(1000, 1010);
+    assigned = std::move(moved);
+    std::vector<std::pair<int, int>> res = {
+        {static_cast<int>(range.Depth()), static_cast<int>(moved.Depth())},
+        {static_cast<int>(range.Get(0, 1000).size()), static_cast<int>(range.CoveredLength(0, 1000))},
+        {static_cast<int>(range.CountIntervals(0, 1000)), range.NextGap(10)},
+        {range.FirstCovered(0).has_value(), assigned.Depth() > 2}
+    };
+    range.Add(0, 5);
+    moved.Delete(0, 1000);
+    moved.Add(20, 30);
+    copied.Delete(0, 100);
+    res.push_back(std::make_pair(static_cast<int>(range.CountIntervals(0, 1000)), static_cast<int>(moved.CountIntervals(0, 1000))));
+    res.push_back(std::make_pair(static_cast<int>(assigned.CountIntervals(0, 2000)), static_cast<int>(copied.CountIntervals(0, 2000))));
+    std::vector<std::pair<int, int>> ans = {{0, 0}, {0, 0}, {0, 10}, {0, 1}, {1, 1}, {50, 40}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests reserving room in a FlatRange, filling it, then deleting most of it and shrinking it
+// should never reallocate while filling, and shrink down to the ranges left
+void flatRangeReserve(){
+    FlatRange range = FlatRange();
+    range.Reserve(1000);
+    std::size_t capacity = range.Capacity();
+    for (int i = 0; i < 1000; i++){
+        range.Add(i * 20, i * 20 + 10);
+    }
+    bool kept = range.Capacity() == capacity;
+    range.Delete(200, 20000);
+    range.ShrinkToFit();
+    std::vector<std::pair<int, int>> res = {
+        {capacity >= 1000, kept},
+        {static_cast<int>(range.Capacity()), static_cast<int>(range.CountIntervals(0, 20000))}
+    };
+    std::vector<std::pair<int, int>> ans = {{1, 1}, {10, 10}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+// tests shrinking a HybridRange after emptying all but one of many chunks
+// should give back memory without changing the ranges
+void hybridShrinkToFit(){
+    HybridRange range = HybridRange();
+    for (int chunk = 0; chunk < 50; chunk++){
+        for (int i = 0; i < 100; i++){
+            range.Add(chunk * 65536 + 4 * i, chunk * 65536 + 4 * i + 1);
+        }
+    }
+    range.Delete(0, 49 * 65536 + 200);
+    std::vector<int> ranges = range.toVec();
+    std::size_t before = range.MemoryUsage();
+    range.ShrinkToFit();
+    std::vector<std::pair<int, int>> res = {
+        {range.MemoryUsage() < before, range.toVec() == ranges},
+        {static_cast<int>(range.Chunks()), static_cast<int>(range.CountIntervals(0, 50 * 65536))}
+    };
+    std::vector<std::pair<int, int>> ans = {{1, 1}, {1, 50}};
+    verifyAnswer(res, ans, __FUNCTION__);
+}
+
+/*
+    Runs all of the moving, swapping, cloning and capacity test cases
+    Returns nothing, but prints to stdout
+*/
+void moveTests()
+{
+    moveLeavesSourceEmpty<Range>();
+    moveLeavesSourceEmpty<PooledRange>();
+    moveLeavesSourceEmpty<FlatRange>();
+    moveLeavesSourceEmpty<HybridRange>();
+    moveLeavesSourceEmpty<BTreeRange<>>();
+    moveLeavesSourceEmpty<BTreeRange<4>>();
+    btreeMoveWithoutNodes();
+    moveKeepsNodes();
+    moveCarriesSubscriber();
+    vectorOfSets();
+    flatRangeReserve();
+    hybridShrinkToFit();
+}
+
+/*
+    Runs all of the Add, Delete and Get test cases against one backend
+    Returns nothing, but prints to stdout
+
+    name: name of the backend, used to label the output
+*/
+template <typename RangeType>
+void backendTests(const char* name)
+{
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Add Functionality (" << name << "):" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    addTests<RangeType>();
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Remove Functionality (" << name << "):" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    deleteTests<RangeType>();
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Get Functionality (" << name << "):" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    getTests<RangeType>();
+}
+
+/*
+    Runs the batch test cases against one backend
+    Returns nothing, but prints to stdout
+
+    name: name of the backend, used to label the output
+*/
+template <typename RangeType>
+void backendBatchTests(const char* name)
+{
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Batch Functionality (" << name << "):" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    batchTests<RangeType>();
+}
+
+/*
+    Runs all of the test cases
+    Returns nothing, but prints to stdout
+*/
+void runTests()
+{
+    backendTests<Range>("Range");
+    backendTests<PooledRange>("PooledRange");
+    backendTests<FlatRange>("FlatRange");
+    backendTests<HybridRange>("HybridRange");
+    backendTests<BTreeRange<>>("BTreeRange");
+    backendTests<BTreeRange<4>>("BTreeRange<4>");
+    backendTests<ConcurrentRange>("ConcurrentRange");
+    backendTests<TestShardedRange>("ShardedRange");
+    backendTests<TestDurableRange>("DurableRange");
+    backendTests<PersistentRange>("PersistentRange");
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing BTreeRange Node Splitting:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    btreeSplitAndMerge();
+    backendBatchTests<Range>("Range");
+    backendBatchTests<FlatRange>("FlatRange");
+    backendBatchTests<PooledRange>("PooledRange");
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Node Pool:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    poolRecyclesNodes();
+    pooledRangeCopy();
+    pooledRangeMove();
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Moves and Capacity:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    moveTests();
+    algebraTests<Range>("Range");
+    algebraTests<PooledRange>("PooledRange");
+    bulkLoadTests<Range>("Range");
+    bulkLoadTests<PooledRange>("PooledRange");
+    bulkLoadTests<FlatRange>("FlatRange");
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Change Feed:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    feedTests();
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Interval Map:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    rangeMapTests();
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Compressed Encoding:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    compressedTests();
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Hybrid Bitmap Chunks:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    hybridTests();
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Instrumentation:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    statsTests();
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Non-Allocating Get Functionality:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    getNoAllocTests();
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Parallel Get:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    parallelGetTests();
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Membership Queries:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    containsTests();
+    aggregateTests<Range>("Range");
+    aggregateTests<FlatRange>("FlatRange");
+    flatCoveredLengthAfterBulkChanges();
+    aggregateTests<HybridRange>("HybridRange");
+    aggregateTests<BTreeRange<>>("BTreeRange");
+    aggregateTests<BTreeRange<4>>("BTreeRange<4>");
+    keyLimitTests<std::int32_t>("int32_t");
+    keyLimitTests<std::int64_t>("int64_t");
+    keyLimitTests<std::uint64_t>("uint64_t");
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Thread Safe Variants Under Contention:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    concurrentReadersAndWriters();
+    shardedEvenSplit();
+    shardedBoundaries();
+    shardedParallelWriters();
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Differential Fuzzing:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    fuzzTests();
+    std::cout << "--------------------------------------" << std::endl;
+    std::cout << "Testing Streaming Ingest:" << std::endl;
+    std::cout << "--------------------------------------" << std::endl;
+    ingestTests();
     std::cout << "--------------------------------------" << std::endl;
-    std::cout << "Testing Add Functionality:" << std::endl;
+    std::cout << "Testing Snapshots:" << std::endl;
     std::cout << "--------------------------------------" << std::endl;
-    addTests();
+    snapshotTests();
     std::cout << "--------------------------------------" << std::endl;
-    std::cout << "Testing Remove Functionality:" << std::endl;
+    std::cout << "Testing Durability:" << std::endl;
     std::cout << "--------------------------------------" << std::endl;
-    deleteTests();
+    durableTests();
     std::cout << "--------------------------------------" << std::endl;
-    std::cout << "Testing Get Functionality:" << std::endl;
+    std::cout << "Testing Persistent Versions:" << std::endl;
     std::cout << "--------------------------------------" << std::endl;
-    getTests();
+    persistentTests();
 }
\ No newline at end of file